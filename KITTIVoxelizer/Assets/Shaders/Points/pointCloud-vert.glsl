@@ -7,5 +7,5 @@ uniform float pointSize;
 
 void main() {
 	gl_PointSize = pointSize;
-	gl_Position = mModelViewProj * vPosition;
+	gl_Position = mModelViewProj * vec4(vPosition.xyz, 1.0f);
 }
\ No newline at end of file
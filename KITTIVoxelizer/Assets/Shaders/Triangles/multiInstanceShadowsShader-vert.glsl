@@ -4,16 +4,44 @@ layout(location = 0) in vec3 vPosition;
 layout(location = 2) in vec2 vTextCoord;
 layout(location = 4) in vec3 vOffset;
 layout(location = 5) in vec3 vScale;
+layout(location = 9) in uint vPackedInstance;
 
 // Matrices
 uniform mat4 mModelViewProj;
 
+// Uniform grids
+uniform bool packedInstances;			// Instances are read from vPackedInstance rather than vOffset and vScale
+uniform uint cellBits;					// Low bits of vPackedInstance which hold the cell index, whereas the remaining ones hold the label
+uniform vec3 cellSize;
+uniform uvec3 gridDims;
+uniform vec3 gridOrigin;
+
 out vec2 textCoord;
 
+// Offset and scale of the instance. Voxels of uniform grids are decoded from their cell index
+void getInstance(out vec3 offset, out vec3 scale)
+{
+	if (packedInstances)
+	{
+		const uint cell = vPackedInstance & ((1u << cellBits) - 1u);
+
+		offset = gridOrigin + cellSize * (vec3(cell / (gridDims.y * gridDims.z), (cell / gridDims.z) % gridDims.y, cell % gridDims.z) + .5f);
+		scale = cellSize;
+	}
+	else
+	{
+		offset = vOffset;
+		scale = vScale;
+	}
+}
+
 void main()
 {
-	mat4 scaleMatrix = mat4(vScale.x, .0f, .0f, .0f, .0f, vScale.y, .0f, .0f, .0f, .0f, vScale.z, .0f, .0f, .0f, .0f, 1.0f);
-	mat4 translationMatrix = mat4(1.0f, .0f, .0f, .0f, .0f, 1.0f, .0f, .0f, .0f, .0f, 1.0f, .0f, vOffset.x, vOffset.y, vOffset.z, 1.0f);
+	vec3 offset, scale;
+	getInstance(offset, scale);
+
+	mat4 scaleMatrix = mat4(scale.x, .0f, .0f, .0f, .0f, scale.y, .0f, .0f, .0f, .0f, scale.z, .0f, .0f, .0f, .0f, 1.0f);
+	mat4 translationMatrix = mat4(1.0f, .0f, .0f, .0f, .0f, 1.0f, .0f, .0f, .0f, .0f, 1.0f, .0f, offset.x, offset.y, offset.z, 1.0f);
 	vec3 newPosition = vec3(translationMatrix * scaleMatrix * vec4(vPosition, 1.0f));
 
 	textCoord = vTextCoord;
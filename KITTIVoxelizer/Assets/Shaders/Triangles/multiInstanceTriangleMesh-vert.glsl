@@ -11,6 +11,7 @@ layout(location = 3) in vec3		vTangent;
 layout(location = 4) in vec3		vOffset;
 layout(location = 5) in vec3		vScale;
 layout(location = 7) in float		vColorIndex;
+layout(location = 9) in uint		vPackedInstance;
 
 
 // ------------- Light types ----------------
@@ -33,6 +34,13 @@ uniform mat4 mShadow;
 // Plane clipping
 uniform vec4 planeCoefficients;
 
+// Uniform grids
+uniform bool packedInstances;			// Instances are read from vPackedInstance rather than vOffset and vScale
+uniform uint cellBits;					// Low bits of vPackedInstance which hold the cell index, whereas the remaining ones hold the label
+uniform vec3 cellSize;
+uniform uvec3 gridDims;
+uniform vec3 gridOrigin;
+
 // Vertex related
 out vec3 position;
 out vec3 normal;
@@ -123,11 +131,33 @@ mat3 noDisplacement()
 	return mat3(1.0f);
 }
 
+// ------------- Instancing --------------
+
+// Offset and scale of the instance. Voxels of uniform grids are decoded from their cell index
+void getInstance(out vec3 offset, out vec3 scale)
+{
+	if (packedInstances)
+	{
+		const uint cell = vPackedInstance & ((1u << cellBits) - 1u);
+
+		offset = gridOrigin + cellSize * (vec3(cell / (gridDims.y * gridDims.z), (cell / gridDims.z) % gridDims.y, cell % gridDims.z) + .5f);
+		scale = cellSize;
+	}
+	else
+	{
+		offset = vOffset;
+		scale = vScale;
+	}
+}
+
 
 void main()
 {
-	mat4 scaleMatrix = mat4(vScale.x, .0f, .0f, .0f, .0f, vScale.y, .0f, .0f, .0f, .0f, vScale.z, .0f, .0f, .0f, .0f, 1.0f);
-	mat4 translationMatrix = mat4(1.0f, .0f, .0f, .0f, .0f, 1.0f, .0f, .0f, .0f, .0f, 1.0f, .0f, vOffset.x, vOffset.y, vOffset.z, 1.0f);
+	vec3 offset, scale;
+	getInstance(offset, scale);
+
+	mat4 scaleMatrix = mat4(scale.x, .0f, .0f, .0f, .0f, scale.y, .0f, .0f, .0f, .0f, scale.z, .0f, .0f, .0f, .0f, 1.0f);
+	mat4 translationMatrix = mat4(1.0f, .0f, .0f, .0f, .0f, 1.0f, .0f, .0f, .0f, .0f, 1.0f, .0f, offset.x, offset.y, offset.z, 1.0f);
 	mat4 transformationMatrix = translationMatrix * scaleMatrix;
 
 	position = vec3(mModelView * transformationMatrix * vec4(vPosition, 1.0f));
@@ -135,7 +165,7 @@ void main()
 	normal = vec3(mModelView * transformationMatrix * vec4(vNormal, 0.0f));
 	shadowCoord = mShadow * transformationMatrix * vec4(vPosition, 1.0f);
 	textCoord = vTextCoord;
-	colorIndex = vColorIndex;
+	colorIndex = packedInstances ? float(vPackedInstance >> cellBits) : vColorIndex;
 
 	gl_ClipDistance[0] = dot(planeCoefficients, transformationMatrix * vec4(vPosition, 1.0));
 
@@ -270,6 +270,10 @@ struct LodePNGDecompressSettings {
   unsigned ignore_adler32; /*if 1, continue and don't give an error message if the Adler32 checksum is corrupted*/
   unsigned ignore_nlen; /*ignore complement of len checksum in uncompressed blocks*/
 
+  /*Maximum decompressed size, unlimited if 0. Error 109 is returned, before allocating, if it would be exceeded.
+  Ignored by custom decoders*/
+  size_t max_output_size;
+
   /*use custom zlib decoder instead of built in one (default: null)*/
   unsigned (*custom_zlib)(unsigned char**, size_t*,
                           const unsigned char*, size_t,
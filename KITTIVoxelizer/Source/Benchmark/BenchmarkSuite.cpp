@@ -0,0 +1,333 @@
+#include "stdafx.h"
+#include "BenchmarkSuite.h"
+
+#include <filesystem>
+#include "DataStructures/Octree.h"
+#include "DataStructures/RegularGrid.h"
+#include "Geometry/3D/Intersections3D.h"
+#include "Graphics/Core/ComputeBackend.h"
+#include "Graphics/Core/PLYDecoder.h"
+#include <iomanip>
+
+// Initialization of static attributes
+const float BenchmarkSuite::BACKEND_TOLERANCE = 1e-3f;
+
+/// [Public methods]
+
+BenchmarkSuite::BenchmarkSuite(const Settings& settings) : _settings(settings)
+{
+	_tempFolder = (std::filesystem::temp_directory_path() / "KITTIVoxelizerBenchmark").generic_string() + "/";
+}
+
+BenchmarkSuite::~BenchmarkSuite()
+{
+	std::error_code error;
+	std::filesystem::remove_all(_tempFolder, error);
+}
+
+void BenchmarkSuite::run()
+{
+	std::filesystem::create_directories(_tempFolder);
+	_result.clear();
+
+	// Synthetic inputs
+	std::vector<PointCloud::PointModel> scan;
+	SyntheticData::generateScan(_settings._numPoints, 64, vec3(.0f, .0f, 1.73f), _settings._seed, scan);
+
+	const std::string binaryScan = _tempFolder + "scan_binary", asciiScan = _tempFolder + "scan_ascii";
+	if (!SyntheticData::writePLY(scan, binaryScan + PLY_EXTENSION, false) || !SyntheticData::writePLY(scan, asciiScan + PLY_EXTENSION, true))
+	{
+		throw std::runtime_error("Synthetic scans could not be written in " + _tempFolder);
+	}
+
+	volatile size_t sink = 0;
+
+	// PLY parsing
+	for (const std::string& scanName : { binaryScan, asciiScan })
+	{
+		this->measure(scanName == binaryScan ? "ply_decode_binary" : "ply_decode_ascii", scan.size(), [&]()
+		{
+			std::vector<PointCloud::PointModel> points;
+			AABB aabb;
+			unsigned maxLabel = 0;
+
+			PLYDecoder decoder(scanName + PLY_EXTENSION);
+			if (!decoder.readHeader() || !decoder.decodeVertices(SyntheticData::LABEL_PROPERTY_NAMES, points, aabb, maxLabel)) throw std::runtime_error("Synthetic scan could not be decoded");
+
+			sink = sink + points.size();
+		});
+	}
+
+	// Binary cache, which is written by the first load
+	this->measure("point_cloud_binary_load", scan.size(), [&]()
+	{
+		PointCloud pointCloud(binaryScan, true);
+		pointCloud.load();
+
+		sink = sink + pointCloud.getNumberOfPoints();
+	});
+
+	// Voxelization
+	PointCloud pointCloud(binaryScan, true);
+	pointCloud.load();
+
+	RegularGrid grid(pointCloud.getAABB(), _settings._gridResolution);
+	const size_t numVoxels = grid.length();
+	const AABB gridAABB = grid.getAABB();
+	const uvec3 numDivs = grid.getNumSubdivisions();
+	const vec3 cellSize = (gridAABB.max() - gridAABB.min()) / vec3(numDivs);
+	std::vector<uint16_t> labels(numVoxels, VOXEL_EMPTY);
+
+	this->measure("grid_insert_points", scan.size(), [&]()
+	{
+		for (const PointCloud::PointModel& point : *pointCloud.getPoints()) grid.insertPoint(point._point, point._label);
+	});
+
+	// Accumulation of label votes and majority vote are measured together
+	ComputeBackend* cpuBackend = ComputeBackend::getBackend(ComputeBackend::CPU_BACKEND);
+	const unsigned numLabels = pointCloud.getMaxLabel() + 1;
+
+	this->measure("grid_fill_majority_vote_cpu", scan.size(), [&]()
+	{
+		cpuBackend->voxelize(*pointCloud.getPoints(), gridAABB.min(), cellSize, numDivs, numLabels, labels);
+	});
+
+	if (_settings._useGPU)
+	{
+		ComputeBackend* gpuBackend = ComputeBackend::getBackend(ComputeBackend::GPU_BACKEND);
+
+		this->measure("grid_fill_majority_vote_gpu", scan.size(), [&]()
+		{
+			gpuBackend->voxelize(*pointCloud.getPoints(), gridAABB.min(), cellSize, numDivs, numLabels, labels);
+		});
+	}
+
+	// Following kernels work on the voxelized labels
+	std::copy(labels.begin(), labels.end(), grid.data());
+	grid.markDirty();
+
+	this->measure("grid_pack", numVoxels, [&]() { sink = sink + RegularGrid::pack(labels).size(); });
+	this->measure("grid_export_binary", numVoxels, [&]() { grid.exportBinary(_tempFolder + "grid"); });
+	this->measure("grid_export_compressed", numVoxels, [&]() { grid.exportCompressed(_tempFolder + "grid"); });
+
+	this->measure("grid_get_aabbs", numVoxels, [&]()
+	{
+		std::vector<AABB> aabbs;
+		grid.getAABBs(aabbs);
+
+		sink = sink + aabbs.size();
+	});
+
+	this->measure("grid_query_cluster_cpu", scan.size(), [&]()
+	{
+		std::vector<uint16_t> labels;
+		grid.queryCluster(&pointCloud, labels);
+
+		sink = sink + labels.size();
+	});
+
+	// Octree
+	SyntheticData::SyntheticMesh mesh(_settings._meshResolution, 100.0f, _settings._seed);
+	const AABB meshAABB = mesh.getAABB();
+
+	if (_settings._useGPU)
+	{
+		this->validateBackends(pointCloud, grid, mesh);
+	}
+	std::unique_ptr<Octree> octree;
+
+	this->measure("octree_build", mesh.getFaces().size(), [&]() { octree.reset(new Octree(8, 16, &mesh, meshAABB)); }, [&]() { octree.reset(); });
+
+	std::mt19937 generator(_settings._seed);
+	std::uniform_real_distribution<float> uniform(.0f, 1.0f);
+	std::vector<Ray3D> ray;
+
+	for (unsigned rayIdx = 0; rayIdx < _settings._numRays; ++rayIdx)
+	{
+		const vec3 origin = meshAABB.min() + (meshAABB.max() - meshAABB.min()) * vec3(uniform(generator), uniform(generator), 2.0f);
+		const vec3 destination = meshAABB.min() + (meshAABB.max() - meshAABB.min()) * vec3(uniform(generator), uniform(generator), -1.0f);
+
+		ray.push_back(Ray3D(origin, destination));
+	}
+
+	this->measure("octree_ray_query", ray.size(), [&]()
+	{
+		for (const Ray3D& currentRay : ray)
+		{
+			FaceListNode faces;
+			octree->intersection(currentRay, &faces);
+
+			sink = sink + faces.size();
+		}
+	});
+
+	// Triangle-AABB tests: every triangle against a box of its size located nearby
+	std::vector<Triangle3D> triangle;
+	std::vector<AABB> box;
+
+	for (const Model3D::FaceGPUData& face : mesh.getFaces())
+	{
+		const vec3 a = mesh.getVertices()[face._vertices.x]._position, b = mesh.getVertices()[face._vertices.y]._position, c = mesh.getVertices()[face._vertices.z]._position;
+		const vec3 center = (a + b + c) / 3.0f + (vec3(uniform(generator), uniform(generator), uniform(generator)) - .5f) * glm::distance(a, b);
+
+		triangle.push_back(Triangle3D(a, b, c));
+		box.push_back(AABB(center - glm::distance(a, b) * .25f, center + glm::distance(a, b) * .25f));
+	}
+
+	this->measure("triangle_aabb_intersection", triangle.size(), [&]()
+	{
+		size_t numIntersections = 0;
+
+		for (size_t triangleIdx = 0; triangleIdx < triangle.size(); ++triangleIdx)
+			numIntersections += Intersections3D::intersect(triangle[triangleIdx], box[triangleIdx]);
+
+		sink = sink + numIntersections;
+	});
+}
+
+bool BenchmarkSuite::writeJSON(const std::string& filename) const
+{
+	std::ofstream out(filename, std::ios::out | std::ios::trunc);
+	if (!out.is_open()) return false;
+
+	out << std::setprecision(9);
+	out << "{\n\t\"settings\": {\n";
+	out << "\t\t\"grid_resolution\": [" << _settings._gridResolution.x << ", " << _settings._gridResolution.y << ", " << _settings._gridResolution.z << "],\n";
+	out << "\t\t\"mesh_resolution\": " << _settings._meshResolution << ",\n";
+	out << "\t\t\"iterations\": " << _settings._numIterations << ",\n";
+	out << "\t\t\"points\": " << _settings._numPoints << ",\n";
+	out << "\t\t\"rays\": " << _settings._numRays << ",\n";
+	out << "\t\t\"warmup\": " << _settings._numWarmup << ",\n";
+	out << "\t\t\"seed\": " << _settings._seed << ",\n";
+	out << "\t\t\"threads\": " << std::thread::hardware_concurrency() << "\n\t},\n\t\"benchmarks\": [\n";
+
+	for (size_t resultIdx = 0; resultIdx < _result.size(); ++resultIdx)
+	{
+		const Result& result = _result[resultIdx];
+
+		out << "\t\t{\n\t\t\t\"name\": \"" << result._name << "\",\n\t\t\t\"items\": " << result._numItems << ",\n";
+		out << "\t\t\t\"min_ms\": " << result._min << ",\n\t\t\t\"median_ms\": " << result._median << ",\n\t\t\t\"mean_ms\": " << result._mean << ",\n";
+		out << "\t\t\t\"stddev_ms\": " << result._stdDev << ",\n\t\t\t\"max_ms\": " << result._max << ",\n\t\t\t\"items_per_second\": " << result._throughput << ",\n";
+		out << "\t\t\t\"samples_ms\": [";
+
+		for (size_t sampleIdx = 0; sampleIdx < result._sample.size(); ++sampleIdx)
+			out << (sampleIdx ? ", " : "") << result._sample[sampleIdx];
+
+		out << "]\n\t\t}" << (resultIdx + 1 < _result.size() ? "," : "") << '\n';
+	}
+
+	out << "\t]\n}\n";
+	out.close();
+
+	return !out.fail();
+}
+
+/// [Protected methods]
+
+bool BenchmarkSuite::equal(const vec3& a, const vec3& b)
+{
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		// Degenerate tangents are NaN in both backends
+		if (std::isnan(a[axis]) != std::isnan(b[axis]) || std::abs(a[axis] - b[axis]) > BACKEND_TOLERANCE * std::max(1.0f, std::abs(a[axis]))) return false;
+	}
+
+	return true;
+}
+
+void BenchmarkSuite::measure(const std::string& name, size_t numItems, const std::function<void()>& kernel, const std::function<void()>& setup)
+{
+	Result result;
+	result._name = name;
+	result._numItems = numItems;
+
+	for (unsigned iteration = 0; iteration < _settings._numWarmup + std::max(_settings._numIterations, 1u); ++iteration)
+	{
+		if (setup) setup();
+
+		const auto startTime = std::chrono::steady_clock::now();
+		kernel();
+		const auto endTime = std::chrono::steady_clock::now();
+
+		if (iteration >= _settings._numWarmup)
+			result._sample.push_back(std::chrono::duration<double, std::milli>(endTime - startTime).count());
+	}
+
+	std::vector<double> sorted = result._sample;
+	std::sort(sorted.begin(), sorted.end());
+
+	const size_t numSamples = sorted.size();
+	result._min = sorted.front();
+	result._max = sorted.back();
+	result._median = numSamples % 2 ? sorted[numSamples / 2] : (sorted[numSamples / 2 - 1] + sorted[numSamples / 2]) / 2.0;
+	result._mean = std::accumulate(sorted.begin(), sorted.end(), .0) / numSamples;
+	result._stdDev = std::sqrt(std::accumulate(sorted.begin(), sorted.end(), .0, [&](double sum, double sample) { return sum + (sample - result._mean) * (sample - result._mean); }) / numSamples);
+	result._throughput = result._median > .0 ? numItems / (result._median * 1e-3) : .0;
+
+	std::cout << name << ": " << result._median << " ms (median of " << numSamples << ")" << std::endl;
+
+	_result.push_back(result);
+}
+
+void BenchmarkSuite::validateBackends(PointCloud& pointCloud, const RegularGrid& grid, const SyntheticData::SyntheticMesh& mesh)
+{
+	ComputeBackend* cpuBackend = ComputeBackend::getBackend(ComputeBackend::CPU_BACKEND);
+	ComputeBackend* gpuBackend = ComputeBackend::getBackend(ComputeBackend::GPU_BACKEND);
+
+	// Voxelization must match exactly
+	const unsigned numLabels = pointCloud.getMaxLabel() + 1;
+	const AABB gridAABB = grid.getAABB();
+	const uvec3 numDivs = grid.getNumSubdivisions();
+	const vec3 cellSize = (gridAABB.max() - gridAABB.min()) / vec3(numDivs);
+	std::vector<uint16_t> cpuGrid(grid.length(), VOXEL_EMPTY), gpuGrid(grid.length(), VOXEL_EMPTY);
+
+	cpuBackend->voxelize(*pointCloud.getPoints(), gridAABB.min(), cellSize, numDivs, numLabels, cpuGrid);
+	gpuBackend->voxelize(*pointCloud.getPoints(), gridAABB.min(), cellSize, numDivs, numLabels, gpuGrid);
+
+	if (cpuGrid != gpuGrid)
+	{
+		const size_t numMismatches = std::inner_product(cpuGrid.begin(), cpuGrid.end(), gpuGrid.begin(), size_t(0), std::plus<size_t>(), std::not_equal_to<uint16_t>());
+		throw std::runtime_error("CPU and GPU voxelizations differ in " + std::to_string(numMismatches) + " voxels");
+	}
+
+	// Mesh kernels, with texture coordinates spread over the heightfield so that tangents are not degenerate
+	const AABB meshAABB = mesh.getAABB();
+	const mat4 modelMatrix = glm::rotate(glm::translate(mat4(1.0f), vec3(1.0f, 2.0f, 3.0f)), .5f, vec3(.0f, .0f, 1.0f));
+	std::vector<Model3D::VertexGPUData> cpuVertices = mesh.getVertices(), gpuVertices;
+	std::vector<Model3D::FaceGPUData> cpuFaces = mesh.getFaces(), gpuFaces;
+	std::vector<GLuint> cpuMesh, gpuMesh;
+
+	const vec3 meshSize = glm::max(meshAABB.size(), vec3(glm::epsilon<float>()));
+
+	for (Model3D::VertexGPUData& vertex : cpuVertices)
+		vertex._textCoord = vec2((vertex._position.x - meshAABB.min().x) / meshSize.x, (vertex._position.y - meshAABB.min().y) / meshSize.y);
+
+	gpuVertices = cpuVertices;
+	gpuFaces = cpuFaces;
+
+	cpuBackend->applyModelMatrix(cpuVertices, modelMatrix, nullptr);
+	cpuBackend->computeTangents(cpuVertices, cpuFaces);
+	cpuBackend->computeMeshData(cpuVertices, cpuFaces, cpuMesh);
+
+	gpuBackend->applyModelMatrix(gpuVertices, modelMatrix, nullptr);
+	gpuBackend->computeTangents(gpuVertices, gpuFaces);
+	gpuBackend->computeMeshData(gpuVertices, gpuFaces, gpuMesh);
+
+	if (cpuMesh != gpuMesh) throw std::runtime_error("CPU and GPU index buffers differ");
+
+	for (size_t vertexIdx = 0; vertexIdx < cpuVertices.size(); ++vertexIdx)
+	{
+		const Model3D::VertexGPUData& cpuVertex = cpuVertices[vertexIdx], & gpuVertex = gpuVertices[vertexIdx];
+
+		if (!equal(cpuVertex._position, gpuVertex._position) || !equal(cpuVertex._normal, gpuVertex._normal) || !equal(cpuVertex._tangent, gpuVertex._tangent))
+			throw std::runtime_error("CPU and GPU vertices differ at vertex " + std::to_string(vertexIdx));
+	}
+
+	for (size_t faceIdx = 0; faceIdx < cpuFaces.size(); ++faceIdx)
+	{
+		const Model3D::FaceGPUData& cpuFace = cpuFaces[faceIdx], & gpuFace = gpuFaces[faceIdx];
+
+		if (!equal(cpuFace._minPoint, gpuFace._minPoint) || !equal(cpuFace._maxPoint, gpuFace._maxPoint) || !equal(cpuFace._normal, gpuFace._normal))
+			throw std::runtime_error("CPU and GPU faces differ at face " + std::to_string(faceIdx));
+	}
+}
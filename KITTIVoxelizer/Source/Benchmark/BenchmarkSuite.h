@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Benchmark/SyntheticData.h"
+
+class RegularGrid;
+
+/**
+*	@file BenchmarkSuite.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Micro-benchmarks of the core kernels over synthetic inputs. Every kernel is warmed up, then measured several times,
+*	and the samples are summarized (min, median, mean, standard deviation, max and throughput) in a JSON report.
+*/
+class BenchmarkSuite
+{
+public:
+	struct Settings
+	{
+		uvec3		_gridResolution;								//!< Subdivisions of voxelized grids
+		unsigned	_meshResolution;								//!< Quads per axis of the octree heightfield
+		unsigned	_numIterations;									//!< Measured runs of each kernel
+		unsigned	_numPoints;										//!< Points of the synthetic scan
+		unsigned	_numRays;										//!< Rays traced against the octree
+		unsigned	_numWarmup;										//!< Discarded runs of each kernel
+		unsigned	_seed;											//!< Seed of synthetic data
+		bool		_useGPU;										//!< Compute shader kernels are only measured, and validated against CPU, with an active OpenGL context
+
+		/**
+		*	@brief Default constructor.
+		*/
+		Settings() :
+			_gridResolution(256, 256, 32), _meshResolution(128), _numIterations(10), _numPoints(1 << 20), _numRays(1 << 14), _numWarmup(2), _seed(42), _useGPU(false)
+		{
+		}
+	};
+
+	struct Result
+	{
+		std::string			_name;									//!< Kernel identifier
+		size_t				_numItems;								//!< Items processed by each run (points, voxels, rays...)
+		std::vector<double>	_sample;								//!< Milliseconds of each measured run
+		double				_min, _median, _mean, _stdDev, _max;	//!< Summary of samples (milliseconds)
+		double				_throughput;							//!< Items per second according to the median
+	};
+
+protected:
+	const static float		BACKEND_TOLERANCE;						//!< Relative error allowed between CPU and GPU floating-point results
+
+protected:
+	std::vector<Result>		_result;								//!< Measured kernels
+	Settings				_settings;								//!< Input sizes and number of runs
+	std::string				_tempFolder;							//!< Location of synthetic files
+
+protected:
+	/**
+	*	@return True if both vectors are equal up to BACKEND_TOLERANCE, or both NaN.
+	*/
+	static bool equal(const vec3& a, const vec3& b);
+
+	/**
+	*	@brief Runs a kernel the configured number of times. Setup is executed before each run and is not measured.
+	*/
+	void measure(const std::string& name, size_t numItems, const std::function<void()>& kernel, const std::function<void()>& setup = nullptr);
+
+	/**
+	*	@brief Runs voxelization and mesh kernels with both compute backends over the same inputs. Throws if results differ.
+	*/
+	void validateBackends(PointCloud& pointCloud, const RegularGrid& grid, const SyntheticData::SyntheticMesh& mesh);
+
+public:
+	/**
+	*	@brief Constructor.
+	*/
+	BenchmarkSuite(const Settings& settings = Settings());
+
+	/**
+	*	@brief Destructor. Removes synthetic files.
+	*/
+	virtual ~BenchmarkSuite();
+
+	/**
+	*	@brief Generates the synthetic inputs and measures every kernel.
+	*/
+	void run();
+
+	/**
+	*	@brief Writes results as JSON.
+	*	@return Success of writing process.
+	*/
+	bool writeJSON(const std::string& filename) const;
+
+	// Getters
+
+	/**
+	*	@return Measured kernels.
+	*/
+	const std::vector<Result>& getResults() const { return _result; }
+};
+
@@ -0,0 +1,159 @@
+#include "stdafx.h"
+#include "SyntheticData.h"
+
+#include <iomanip>
+
+// Initialization of static attributes
+const std::vector<std::string> SyntheticData::LABEL_PROPERTY_NAMES = { "scalar_Classification" };
+
+const unsigned SyntheticData::ROAD_LABEL = 40;
+const unsigned SyntheticData::BUILDING_LABEL = 50;
+const unsigned SyntheticData::CAR_LABEL = 10;
+const unsigned SyntheticData::VEGETATION_LABEL = 70;
+
+/// [Public methods]
+
+void SyntheticData::generateScan(unsigned numPoints, unsigned numRings, const vec3& sensorPosition, unsigned seed, std::vector<PointCloud::PointModel>& points)
+{
+	// Street along X: ground at z = 0, walls at y = +-STREET_WIDTH, boxes placed every few meters
+	const float STREET_WIDTH = 12.0f, MAX_RANGE = 80.0f, MIN_ELEVATION = glm::radians(-24.9f), MAX_ELEVATION = glm::radians(2.0f);
+	const float BOX_SPACING = 9.0f, BOX_SIZE = 2.0f, BOX_OFFSET = 4.0f;
+
+	std::mt19937 generator(seed);
+	std::normal_distribution<float> noise(.0f, .02f);
+
+	numRings = std::max(numRings, 1u);
+	const unsigned numAzimuths = std::max(numPoints / numRings, 1u);
+
+	points.resize(numPoints);
+
+	for (unsigned pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+	{
+		const unsigned ring = pointIdx % numRings, azimuthIdx = (pointIdx / numRings) % numAzimuths;
+		const float elevation = MIN_ELEVATION + (MAX_ELEVATION - MIN_ELEVATION) * ring / std::max(numRings - 1, 1u);
+		const float azimuth = 2.0f * glm::pi<float>() * azimuthIdx / numAzimuths;
+		const vec3 direction(std::cos(elevation) * std::cos(azimuth), std::cos(elevation) * std::sin(azimuth), std::sin(elevation));
+
+		float distance = MAX_RANGE;
+		unsigned label = VEGETATION_LABEL;
+
+		// Ground
+		if (direction.z < .0f && -sensorPosition.z / direction.z < distance)
+		{
+			distance = -sensorPosition.z / direction.z;
+			label = ROAD_LABEL;
+		}
+
+		// Walls
+		if (std::abs(direction.y) > 1e-6f)
+		{
+			const float wallDistance = ((direction.y > .0f ? STREET_WIDTH : -STREET_WIDTH) - sensorPosition.y) / direction.y;
+			if (wallDistance > .0f && wallDistance < distance) { distance = wallDistance; label = BUILDING_LABEL; }
+		}
+
+		// Boxes on both sides of the street, intersected as the slab y = +-BOX_OFFSET within periodic x intervals
+		if (std::abs(direction.y) > 1e-6f)
+		{
+			const float boxDistance = ((direction.y > .0f ? BOX_OFFSET : -BOX_OFFSET) - sensorPosition.y) / direction.y;
+			const vec3 hit = sensorPosition + direction * boxDistance;
+			const float boxX = hit.x - BOX_SPACING * std::floor(hit.x / BOX_SPACING);
+
+			if (boxDistance > .0f && boxDistance < distance && boxX < BOX_SIZE && hit.z < BOX_SIZE * .75f && hit.z > .0f)
+			{
+				distance = boxDistance;
+				label = CAR_LABEL;
+			}
+		}
+
+		points[pointIdx]._point = sensorPosition + direction * (distance + noise(generator));
+		points[pointIdx]._label = label;
+	}
+}
+
+bool SyntheticData::writePLY(const std::vector<PointCloud::PointModel>& points, const std::string& filename, bool ascii)
+{
+	std::ofstream out(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!out.is_open()) return false;
+
+	out << "ply\nformat " << (ascii ? "ascii" : "binary_little_endian") << " 1.0\nelement vertex " << points.size()
+		<< "\nproperty float x\nproperty float y\nproperty float z\nproperty uchar " << LABEL_PROPERTY_NAMES[0] << "\nend_header\n";
+
+	if (ascii)
+	{
+		out << std::setprecision(9);
+
+		for (const PointCloud::PointModel& point : points)
+			out << point._point.x << ' ' << point._point.y << ' ' << point._point.z << ' ' << point._label << '\n';
+	}
+	else
+	{
+		std::vector<char> record(points.size() * (sizeof(vec3) + 1));
+		char* data = record.data();
+
+		for (const PointCloud::PointModel& point : points)
+		{
+			const uint8_t label = uint8_t(point._label);
+
+			std::memcpy(data, &point._point, sizeof(vec3));
+			data[sizeof(vec3)] = char(label);
+			data += sizeof(vec3) + 1;
+		}
+
+		out.write(record.data(), record.size());
+	}
+
+	out.close();
+
+	return !out.fail();
+}
+
+/// [SyntheticMesh]
+
+SyntheticData::SyntheticMesh::SyntheticMesh(unsigned resolution, float size, unsigned seed) : Model3D(mat4(1.0f), 1)
+{
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<float> height(.0f, size * .05f);
+
+	ModelComponent* modelComp = _modelComp[0];
+	const unsigned numVertices = resolution + 1;
+
+	modelComp->_geometry.resize(numVertices * numVertices);
+
+	for (unsigned x = 0; x < numVertices; ++x)
+	{
+		for (unsigned y = 0; y < numVertices; ++y)
+		{
+			VertexGPUData& vertex = modelComp->_geometry[x * numVertices + y];
+			vertex._position = vec3(size * x / resolution, size * y / resolution, height(generator));
+			vertex._normal = vec3(.0f, .0f, 1.0f);
+		}
+	}
+
+	for (unsigned x = 0; x < resolution; ++x)
+	{
+		for (unsigned y = 0; y < resolution; ++y)
+		{
+			const unsigned corner = x * numVertices + y;
+			FaceGPUData face;
+			face._modelCompID = 0;
+
+			face._vertices = uvec3(corner, corner + numVertices, corner + 1);
+			modelComp->_topology.push_back(face);
+
+			face._vertices = uvec3(corner + 1, corner + numVertices, corner + numVertices + 1);
+			modelComp->_topology.push_back(face);
+		}
+	}
+
+	_loaded = true;
+}
+
+AABB SyntheticData::SyntheticMesh::getAABB() const
+{
+	AABB aabb;
+
+	for (const VertexGPUData& vertex : _modelComp[0]->_geometry)
+		aabb.update(vertex._position);
+
+	return aabb;
+}
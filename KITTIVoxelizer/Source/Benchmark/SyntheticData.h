@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Graphics/Core/Model3D.h"
+#include "Graphics/Core/PointCloud.h"
+
+/**
+*	@file SyntheticData.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Deterministic generator of benchmark inputs. The same seed always produces the same scans and meshes.
+*/
+class SyntheticData
+{
+public:
+	const static std::vector<std::string> LABEL_PROPERTY_NAMES;		//!< Label property written in synthetic PLY files
+
+	// Labels of synthetic scans, as in SemanticKITTI
+	const static unsigned	ROAD_LABEL;								//!< Points hitting the ground
+	const static unsigned	BUILDING_LABEL;							//!< Points hitting walls
+	const static unsigned	CAR_LABEL;								//!< Points hitting obstacles
+	const static unsigned	VEGETATION_LABEL;						//!< Points hitting nothing within the maximum range
+
+public:
+	/**
+	*	@brief Mesh with a single component whose geometry is given at construction. Nothing is sent to GPU.
+	*/
+	class SyntheticMesh : public Model3D
+	{
+	public:
+		/**
+		*	@brief Constructor of a heightfield of resolution x resolution quads over [0, size]^2.
+		*/
+		SyntheticMesh(unsigned resolution, float size, unsigned seed);
+
+		/**
+		*	@brief Geometry is already generated at construction.
+		*/
+		virtual bool load(const mat4& modelMatrix = mat4(1.0f)) { return true; }
+
+		/**
+		*	@return Bounding box of the heightfield.
+		*/
+		AABB getAABB() const;
+
+		/**
+		*	@return Vertices of the heightfield.
+		*/
+		const std::vector<VertexGPUData>& getVertices() const { return _modelComp[0]->_geometry; }
+
+		/**
+		*	@return Triangles of the heightfield.
+		*/
+		const std::vector<FaceGPUData>& getFaces() const { return _modelComp[0]->_topology; }
+	};
+
+public:
+	/**
+	*	@brief Simulates a rotating LiDAR with numRings beams located at sensorPosition, within a street of walls and boxes.
+	*	@param numPoints Number of points, spread among rings and azimuth steps.
+	*/
+	static void generateScan(unsigned numPoints, unsigned numRings, const vec3& sensorPosition, unsigned seed, std::vector<PointCloud::PointModel>& points);
+
+	/**
+	*	@brief Writes points as a PLY file with float coordinates and an uchar label property.
+	*	@return Success of writing process.
+	*/
+	static bool writePLY(const std::vector<PointCloud::PointModel>& points, const std::string& filename, bool ascii);
+};
+
@@ -0,0 +1,167 @@
+#include "stdafx.h"
+#include "ThroughputBenchmark.h"
+
+#include "Graphics/Core/ComputeBackend.h"
+#include "Utilities/MemoryTracker.h"
+#include <filesystem>
+#include <iomanip>
+
+// Initialization of static attributes
+const unsigned ThroughputBenchmark::RESIDENT_SAMPLING_MS = 5;
+
+/// [Public methods]
+
+ThroughputBenchmark::ThroughputBenchmark(const Settings& settings) : _settings(settings)
+{
+	_tempFolder = (std::filesystem::temp_directory_path() / "KITTIVoxelizerThroughput").generic_string() + "/";
+}
+
+ThroughputBenchmark::~ThroughputBenchmark()
+{
+	std::error_code error;
+	std::filesystem::remove_all(_tempFolder, error);
+}
+
+void ThroughputBenchmark::run()
+{
+	_result.clear();
+	this->generateSequence();
+
+	// Binary caches of point clouds are written by the first run, which is therefore discarded
+	this->runPipeline(_settings._maxIOThreads);
+
+	for (unsigned numIOThreads : this->getIOThreadCounts())
+	{
+		Result result = this->runPipeline(numIOThreads);
+		result._speedup = _result.empty() || _result.front()._scansPerSecond <= .0 ? 1.0 : result._scansPerSecond / _result.front()._scansPerSecond;
+
+		std::cout << numIOThreads << " I/O threads: " << result._scansPerSecond << " scans/s, speedup " << result._speedup << std::endl;
+
+		_result.push_back(result);
+	}
+}
+
+bool ThroughputBenchmark::writeJSON(const std::string& filename) const
+{
+	std::ofstream out(filename, std::ios::out | std::ios::trunc);
+	if (!out.is_open()) return false;
+
+	out << std::setprecision(9);
+	out << "{\n\t\"settings\": {\n";
+	out << "\t\t\"grid_resolution\": [" << _settings._gridResolution.x << ", " << _settings._gridResolution.y << ", " << _settings._gridResolution.z << "],\n";
+	out << "\t\t\"points_per_scan\": " << _settings._numPoints << ",\n";
+	out << "\t\t\"rings\": " << _settings._numRings << ",\n";
+	out << "\t\t\"scans\": " << _settings._numScans << ",\n";
+	out << "\t\t\"seed\": " << _settings._seed << ",\n";
+	out << "\t\t\"compute_backend\": \"" << ComputeBackend::getBackendName(ComputeBackend::getSelectedBackend()) << "\",\n";
+	out << "\t\t\"hardware_threads\": " << std::thread::hardware_concurrency() << "\n\t},\n\t\"runs\": [\n";
+
+	for (size_t resultIdx = 0; resultIdx < _result.size(); ++resultIdx)
+	{
+		const Result& result = _result[resultIdx];
+
+		out << "\t\t{\n\t\t\t\"io_threads\": " << result._numIOThreads << ",\n\t\t\t\"scans\": " << result._timings._numScans << ",\n";
+		out << "\t\t\t\"wall_ms\": " << result._timings._total << ",\n\t\t\t\"scans_per_second\": " << result._scansPerSecond << ",\n";
+		out << "\t\t\t\"read_ms\": " << result._timings._read << ",\n\t\t\t\"voxelization_ms\": " << result._timings._voxelization << ",\n\t\t\t\"export_ms\": " << result._timings._export << ",\n";
+		out << "\t\t\t\"speedup\": " << result._speedup << ",\n";
+		out << "\t\t\t\"peak_rss_bytes\": " << result._peakResidentSize << ",\n\t\t\t\"peak_tracked_bytes\": " << result._peakTrackedSize << "\n\t\t}" << (resultIdx + 1 < _result.size() ? "," : "") << '\n';
+	}
+
+	out << "\t]\n}\n";
+	out.close();
+
+	return !out.fail();
+}
+
+/// [Protected methods]
+
+void ThroughputBenchmark::generateSequence()
+{
+	const std::string sequenceFolder = _tempFolder + "velodyne/";
+	std::filesystem::create_directories(sequenceFolder);
+
+	_scanPath.resize(_settings._numScans);
+	std::vector<unsigned> scanIdx(_settings._numScans);
+	std::atomic<bool> success(true);
+
+	std::iota(scanIdx.begin(), scanIdx.end(), 0);
+	std::for_each(std::execution::par, scanIdx.begin(), scanIdx.end(), [&](const unsigned idx)
+	{
+		std::vector<PointCloud::PointModel> points;
+		std::stringstream filename;
+		filename << sequenceFolder << std::setw(6) << std::setfill('0') << idx;
+
+		// The sensor drives along the street, as a vehicle would do
+		SyntheticData::generateScan(_settings._numPoints, _settings._numRings, vec3(idx * _settings._sensorSpeed, .0f, 1.73f), _settings._seed + idx, points);
+
+		_scanPath[idx] = filename.str();
+		if (!SyntheticData::writePLY(points, _scanPath[idx] + PLY_EXTENSION, false)) success = false;
+	});
+
+	if (!success) throw std::runtime_error("Synthetic sequence could not be written in " + sequenceFolder);
+}
+
+std::vector<unsigned> ThroughputBenchmark::getIOThreadCounts() const
+{
+	std::vector<unsigned> numIOThreads;
+
+	for (unsigned threads = 1; threads < _settings._maxIOThreads; threads *= 2) numIOThreads.push_back(threads);
+	numIOThreads.push_back(std::max(_settings._maxIOThreads, 1u));
+
+	return numIOThreads;
+}
+
+ThroughputBenchmark::Result ThroughputBenchmark::runPipeline(unsigned numIOThreads)
+{
+	VoxelizationPipeline::Settings settings;
+	settings._incremental = false;
+	settings._numReaders = settings._numWriters = numIOThreads;
+	settings._readQueueDepth = settings._writeQueueDepth = std::max(numIOThreads * 2, 4u);
+
+	const std::string outputFolder = _tempFolder + "grids/";
+	std::filesystem::create_directories(outputFolder);
+
+	VoxelizationPipeline pipeline(settings);
+	PointCloud* pointCloud = nullptr;
+	RegularGrid* grid = nullptr;
+
+	std::atomic<bool> running(true);
+	size_t peakResidentSize = MemoryTracker::getResidentSize();
+
+	std::thread sampler([&]()
+	{
+		while (running)
+		{
+			peakResidentSize = std::max(peakResidentSize, MemoryTracker::getResidentSize());
+			std::this_thread::sleep_for(std::chrono::milliseconds(RESIDENT_SAMPLING_MS));
+		}
+	});
+
+	MemoryTracker::getInstance()->resetPeaks();
+
+	try
+	{
+		pipeline.run(_scanPath, outputFolder, _settings._gridResolution, pointCloud, grid);
+	}
+	catch (...)
+	{
+		running = false;
+		sampler.join();
+		throw;
+	}
+
+	running = false;
+	sampler.join();
+
+	delete pointCloud;
+	delete grid;
+
+	Result result = {};
+	result._numIOThreads = numIOThreads;
+	result._timings = pipeline.getTimings();
+	result._scansPerSecond = result._timings._total > .0 ? result._timings._numScans / (result._timings._total * 1e-3) : .0;
+	result._peakResidentSize = std::max(peakResidentSize, MemoryTracker::getResidentSize());
+	result._peakTrackedSize = MemoryTracker::getInstance()->getPeakTotal();
+
+	return result;
+}
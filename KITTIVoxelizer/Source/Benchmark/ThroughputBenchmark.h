@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Benchmark/SyntheticData.h"
+#include "Graphics/Application/VoxelizationPipeline.h"
+
+/**
+*	@file ThroughputBenchmark.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief End-to-end benchmark of batch voxelization. A synthetic labelled sequence is written on disk and then voxelized and
+*	exported by VoxelizationPipeline with an increasing number of reading and writing (I/O) threads. Voxelization and the parallel
+*	algorithms within each stage still use every core, hence runs measure how I/O overlapping scales rather than core scaling.
+*/
+class ThroughputBenchmark
+{
+protected:
+	const static unsigned	RESIDENT_SAMPLING_MS;					//!< Period between samples of the resident set size during a run
+
+public:
+	struct Settings
+	{
+		uvec3		_gridResolution;								//!< Subdivisions of voxelized grids
+		unsigned	_maxIOThreads;									//!< Largest number of reading threads, and of writing threads
+		unsigned	_numPoints;										//!< Points per scan
+		unsigned	_numRings;										//!< Beams of the simulated sensor
+		unsigned	_numScans;										//!< Length of the synthetic sequence
+		unsigned	_seed;											//!< Seed of the first scan
+		float		_sensorSpeed;									//!< Distance travelled by the sensor between consecutive scans
+
+		/**
+		*	@brief Default constructor. Resembles a KITTI sequence captured by a Velodyne HDL-64E.
+		*/
+		Settings() :
+			_gridResolution(256, 256, 32), _maxIOThreads(std::max(std::thread::hardware_concurrency(), 1u)), _numPoints(64 * 1800), _numRings(64), _numScans(100), _seed(42), _sensorSpeed(.8f)
+		{
+		}
+	};
+
+	struct Result
+	{
+		unsigned							_numIOThreads;			//!< Reading threads, and writing threads
+		VoxelizationPipeline::Timings		_timings;				//!< Stage breakdown
+		double								_scansPerSecond;		//!< Throughput of the whole run
+		double								_speedup;				//!< Throughput relative to a single reading and writing thread
+		size_t								_peakResidentSize;		//!< Largest resident set size sampled during the run, in bytes
+		size_t								_peakTrackedSize;		//!< Peak bytes reported to MemoryTracker during the run
+	};
+
+protected:
+	std::vector<Result>		_result;								//!< One entry per I/O thread count
+	std::vector<std::string>	_scanPath;							//!< Synthetic scans, with no extension
+	Settings				_settings;								//!< Sequence and scaling parameters
+	std::string				_tempFolder;							//!< Location of the synthetic sequence and its grids
+
+protected:
+	/**
+	*	@brief Writes the synthetic sequence, as in KITTI, i.e. a numbered PLY file per scan.
+	*/
+	void generateSequence();
+
+	/**
+	*	@return I/O thread counts to be measured: powers of two up to maxIOThreads, and maxIOThreads itself.
+	*/
+	std::vector<unsigned> getIOThreadCounts() const;
+
+	/**
+	*	@brief Voxelizes the whole sequence once. The resident set size is sampled on another thread, as the peak of the process
+	*	never decreases and would hide the footprint of later runs.
+	*/
+	Result runPipeline(unsigned numIOThreads);
+
+public:
+	/**
+	*	@brief Constructor.
+	*/
+	ThroughputBenchmark(const Settings& settings = Settings());
+
+	/**
+	*	@brief Destructor. Removes the synthetic sequence and its grids.
+	*/
+	virtual ~ThroughputBenchmark();
+
+	/**
+	*	@brief Generates the sequence and measures every I/O thread count. Must be called from the thread which owns the OpenGL context.
+	*	Throws if the sequence cannot be written or a run fails.
+	*/
+	void run();
+
+	/**
+	*	@brief Writes settings and results in JSON format.
+	*	@return Success of writing process.
+	*/
+	bool writeJSON(const std::string& filename) const;
+
+	// Getters
+
+	/**
+	*	@return Results of the last run.
+	*/
+	const std::vector<Result>& getResults() const { return _result; }
+};
+
@@ -0,0 +1,119 @@
+#pragma once
+
+/**
+*	@file BoundedQueue.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Thread-safe FIFO queue with limited capacity. Producers are blocked while the queue is full (back-pressure).
+*/
+template<typename T>
+class BoundedQueue
+{
+protected:
+	size_t						_capacity;							//!< Maximum number of queued elements
+	bool						_closed;							//!< No more elements can be pushed once closed
+	std::deque<T>				_queue;								//!< Queued elements
+
+	// Synchronization
+	std::mutex					_mutex;								//!< Protects every attribute
+	std::condition_variable		_notEmpty;							//!< Wakes up consumers
+	std::condition_variable		_notFull;							//!< Wakes up producers
+
+public:
+	/**
+	*	@brief Constructor of an empty queue with a maximum capacity (at least one element).
+	*/
+	BoundedQueue(size_t capacity);
+
+	/**
+	*	@brief Invalid copy constructor.
+	*/
+	BoundedQueue(const BoundedQueue& queue) = delete;
+
+	/**
+	*	@brief Destructor.
+	*/
+	virtual ~BoundedQueue();
+
+	/**
+	*	@brief Rejects any further push and wakes up every waiting thread. Queued elements can still be popped.
+	*/
+	void close();
+
+	/**
+	*	@brief Retrieves the oldest element, waiting for it if the queue is empty.
+	*	@return False if the queue is closed and empty.
+	*/
+	bool pop(T& value);
+
+	/**
+	*	@brief Inserts a new element, waiting for room if the queue is full.
+	*	@return False if the queue was closed and the element has been discarded.
+	*/
+	bool push(T&& value);
+
+	/**
+	*	@brief Invalid assignment operator.
+	*/
+	BoundedQueue& operator=(const BoundedQueue& queue) = delete;
+};
+
+template<typename T>
+inline BoundedQueue<T>::BoundedQueue(size_t capacity) : _capacity(std::max(capacity, size_t(1))), _closed(false)
+{
+}
+
+template<typename T>
+inline BoundedQueue<T>::~BoundedQueue()
+{
+}
+
+template<typename T>
+inline void BoundedQueue<T>::close()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_closed = true;
+	}
+
+	_notEmpty.notify_all();
+	_notFull.notify_all();
+}
+
+template<typename T>
+inline bool BoundedQueue<T>::pop(T& value)
+{
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_notEmpty.wait(lock, [this] { return _closed || !_queue.empty(); });
+
+		if (_queue.empty()) return false;
+
+		value = std::move(_queue.front());
+		_queue.pop_front();
+	}
+
+	_notFull.notify_one();
+
+	return true;
+}
+
+template<typename T>
+inline bool BoundedQueue<T>::push(T&& value)
+{
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_notFull.wait(lock, [this] { return _closed || _queue.size() < _capacity; });
+
+		if (_closed) return false;
+
+		_queue.push_back(std::move(value));
+	}
+
+	_notEmpty.notify_one();
+
+	return true;
+}
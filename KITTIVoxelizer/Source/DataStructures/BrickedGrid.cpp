@@ -0,0 +1,299 @@
+#include "stdafx.h"
+#include "BrickedGrid.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Initialization of static attributes
+const unsigned BrickedGrid::BRICK_SIZE = 16;
+const size_t BrickedGrid::MAX_VOXELS = size_t(1) << 31;
+const uint32_t BrickedGrid::SIGNATURE = 0x31425856;			// VXB1
+
+/// [Public methods]
+
+bool BrickedGrid::exportGrid(RegularGrid* grid, const std::string& filename)
+{
+	const uvec3 numDivs = grid->getNumSubdivisions();
+	const uvec3 numBricks = (numDivs + uvec3(BRICK_SIZE - 1)) / uvec3(BRICK_SIZE);
+	const size_t numBricksTotal = size_t(numBricks.x) * numBricks.y * numBricks.z, brickVoxels = size_t(BRICK_SIZE) * BRICK_SIZE * BRICK_SIZE;
+	const uint16_t* voxel = grid->data();
+
+	std::vector<std::vector<unsigned char>> payload(numBricksTotal);
+	std::vector<uint8_t> emptyBrick((numBricksTotal + 7) / 8, 0), isEmpty(numBricksTotal, 0);
+	std::vector<size_t> brickIdx(numBricksTotal);
+	std::atomic<bool> success(true);
+
+	std::iota(brickIdx.begin(), brickIdx.end(), 0);
+	std::for_each(std::execution::par, brickIdx.begin(), brickIdx.end(), [&](const size_t idx)
+	{
+		const uvec3 brick(idx / (numBricks.y * numBricks.z), (idx / numBricks.z) % numBricks.y, idx % numBricks.z);
+		const uvec3 minVoxel = brick * BRICK_SIZE, maxVoxel = glm::min(minVoxel + uvec3(BRICK_SIZE), numDivs);
+		std::vector<uint16_t> brickVoxel(brickVoxels, VOXEL_EMPTY);
+		bool empty = true;
+
+		// Bricks on the boundary are padded with empty voxels
+		for (unsigned x = minVoxel.x; x < maxVoxel.x; ++x)
+		{
+			for (unsigned y = minVoxel.y; y < maxVoxel.y; ++y)
+			{
+				const uint16_t* row = voxel + RegularGrid::getPositionIndex(x, y, minVoxel.z, numDivs);
+				uint16_t* brickRow = brickVoxel.data() + RegularGrid::getPositionIndex(x - minVoxel.x, y - minVoxel.y, 0, uvec3(BRICK_SIZE));
+
+				std::copy(row, row + (maxVoxel.z - minVoxel.z), brickRow);
+				empty &= std::all_of(row, row + (maxVoxel.z - minVoxel.z), [](const uint16_t label) { return label == VOXEL_EMPTY; });
+			}
+		}
+
+		isEmpty[idx] = empty;
+
+		if (!empty && lodepng::compress(payload[idx], reinterpret_cast<const unsigned char*>(brickVoxel.data()), brickVoxels * sizeof(uint16_t))) success = false;
+	});
+
+	if (!success) return false;
+
+	const uint32_t numDivs32[3] = { numDivs.x, numDivs.y, numDivs.z }, brickSize = BRICK_SIZE;
+	const AABB aabb = grid->getAABB();
+	const vec3 aabbMin = aabb.min(), aabbMax = aabb.max();
+	const size_t headerSize = sizeof(uint32_t) * 5 + sizeof(vec3) * 2;
+
+	std::vector<uint64_t> offset(numBricksTotal + 1);
+	offset[0] = headerSize + emptyBrick.size() + offset.size() * sizeof(uint64_t);
+
+	for (size_t idx = 0; idx < numBricksTotal; ++idx)
+	{
+		emptyBrick[idx / 8] |= isEmpty[idx] << (idx % 8);
+		offset[idx + 1] = offset[idx] + payload[idx].size();
+	}
+
+	std::ofstream out(filename + BRICKED_GRID_EXTENSION, std::ios::out | std::ios::binary);
+	if (!out.is_open()) return false;
+
+	out.write((const char*)&SIGNATURE, sizeof(uint32_t));
+	out.write((const char*)numDivs32, sizeof(numDivs32));
+	out.write((const char*)&aabbMin, sizeof(vec3));
+	out.write((const char*)&aabbMax, sizeof(vec3));
+	out.write((const char*)&brickSize, sizeof(uint32_t));
+	out.write((const char*)emptyBrick.data(), emptyBrick.size());
+	out.write((const char*)offset.data(), offset.size() * sizeof(uint64_t));
+
+	for (const std::vector<unsigned char>& brickPayload : payload)
+		out.write((const char*)brickPayload.data(), brickPayload.size());
+
+	out.close();
+
+	return !out.fail();
+}
+
+BrickedGrid::BrickedGrid(const std::string& filename) : _filename(filename), _file(-1), _fileSize(0)
+{
+}
+
+BrickedGrid::~BrickedGrid()
+{
+	this->close();
+}
+
+bool BrickedGrid::isBrickEmpty(const uvec3& brick) const
+{
+	const size_t idx = RegularGrid::getPositionIndex(brick.x, brick.y, brick.z, _numBricks);
+
+	return (_emptyBrick[idx / 8] >> (idx % 8)) & 1;
+}
+
+bool BrickedGrid::open()
+{
+	if (_file == -1)
+	{
+#ifdef _WIN32
+		_file = reinterpret_cast<intptr_t>(CreateFileA(_filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr));
+#else
+		_file = ::open(_filename.c_str(), O_RDONLY);
+#endif
+		if (_file == -1) return false;
+
+#ifdef _WIN32
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(reinterpret_cast<HANDLE>(_file), &fileSize)) fileSize.QuadPart = 0;
+		_fileSize = uint64_t(fileSize.QuadPart);
+#else
+		struct stat fileStat;
+		_fileSize = fstat(int(_file), &fileStat) ? 0 : uint64_t(fileStat.st_size);
+#endif
+	}
+
+	uint32_t header[5];
+	vec3 aabbMin, aabbMax;
+	const size_t headerSize = sizeof(header) + sizeof(vec3) * 2;
+
+	if (!this->readAt(0, sizeof(uint32_t) * 4, header) || !this->readAt(sizeof(uint32_t) * 4, sizeof(vec3), &aabbMin) ||
+		!this->readAt(sizeof(uint32_t) * 4 + sizeof(vec3), sizeof(vec3), &aabbMax) || !this->readAt(sizeof(uint32_t) * 4 + sizeof(vec3) * 2, sizeof(uint32_t), &header[4]))
+	{
+		this->close();
+		return false;
+	}
+
+	// Dimensions are bounded before sizing the index, as the bitmap and offset table must also fit in the file
+	const uvec3 numDivs(header[1], header[2], header[3]);
+	const uvec3 numBricks = (numDivs + uvec3(BRICK_SIZE - 1)) / uvec3(BRICK_SIZE);
+	const size_t numBricksTotal = size_t(numBricks.x) * numBricks.y * numBricks.z;
+	const size_t bitmapSize = (numBricksTotal + 7) / 8, tableSize = (numBricksTotal + 1) * sizeof(uint64_t);
+
+	if (header[0] != SIGNATURE || header[4] != BRICK_SIZE || !numBricksTotal ||
+		size_t(numDivs.x) * numDivs.y > MAX_VOXELS || size_t(numDivs.x) * numDivs.y * numDivs.z > MAX_VOXELS ||
+		headerSize + bitmapSize + tableSize > _fileSize)
+	{
+		this->close();
+		return false;
+	}
+
+	_numDivs = numDivs;
+	_numBricks = numBricks;
+	_aabb = AABB(aabbMin, aabbMax);
+	_emptyBrick.resize(bitmapSize);
+	_offset.resize(numBricksTotal + 1);
+
+	if (!this->readAt(headerSize, _emptyBrick.size(), _emptyBrick.data()) || !this->readAt(headerSize + bitmapSize, tableSize, _offset.data()))
+	{
+		this->close();
+		return false;
+	}
+
+	// Bricks follow the table, are stored in order and end within the file
+	bool valid = _offset.front() == headerSize + bitmapSize + tableSize && _offset.back() <= _fileSize;
+	for (size_t idx = 0; idx < numBricksTotal && valid; ++idx) valid = _offset[idx] <= _offset[idx + 1];
+
+	if (!valid) this->close();
+
+	return valid;
+}
+
+bool BrickedGrid::readBrick(const uvec3& brick, std::vector<uint16_t>& voxels) const
+{
+	const size_t idx = RegularGrid::getPositionIndex(brick.x, brick.y, brick.z, _numBricks), brickVoxels = size_t(BRICK_SIZE) * BRICK_SIZE * BRICK_SIZE;
+
+	if (this->isBrickEmpty(brick))
+	{
+		voxels.assign(brickVoxels, VOXEL_EMPTY);
+		return true;
+	}
+
+	// Offsets were validated against the file length by open(); inflation is bounded by the brick size
+	LodePNGDecompressSettings settings;
+	lodepng_decompress_settings_init(&settings);
+	settings.max_output_size = brickVoxels * sizeof(uint16_t);
+
+	std::vector<unsigned char> payload(_offset[idx + 1] - _offset[idx]), inflated;
+	if (!this->readAt(_offset[idx], payload.size(), payload.data())) return false;
+	if (lodepng::decompress(inflated, payload.data(), payload.size(), settings) || inflated.size() != brickVoxels * sizeof(uint16_t)) return false;
+
+	voxels.resize(brickVoxels);
+	std::memcpy(voxels.data(), inflated.data(), inflated.size());
+
+	return true;
+}
+
+RegularGrid* BrickedGrid::readGrid() const
+{
+	std::vector<uint16_t> labels;
+	if (_offset.empty() || !this->readRegion(uvec3(0), _numDivs, labels)) return nullptr;
+
+	RegularGrid* grid = new RegularGrid(_aabb, _numDivs);
+	std::copy(labels.begin(), labels.end(), grid->data());
+
+	return grid;
+}
+
+bool BrickedGrid::readRegion(const uvec3& minVoxel, const uvec3& maxVoxel, std::vector<uint16_t>& labels) const
+{
+	const uvec3 regionMax = glm::min(maxVoxel, _numDivs), regionMin = glm::min(minVoxel, regionMax);
+	const uvec3 regionSize = regionMax - regionMin;
+
+	labels.assign(size_t(regionSize.x) * regionSize.y * regionSize.z, VOXEL_EMPTY);
+	if (labels.empty()) return true;
+
+	// Only bricks overlapping the region and holding any label are read
+	const uvec3 minBrick = regionMin / BRICK_SIZE, maxBrick = (regionMax + uvec3(BRICK_SIZE - 1)) / BRICK_SIZE;
+	std::vector<uvec3> brick;
+
+	for (unsigned x = minBrick.x; x < maxBrick.x; ++x)
+		for (unsigned y = minBrick.y; y < maxBrick.y; ++y)
+			for (unsigned z = minBrick.z; z < maxBrick.z; ++z)
+				if (!this->isBrickEmpty(uvec3(x, y, z))) brick.push_back(uvec3(x, y, z));
+
+	std::atomic<bool> success(true);
+
+	std::for_each(std::execution::par, brick.begin(), brick.end(), [&](const uvec3& currentBrick)
+	{
+		std::vector<uint16_t> voxels;
+
+		if (!this->readBrick(currentBrick, voxels))
+		{
+			success = false;
+			return;
+		}
+
+		const uvec3 brickMin = currentBrick * BRICK_SIZE;
+		const uvec3 copyMin = glm::max(brickMin, regionMin), copyMax = glm::min(brickMin + uvec3(BRICK_SIZE), regionMax);
+
+		for (unsigned x = copyMin.x; x < copyMax.x; ++x)
+		{
+			for (unsigned y = copyMin.y; y < copyMax.y; ++y)
+			{
+				const uint16_t* brickRow = voxels.data() + RegularGrid::getPositionIndex(x - brickMin.x, y - brickMin.y, copyMin.z - brickMin.z, uvec3(BRICK_SIZE));
+				std::copy(brickRow, brickRow + (copyMax.z - copyMin.z), labels.data() + RegularGrid::getPositionIndex(x - regionMin.x, y - regionMin.y, copyMin.z - regionMin.z, regionSize));
+			}
+		}
+	});
+
+	return success;
+}
+
+/// [Protected methods]
+
+void BrickedGrid::close()
+{
+	if (_file != -1)
+	{
+#ifdef _WIN32
+		CloseHandle(reinterpret_cast<HANDLE>(_file));
+#else
+		::close(int(_file));
+#endif
+	}
+
+	_file = -1;
+	_fileSize = 0;
+	_numDivs = _numBricks = uvec3(0);
+	_emptyBrick.clear();
+	_offset.clear();
+}
+
+bool BrickedGrid::readAt(uint64_t offset, size_t size, void* buffer) const
+{
+	if (_file == -1) return false;
+
+	char* destination = static_cast<char*>(buffer);
+
+	while (size)
+	{
+#ifdef _WIN32
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = DWORD(offset);
+		overlapped.OffsetHigh = DWORD(offset >> 32);
+
+		DWORD numBytes = 0;
+		if (!ReadFile(reinterpret_cast<HANDLE>(_file), destination, DWORD(std::min(size, size_t(1) << 30)), &numBytes, &overlapped) || !numBytes) return false;
+#else
+		const ssize_t numBytes = pread(int(_file), destination, size, off_t(offset));
+		if (numBytes <= 0) return false;
+#endif
+		destination += numBytes;
+		offset += numBytes;
+		size -= numBytes;
+	}
+
+	return true;
+}
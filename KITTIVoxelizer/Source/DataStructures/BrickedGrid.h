@@ -0,0 +1,119 @@
+#pragma once
+
+#include "DataStructures/RegularGrid.h"
+
+/**
+*	@file BrickedGrid.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+#define BRICKED_GRID_EXTENSION ".vxb"
+
+/**
+*	@brief Random-access file of voxel labels split into bricks of BRICK_SIZE^3 voxels. The file is composed of a header, a bitmap
+*	of empty bricks, a table with the offset of each brick and the bricks deflated independently. Hence, a region can be read
+*	without inflating the whole grid, and bricks are encoded and decoded in parallel.
+*/
+class BrickedGrid
+{
+public:
+	const static unsigned	BRICK_SIZE;								//!< Voxels per brick axis
+	const static size_t		MAX_VOXELS;								//!< Largest grid accepted by open(), so that corrupt headers do not trigger huge allocations
+	const static uint32_t	SIGNATURE;								//!< First bytes of bricked grids
+
+protected:
+	AABB					_aabb;									//!< Bounding box of the grid
+	std::vector<uint8_t>	_emptyBrick;							//!< Bitmap of bricks with only empty voxels
+	std::string				_filename;								//!< Path of bricked file
+	intptr_t				_file;									//!< Native descriptor used for positional reads
+	uint64_t				_fileSize;								//!< Length of the file, checked against the offset table
+	uvec3					_numBricks;								//!< Number of bricks per axis
+	uvec3					_numDivs;								//!< Number of voxels per axis
+	std::vector<uint64_t>	_offset;								//!< Location of each brick in the file, followed by the end of the last one
+
+protected:
+	/**
+	*	@brief Closes the file and clears the index, so that a failed open() leaves an empty reader.
+	*/
+	void close();
+
+	/**
+	*	@brief Reads size bytes at a given offset. Safe to be called from several threads at once.
+	*/
+	bool readAt(uint64_t offset, size_t size, void* buffer) const;
+
+public:
+	/**
+	*	@brief Writes a regular grid as a bricked file. Bricks are deflated in parallel.
+	*	@return Success of writing process.
+	*/
+	static bool exportGrid(RegularGrid* grid, const std::string& filename);
+
+public:
+	/**
+	*	@brief Constructor of a reader. The file is not opened until open() is called.
+	*/
+	BrickedGrid(const std::string& filename);
+
+	/**
+	*	@brief Invalid copy constructor.
+	*/
+	BrickedGrid(const BrickedGrid& grid) = delete;
+
+	/**
+	*	@brief Destructor. Closes the file.
+	*/
+	virtual ~BrickedGrid();
+
+	/**
+	*	@return True if every voxel of the brick is empty, in which case nothing is read from disk.
+	*/
+	bool isBrickEmpty(const uvec3& brick) const;
+
+	/**
+	*	@brief Reads the header, bitmap and index table. Every brick is checked to lie within the file.
+	*	@return False if the file could not be opened, is not a bricked grid or is truncated.
+	*/
+	bool open();
+
+	/**
+	*	@brief Invalid assignment operator.
+	*/
+	BrickedGrid& operator=(const BrickedGrid& grid) = delete;
+
+	/**
+	*	@brief Inflates a single brick, ordered as BRICK_SIZE^3 voxels with the same axis order as RegularGrid.
+	*/
+	bool readBrick(const uvec3& brick, std::vector<uint16_t>& voxels) const;
+
+	/**
+	*	@brief Builds a regular grid with the whole content of the file.
+	*	@return Null if any brick is corrupted.
+	*/
+	RegularGrid* readGrid() const;
+
+	/**
+	*	@brief Reads the voxels within [minVoxel, maxVoxel). Only overlapping bricks are inflated, in parallel.
+	*	@param labels Output voxels, indexed as RegularGrid::getPositionIndex within the region.
+	*/
+	bool readRegion(const uvec3& minVoxel, const uvec3& maxVoxel, std::vector<uint16_t>& labels) const;
+
+	// Getters
+
+	/**
+	*	@return Bounding box of the grid.
+	*/
+	AABB getAABB() const { return _aabb; }
+
+	/**
+	*	@return Number of bricks per axis.
+	*/
+	uvec3 getNumBricks() const { return _numBricks; }
+
+	/**
+	*	@return Number of voxels per axis.
+	*/
+	uvec3 getNumSubdivisions() const { return _numDivs; }
+};
+
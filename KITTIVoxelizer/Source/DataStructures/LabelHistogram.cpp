@@ -0,0 +1,41 @@
+#include "stdafx.h"
+#include "LabelHistogram.h"
+
+// Initialization of static attributes
+const size_t LabelHistogram::RESET_CHUNK_SIZE = 1 << 16;
+
+/// [Public methods]
+
+LabelHistogram::LabelHistogram() : _capacity(0), _size(0), _memory(MemoryTracker::LABEL_HISTOGRAM)
+{
+}
+
+LabelHistogram::~LabelHistogram()
+{
+}
+
+void LabelHistogram::reset(size_t size)
+{
+	if (size > _capacity)
+	{
+		// Previous counters are released first so that both buffers are never held at once
+		_count.reset();
+		_memory.resize(0);
+
+		_count.reset(new std::atomic<unsigned>[size]);
+		_capacity = size;
+		_memory.resize(_capacity * sizeof(unsigned));
+	}
+
+	_size = size;
+
+	std::vector<size_t> chunks((_size + RESET_CHUNK_SIZE - 1) / RESET_CHUNK_SIZE);
+	std::iota(chunks.begin(), chunks.end(), 0);
+
+	std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](const size_t chunk)
+	{
+		const size_t firstIndex = chunk * RESET_CHUNK_SIZE, lastIndex = std::min(firstIndex + RESET_CHUNK_SIZE, _size);
+
+		for (size_t index = firstIndex; index < lastIndex; ++index) _count[index].store(0, std::memory_order_relaxed);
+	});
+}
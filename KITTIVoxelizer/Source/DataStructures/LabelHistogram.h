@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Utilities/MemoryTracker.h"
+
+/**
+*	@file LabelHistogram.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Atomic counters of label votes per voxel, which can be reused across voxelizations. Storage only grows: resetting the
+*	histogram for a smaller grid zeroes the needed counters and keeps the rest of the capacity, hence no memory is allocated while
+*	grids do not outgrow the largest one seen so far.
+*/
+class LabelHistogram
+{
+protected:
+	const static size_t						RESET_CHUNK_SIZE;	//!< Number of counters zeroed by each CPU task
+
+protected:
+	std::unique_ptr<std::atomic<unsigned>[]> _count;			//!< Votes of each label of each voxel
+	size_t									_capacity;			//!< Number of allocated counters
+	size_t									_size;				//!< Number of counters in use
+	MemoryTracker::Allocation				_memory;			//!< Bytes of _count reported to the memory tracker
+
+public:
+	/**
+	*	@brief Constructor of an empty histogram.
+	*/
+	LabelHistogram();
+
+	/**
+	*	@brief Invalid copy constructor.
+	*/
+	LabelHistogram(const LabelHistogram& histogram) = delete;
+
+	/**
+	*	@brief Destructor.
+	*/
+	virtual ~LabelHistogram();
+
+	/**
+	*	@return Number of allocated counters.
+	*/
+	size_t capacity() const { return _capacity; }
+
+	/**
+	*	@return Counters in use.
+	*/
+	std::atomic<unsigned>* data() { return _count.get(); }
+
+	/**
+	*	@brief Invalid assignment operator.
+	*/
+	LabelHistogram& operator=(const LabelHistogram& histogram) = delete;
+
+	/**
+	*	@brief Prepares size zeroed counters, growing the storage only if it is not large enough.
+	*/
+	void reset(size_t size);
+
+	/**
+	*	@return Number of counters in use.
+	*/
+	size_t size() const { return _size; }
+};
+
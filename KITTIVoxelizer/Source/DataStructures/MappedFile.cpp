@@ -0,0 +1,76 @@
+#include "stdafx.h"
+#include "MappedFile.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// [Public methods]
+
+MappedFile::MappedFile() : _data(nullptr), _file(-1), _mapping(0), _size(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+	this->close();
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+	if (_data) UnmapViewOfFile(_data);
+	if (_mapping) CloseHandle(reinterpret_cast<HANDLE>(_mapping));
+	if (_file != -1) CloseHandle(reinterpret_cast<HANDLE>(_file));
+#else
+	if (_data) munmap(const_cast<uint8_t*>(_data), _size);
+	if (_file != -1) ::close(int(_file));
+#endif
+
+	_data = nullptr;
+	_file = -1;
+	_mapping = 0;
+	_size = 0;
+}
+
+bool MappedFile::open(const std::string& filename)
+{
+	this->close();
+
+#ifdef _WIN32
+	_file = reinterpret_cast<intptr_t>(CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+	if (_file == -1) return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(reinterpret_cast<HANDLE>(_file), &fileSize)) { this->close(); return false; }
+
+	_size = size_t(fileSize.QuadPart);
+	if (!_size) return true;
+
+	_mapping = reinterpret_cast<intptr_t>(CreateFileMappingA(reinterpret_cast<HANDLE>(_file), nullptr, PAGE_READONLY, 0, 0, nullptr));
+	if (_mapping) _data = static_cast<const uint8_t*>(MapViewOfFile(reinterpret_cast<HANDLE>(_mapping), FILE_MAP_READ, 0, 0, 0));
+#else
+	_file = ::open(filename.c_str(), O_RDONLY);
+	if (_file == -1) return false;
+
+	struct stat fileStat;
+	if (fstat(int(_file), &fileStat)) { this->close(); return false; }
+
+	_size = size_t(fileStat.st_size);
+	if (!_size) return true;
+
+	void* data = mmap(nullptr, _size, PROT_READ, MAP_SHARED, int(_file), 0);
+	if (data != MAP_FAILED) _data = static_cast<const uint8_t*>(data);
+#endif
+
+	if (!_data)
+	{
+		this->close();
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+/**
+*	@file MappedFile.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Read-only memory mapping of a whole file. Pages are loaded by the operating system on first access.
+*/
+class MappedFile
+{
+protected:
+	const uint8_t*	_data;											//!< First byte of the mapped view
+	intptr_t		_file;											//!< Native file descriptor
+	intptr_t		_mapping;										//!< Native mapping object (Windows only)
+	size_t			_size;											//!< Number of mapped bytes
+
+public:
+	/**
+	*	@brief Constructor of an unmapped file.
+	*/
+	MappedFile();
+
+	/**
+	*	@brief Invalid copy constructor.
+	*/
+	MappedFile(const MappedFile& file) = delete;
+
+	/**
+	*	@brief Destructor. Unmaps the file.
+	*/
+	virtual ~MappedFile();
+
+	/**
+	*	@brief Releases the mapping, if any.
+	*/
+	void close();
+
+	/**
+	*	@brief Maps a file, releasing the previous one.
+	*	@return False if the file could not be opened or mapped. Empty files are opened with no data.
+	*/
+	bool open(const std::string& filename);
+
+	/**
+	*	@brief Invalid assignment operator.
+	*/
+	MappedFile& operator=(const MappedFile& file) = delete;
+
+	// Getters
+
+	/**
+	*	@return First byte of the file, null if nothing is mapped.
+	*/
+	const uint8_t* data() const { return _data; }
+
+	/**
+	*	@return Number of mapped bytes.
+	*/
+	size_t size() const { return _size; }
+};
+
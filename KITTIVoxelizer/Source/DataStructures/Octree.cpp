@@ -2,12 +2,15 @@
 #include "Octree.h"
 
 #include "Geometry/3D/Intersections3D.h"
+#include "Utilities/Profiler.h"
 
 /// [Public methods]
 
 Octree::Octree(const uint8_t maxLevel, const uint8_t maxTrianglesNode, Model3D* mesh, const AABB& aabb) :
 	_maxLevel(maxLevel), _maxTrianglesPerNode(maxTrianglesNode), _root(nullptr)
 {
+	PROFILE_ZONE("Octree::build");
+
 	_root = new OctreeNode(0, aabb, this, nullptr);
 
 	// Fill octree with mesh triangles
@@ -307,7 +310,8 @@ void Octree::retrieveAABB(FaceListNode* face, const float tx0, const float ty0,
 /// [Node subclass]
 
 Octree::OctreeNode::OctreeNode(uint8_t level, const AABB& aabb, Octree* root, Octree::OctreeNode* parent) :
-	_level(level), _aabb(aabb), _root(root), _parent(parent), _createdChildren(false)
+	_level(level), _aabb(aabb), _root(root), _parent(parent), _createdChildren(false),
+	_memory(MemoryTracker::OCTREE, sizeof(OctreeNode) + NUM_CHILDREN * (sizeof(OctreeNode*) + sizeof(AABB)))
 {
 	_child.resize(NUM_CHILDREN);
 	for (int i = 0; i < NUM_CHILDREN; ++i)
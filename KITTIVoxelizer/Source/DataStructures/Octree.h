@@ -4,6 +4,7 @@
 #include "Geometry/3D/Ray3D.h"
 #include "Geometry/3D/Triangle3D.h"
 #include "Geometry/3D/TriangleMesh.h"
+#include "Utilities/MemoryTracker.h"
 
 typedef std::list<std::list<Triangle3D*>> FaceListNode;
 
@@ -151,6 +152,7 @@ protected:
 		std::vector<OctreeNode*>			_child;							//!< Nodes which are behind this one
 		bool								_createdChildren;				//!< Child array is initialized from the start but node pointers are null
 		uint8_t								_level;							//!< Tree depth
+		MemoryTracker::Allocation			_memory;						//!< Bytes of the node and its child arrays reported to the memory tracker
 
 	public:
 		/**
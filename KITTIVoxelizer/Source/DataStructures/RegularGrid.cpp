@@ -1,21 +1,31 @@
 #include "stdafx.h"
 #include "RegularGrid.h"
 
+#include "Graphics/Core/ComputeBackend.h"
 #include "Graphics/Core/OpenGLUtilities.h"
 #include "Graphics/Core/ShaderList.h"
 #include "tinyply/tinyply.h"
+#include "Utilities/Profiler.h"
+#include <emmintrin.h>
+
+// Initialization of static attributes
+const unsigned RegularGrid::BRICK_SIZE = 32;
+const uint32_t RegularGrid::COMPRESSED_SIGNATURE = 0x315A5856;		// VXZ1
+const size_t RegularGrid::COMPRESSED_SLAB_SIZE = 1 << 18;
+const size_t RegularGrid::MAX_COMPRESSED_VOXELS = size_t(1) << 31;
+const size_t RegularGrid::QUERY_CHUNK_SIZE = 8192;
 
 /// Public methods
 
 RegularGrid::RegularGrid(const AABB& aabb, uvec3 subdivisions) :
-	_aabb(aabb), _numDivs(subdivisions)
+	_gridMemory(MemoryTracker::VOXEL_GRID), _aabb(aabb), _numDivs(subdivisions)
 {
 	_cellSize = vec3((_aabb.max().x - _aabb.min().x) / float(subdivisions.x), (_aabb.max().y - _aabb.min().y) / float(subdivisions.y), (_aabb.max().z - _aabb.min().z) / float(subdivisions.z));
 
 	this->buildGrid();
 }
 
-RegularGrid::RegularGrid(uvec3 subdivisions) : _numDivs(subdivisions)
+RegularGrid::RegularGrid(uvec3 subdivisions) : _gridMemory(MemoryTracker::VOXEL_GRID), _numDivs(subdivisions), _numBricks(0)
 {
 	
 }
@@ -24,62 +34,193 @@ RegularGrid::~RegularGrid()
 {
 }
 
+void RegularGrid::downsample(const std::vector<PointCloud::PointModel>& points, const AABB& aabb, const uvec3& numDivs, std::vector<PointCloud::PointModel>& representatives)
+{
+	PROFILE_ZONE("RegularGrid::downsample");
+
+	static_assert(offsetof(PointCloud::PointModel, _point) == 0 && sizeof(PointCloud::PointModel) >= sizeof(vec4), "Points must be readable as four floats");
+
+	struct BinnedPoint
+	{
+		uint64_t	_key;											// Cell in the upper half, label in the lower half
+		unsigned	_index;
+	};
+
+	representatives.clear();
+	if (points.empty()) return;
+
+	const size_t numPoints = points.size(), numChunks = (numPoints + QUERY_CHUNK_SIZE - 1) / QUERY_CHUNK_SIZE;
+	std::vector<size_t> chunks(numChunks);
+	std::iota(chunks.begin(), chunks.end(), 0);
+
+	std::vector<BinnedPoint> binned(numPoints);
+
+	{
+		PROFILE_ZONE("bin");
+
+		// Same cell computation as queryLabels, hence representatives fall into the voxel that fill() would assign to their points
+		const vec3 cellSize = (aabb.max() - aabb.min()) / vec3(numDivs);
+		const __m128 minPoint = _mm_setr_ps(aabb.min().x, aabb.min().y, aabb.min().z, .0f);
+		const __m128 invCellSize = _mm_setr_ps(1.0f / cellSize.x, 1.0f / cellSize.y, 1.0f / cellSize.z, .0f);
+		const __m128 maxCell = _mm_setr_ps(float(numDivs.x - 1), float(numDivs.y - 1), float(numDivs.z - 1), .0f);
+		const unsigned strideX = numDivs.y * numDivs.z, strideY = numDivs.z;
+
+		std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](const size_t chunk)
+		{
+			const size_t firstIndex = chunk * QUERY_CHUNK_SIZE, lastIndex = std::min(firstIndex + QUERY_CHUNK_SIZE, numPoints);
+			alignas(16) int32_t cell[4];
+
+			for (size_t index = firstIndex; index < lastIndex; ++index)
+			{
+				__m128 xyz = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&points[index]._point.x), minPoint), invCellSize);
+				xyz = _mm_min_ps(_mm_max_ps(xyz, _mm_setzero_ps()), maxCell);
+				_mm_store_si128(reinterpret_cast<__m128i*>(cell), _mm_cvttps_epi32(xyz));
+
+				binned[index] = BinnedPoint{ (uint64_t(cell[0] * strideX + cell[1] * strideY + cell[2]) << 32) | points[index]._label, unsigned(index) };
+			}
+		});
+	}
+
+	{
+		PROFILE_ZONE("sort");
+
+		// Points of a voxel become contiguous, and so do points sharing a label within a voxel
+		std::sort(std::execution::par, binned.begin(), binned.end(), [](const BinnedPoint& a, const BinnedPoint& b) { return a._key < b._key; });
+	}
+
+	std::vector<size_t> voxelStart;
+	voxelStart.reserve(numPoints / 8 + 1);
+
+	for (size_t index = 0; index < numPoints; ++index)
+	{
+		if (!index || (binned[index]._key >> 32) != (binned[index - 1]._key >> 32)) voxelStart.push_back(index);
+	}
+
+	voxelStart.push_back(numPoints);
+	representatives.resize(voxelStart.size() - 1);
+
+	{
+		PROFILE_ZONE("reduce");
+
+		const size_t numVoxels = representatives.size(), numVoxelChunks = (numVoxels + QUERY_CHUNK_SIZE - 1) / QUERY_CHUNK_SIZE;
+		chunks.resize(numVoxelChunks);
+		std::iota(chunks.begin(), chunks.end(), 0);
+
+		std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](const size_t chunk)
+		{
+			const size_t firstVoxel = chunk * QUERY_CHUNK_SIZE, lastVoxel = std::min(firstVoxel + QUERY_CHUNK_SIZE, numVoxels);
+
+			for (size_t voxel = firstVoxel; voxel < lastVoxel; ++voxel)
+			{
+				const size_t firstIndex = voxelStart[voxel], lastIndex = voxelStart[voxel + 1];
+				const vec3 origin = points[binned[firstIndex]._index]._point;
+				vec3 offset(.0f);
+				size_t labelStart = firstIndex, maxOccurrence = 0;
+				unsigned maxOccurrLabel = 0;
+
+				// Offsets from a point of the voxel are accumulated instead of positions, which keeps their precision far from the origin.
+				// Labels are sorted within the voxel, hence the longest run is the majority; ties keep the lowest label as in fill()
+				for (size_t index = firstIndex; index < lastIndex; ++index)
+				{
+					offset += points[binned[index]._index]._point - origin;
+
+					if (index + 1 == lastIndex || binned[index + 1]._key != binned[index]._key)
+					{
+						if (index + 1 - labelStart > maxOccurrence)
+						{
+							maxOccurrence = index + 1 - labelStart;
+							maxOccurrLabel = unsigned(binned[index]._key & 0xFFFFFFFF);
+						}
+
+						labelStart = index + 1;
+					}
+				}
+
+				representatives[voxel] = PointCloud::PointModel{ origin + offset / float(lastIndex - firstIndex), maxOccurrLabel };
+			}
+		});
+	}
+}
+
+MemoryTracker::Footprint RegularGrid::estimateFootprint(const uvec3& numDivs, size_t numPoints, unsigned numLabels)
+{
+	const size_t numCells = size_t(numDivs.x) * numDivs.y * numDivs.z;
+	MemoryTracker::Footprint footprint;
+
+	// GPU labels are read back into a new vector before the current one is released, whereas CPU labels are written in place
+	const bool useGPU = ComputeBackend::getSelectedBackend() == ComputeBackend::GPU_BACKEND;
+
+	footprint._bytes[MemoryTracker::VOXEL_GRID] = numCells * sizeof(uint16_t) * (useGPU ? 2 : 1);
+	footprint._bytes[MemoryTracker::POINTS] = numPoints * sizeof(PointCloud::PointModel);
+	footprint._bytes[MemoryTracker::GPU_BUFFERS] = useGPU ? numPoints * sizeof(PointCloud::PointModel) + numCells * sizeof(uint16_t) : 0;
+	footprint._bytes[MemoryTracker::LABEL_HISTOGRAM] = numCells * std::max(numLabels, 1u) * sizeof(unsigned);
+
+	return footprint;
+}
+
 void RegularGrid::exportBinary(const std::string& filename)
 {
+	PROFILE_ZONE("RegularGrid::exportBinary");
+
 	std::string outputfilename = filename + BINARY_EXTENSION;
 
-	std::ofstream out(outputfilename.c_str());
+	std::ofstream out(outputfilename.c_str(), std::ios::out | std::ios::binary);
 	std::vector<uint8_t> packed = this->pack(_grid);
 	out.write((const char*)&packed[0], packed.size() * sizeof(uint8_t));
 	out.close();
 }
 
-void RegularGrid::fill(PointCloud* pointCloud)
+bool RegularGrid::exportCompressed(const std::string& filename)
 {
-	ComputeShader* resetShader = ShaderList::getInstance()->getComputeShader(RendEnum::RESET_LABEL_INDEX);
-	ComputeShader* boundaryShader = ShaderList::getInstance()->getComputeShader(RendEnum::BUILD_REGULAR_GRID);
-	ComputeShader* selectLabelShader = ShaderList::getInstance()->getComputeShader(RendEnum::SELECT_LABEL_GRID);
+	PROFILE_ZONE("RegularGrid::exportCompressed");
 
-	// Input data
-	uvec3 numDivs		= this->getNumSubdivisions();
-	unsigned numCells	= numDivs.x * numDivs.y * numDivs.z;
-	unsigned numThreads = pointCloud->getNumberOfPoints();
-	unsigned numLabels	= pointCloud->getMaxLabel() + 1;
-	unsigned numGroups1	= ComputeShader::getNumGroups(numThreads);
-	unsigned numGroups2 = ComputeShader::getNumGroups(numCells);
-	unsigned numGroups3 = ComputeShader::getNumGroups(numCells * numLabels);
+	const size_t numSlabs = (_grid.size() + COMPRESSED_SLAB_SIZE - 1) / COMPRESSED_SLAB_SIZE;
+	std::vector<std::vector<unsigned char>> slab(numSlabs);
+	std::vector<size_t> slabIdx(numSlabs);
+	std::vector<uint32_t> slabSize(numSlabs);
+	std::atomic<bool> success(true);
 
-	// Input data
-	const GLuint vertexSSBO = ComputeShader::setReadBuffer(*pointCloud->getPoints(), GL_STATIC_DRAW);
-	const GLuint gridSSBO	= ComputeShader::setReadBuffer(&_grid[0], numCells, GL_DYNAMIC_DRAW);
-	const GLuint labelSSBO = ComputeShader::setWriteBuffer(unsigned(), numCells * numLabels, GL_DYNAMIC_DRAW);
-
-	// 1. Init to zero the label buffer
-	resetShader->bindBuffers(std::vector<GLuint>{ labelSSBO });
-	resetShader->use();
-	resetShader->setUniform("numLabels", GLuint(numCells * numLabels));
-	resetShader->execute(numGroups3, 1, 1, ComputeShader::getMaxGroupSize(), 1, 1);
-
-	boundaryShader->bindBuffers(std::vector<GLuint>{ vertexSSBO, gridSSBO, labelSSBO });
-	boundaryShader->use();
-	boundaryShader->setUniform("aabbMin", _aabb.min());
-	boundaryShader->setUniform("cellSize", _cellSize);
-	boundaryShader->setUniform("gridDims", numDivs);
-	boundaryShader->setUniform("numLabels", numLabels);
-	boundaryShader->setUniform("numPoints", numThreads);
-	boundaryShader->execute(numGroups1, 1, 1, ComputeShader::getMaxGroupSize(), 1, 1);
-
-	selectLabelShader->bindBuffers(std::vector<GLuint>{ gridSSBO, labelSSBO });
-	selectLabelShader->use();
-	selectLabelShader->setUniform("numLabels", numLabels);
-	selectLabelShader->setUniform("numCells", numCells);
-	selectLabelShader->execute(numGroups2, 1, 1, ComputeShader::getMaxGroupSize(), 1, 1);
-
-	uint16_t* gridData = ComputeShader::readData(gridSSBO, uint16_t());
-	_grid = std::vector<uint16_t>(gridData, gridData + numCells);
-
-	GLuint buffers[] = { vertexSSBO, gridSSBO, labelSSBO };
-	glDeleteBuffers(sizeof(buffers) / sizeof(GLuint), buffers);
+	std::iota(slabIdx.begin(), slabIdx.end(), 0);
+	std::for_each(std::execution::par, slabIdx.begin(), slabIdx.end(), [&](const size_t idx)
+	{
+		const size_t firstVoxel = idx * COMPRESSED_SLAB_SIZE, numVoxels = std::min(COMPRESSED_SLAB_SIZE, _grid.size() - firstVoxel);
+
+		if (lodepng::compress(slab[idx], reinterpret_cast<const unsigned char*>(_grid.data() + firstVoxel), numVoxels * sizeof(uint16_t))) success = false;
+		slabSize[idx] = uint32_t(slab[idx].size());
+	});
+
+	if (!success) return false;
+
+	std::ofstream out(filename + COMPRESSED_GRID_EXTENSION, std::ios::out | std::ios::binary);
+	if (!out.is_open()) return false;
+
+	const uint32_t numDivs[3] = { _numDivs.x, _numDivs.y, _numDivs.z }, slabVoxels = uint32_t(COMPRESSED_SLAB_SIZE), numSlabs32 = uint32_t(numSlabs);
+	const vec3 aabbMin = _aabb.min(), aabbMax = _aabb.max();
+
+	out.write((const char*)&COMPRESSED_SIGNATURE, sizeof(uint32_t));
+	out.write((const char*)numDivs, sizeof(numDivs));
+	out.write((const char*)&aabbMin, sizeof(vec3));
+	out.write((const char*)&aabbMax, sizeof(vec3));
+	out.write((const char*)&slabVoxels, sizeof(uint32_t));
+	out.write((const char*)&numSlabs32, sizeof(uint32_t));
+	out.write((const char*)slabSize.data(), slabSize.size() * sizeof(uint32_t));
+
+	for (const std::vector<unsigned char>& payload : slab)
+		out.write((const char*)payload.data(), payload.size());
+
+	out.close();
+
+	return !out.fail();
+}
+
+void RegularGrid::fill(PointCloud* pointCloud, LabelHistogram* histogram)
+{
+	PROFILE_ZONE("RegularGrid::fill");
+
+	ComputeBackend::getInstance()->voxelize(*pointCloud->getPoints(), _aabb.min(), _cellSize, _numDivs, pointCloud->getMaxLabel() + 1, _grid, histogram);
+	_gridMemory.resize(_grid.capacity() * sizeof(uint16_t));
+
+	this->markDirty();
 }
 
 void RegularGrid::getAABBs(std::vector<AABB>& aabb)
@@ -104,11 +245,123 @@ void RegularGrid::getAABBs(std::vector<AABB>& aabb)
 	}
 }
 
+void RegularGrid::getDirtyBricks(std::vector<unsigned>& bricks) const
+{
+	bricks.clear();
+
+	for (unsigned brickIdx = 0; brickIdx < _dirtyBrick.size(); ++brickIdx)
+	{
+		if (_dirtyBrick[brickIdx]) bricks.push_back(brickIdx);
+	}
+}
+
+bool RegularGrid::importCompressed(const std::string& filename)
+{
+	PROFILE_ZONE("RegularGrid::importCompressed");
+
+	std::ifstream in(filename, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!in.is_open()) return false;
+
+	const size_t fileSize = size_t(in.tellg());
+	in.seekg(0);
+
+	uint32_t signature, numDivs[3], slabVoxels, numSlabs;
+	vec3 aabbMin, aabbMax;
+
+	in.read((char*)&signature, sizeof(uint32_t));
+	in.read((char*)numDivs, sizeof(numDivs));
+	in.read((char*)&aabbMin, sizeof(vec3));
+	in.read((char*)&aabbMax, sizeof(vec3));
+	in.read((char*)&slabVoxels, sizeof(uint32_t));
+	in.read((char*)&numSlabs, sizeof(uint32_t));
+
+	if (in.fail() || signature != COMPRESSED_SIGNATURE || !slabVoxels) return false;
+
+	// Header fields are validated before allocating anything from them
+	const size_t numVoxels = size_t(numDivs[0]) * numDivs[1] * numDivs[2];
+	if (numVoxels > MAX_COMPRESSED_VOXELS || numSlabs != (numVoxels + slabVoxels - 1) / slabVoxels) return false;
+
+	size_t remainingSize = fileSize - size_t(in.tellg());
+	if (size_t(numSlabs) * sizeof(uint32_t) > remainingSize) return false;
+
+	std::vector<uint32_t> slabSize(numSlabs);
+	std::vector<size_t> slabOffset(numSlabs + 1, 0);
+
+	in.read((char*)slabSize.data(), slabSize.size() * sizeof(uint32_t));
+	if (in.fail()) return false;
+
+	// Summed as size_t, since the sizes of many slabs may overflow 32 bits
+	std::inclusive_scan(slabSize.begin(), slabSize.end(), slabOffset.begin() + 1, std::plus<size_t>(), size_t(0));
+
+	remainingSize -= slabSize.size() * sizeof(uint32_t);
+	if (slabOffset.back() > remainingSize) return false;
+
+	std::vector<unsigned char> payload(slabOffset.back());
+	in.read((char*)payload.data(), payload.size());
+	if (in.fail()) return false;
+
+	std::vector<uint16_t> grid(numVoxels);
+	std::vector<size_t> slabIdx(numSlabs);
+	std::atomic<bool> success(true);
+
+	std::iota(slabIdx.begin(), slabIdx.end(), 0);
+	std::for_each(std::execution::par, slabIdx.begin(), slabIdx.end(), [&](const size_t idx)
+	{
+		const size_t firstVoxel = idx * slabVoxels, numSlabVoxels = std::min(size_t(slabVoxels), numVoxels - firstVoxel);
+		std::vector<unsigned char> voxels;
+
+		// Streams are not inflated beyond the size of their slab
+		LodePNGDecompressSettings settings = lodepng_default_decompress_settings;
+		settings.max_output_size = numSlabVoxels * sizeof(uint16_t);
+
+		if (lodepng::decompress(voxels, payload.data() + slabOffset[idx], slabSize[idx], settings) || voxels.size() != numSlabVoxels * sizeof(uint16_t))
+		{
+			success = false;
+			return;
+		}
+
+		std::memcpy(grid.data() + firstVoxel, voxels.data(), voxels.size());
+	});
+
+	if (!success) return false;
+
+	_numDivs = uvec3(numDivs[0], numDivs[1], numDivs[2]);
+	_aabb = AABB(aabbMin, aabbMax);
+	_cellSize = (aabbMax - aabbMin) / vec3(_numDivs);
+	_grid = std::move(grid);
+	_gridMemory.resize(_grid.size() * sizeof(uint16_t));
+
+	this->markDirty();
+
+	return true;
+}
+
 void RegularGrid::insertPoint(const vec3& position, unsigned index)
 {
 	uvec3 gridIndex = getPositionIndex(position);
+	uint16_t& voxel = _grid[this->getPositionIndex(gridIndex.x, gridIndex.y, gridIndex.z)];
+
+	if (voxel != uint16_t(index))
+	{
+		voxel = index;
+		_dirtyBrick[this->getBrickIndex(gridIndex.x, gridIndex.y, gridIndex.z)] = 1;
+	}
+}
+
+void RegularGrid::markDirty()
+{
+	_numBricks = (_numDivs + uvec3(BRICK_SIZE - 1)) / uvec3(BRICK_SIZE);
+	_dirtyBrick.assign(size_t(_numBricks.x) * _numBricks.y * _numBricks.z, 1);
+}
+
+void RegularGrid::markDirty(const uvec3& minVoxel, const uvec3& maxVoxel)
+{
+	const uvec3 minBrick = minVoxel / BRICK_SIZE, maxBrick = (glm::min(maxVoxel, _numDivs) + uvec3(BRICK_SIZE - 1)) / BRICK_SIZE;
 
-	_grid[this->getPositionIndex(gridIndex.x, gridIndex.y, gridIndex.z)] = index;
+	for (unsigned x = minBrick.x; x < maxBrick.x; ++x)
+		for (unsigned y = minBrick.y; y < maxBrick.y; ++y)
+			for (unsigned z = minBrick.z; z < maxBrick.z; ++z)
+				_dirtyBrick[this->getPositionIndex(x, y, z, _numBricks)] = 1;
 }
 
 void RegularGrid::queryCluster(const std::vector<Model3D::VertexGPUData>& vertices, const std::vector<Model3D::FaceGPUData>& faces, std::vector<float>& clusterIdx)
@@ -141,6 +394,42 @@ void RegularGrid::queryCluster(const std::vector<Model3D::VertexGPUData>& vertic
 	glDeleteBuffers(sizeof(buffers) / sizeof(GLuint), buffers);
 }
 
+void RegularGrid::queryCluster(PointCloud* pointCloud, std::vector<uint16_t>& labels) const
+{
+	PROFILE_ZONE("RegularGrid::queryCluster");
+
+	static_assert(offsetof(PointCloud::PointModel, _point) == 0 && sizeof(PointCloud::PointModel) >= sizeof(vec4), "Points must be readable as four floats");
+
+	const std::vector<PointCloud::PointModel>* points = pointCloud->getPoints();
+	labels.resize(points->size());
+
+	if (!points->empty())
+	{
+		this->queryLabels(&points->front()._point.x, sizeof(PointCloud::PointModel), points->size(), labels.data());
+	}
+}
+
+void RegularGrid::queryCluster(const std::vector<Model3D::VertexGPUData>& vertices, std::vector<uint16_t>& labels) const
+{
+	static_assert(offsetof(Model3D::VertexGPUData, _position) == 0 && sizeof(Model3D::VertexGPUData) >= sizeof(vec4), "Vertices must be readable as four floats");
+
+	labels.resize(vertices.size());
+
+	if (!vertices.empty())
+	{
+		this->queryLabels(&vertices.front()._position.x, sizeof(Model3D::VertexGPUData), vertices.size(), labels.data());
+	}
+}
+
+void RegularGrid::reset(const AABB& aabb, const uvec3& subdivisions)
+{
+	_aabb = aabb;
+	_numDivs = subdivisions;
+	_cellSize = (_aabb.max() - _aabb.min()) / vec3(_numDivs);
+
+	this->buildGrid();
+}
+
 // [Protected methods]
 
 uint16_t* RegularGrid::data()
@@ -184,15 +473,24 @@ size_t RegularGrid::length() const
 
 void RegularGrid::set(int x, int y, int z, uint8_t i)
 {
-	_grid[this->getPositionIndex(x, y, z)] = i;
+	uint16_t& voxel = _grid[this->getPositionIndex(x, y, z)];
+
+	if (voxel != i)
+	{
+		voxel = i;
+		_dirtyBrick[this->getBrickIndex(x, y, z)] = 1;
+	}
 }
 
 /// Protected methods	
 
 void RegularGrid::buildGrid()
 {	
-	_grid = std::vector<uint16_t>(_numDivs.x * _numDivs.y * _numDivs.z);
-	std::fill(_grid.begin(), _grid.end(), VOXEL_EMPTY);
+	// Capacity is kept, so that grids can be rebuilt without reallocating them
+	_grid.assign(_numDivs.x * _numDivs.y * _numDivs.z, VOXEL_EMPTY);
+	_gridMemory.resize(_grid.capacity() * sizeof(uint16_t));
+
+	this->markDirty();
 }
 
 uvec3 RegularGrid::getPositionIndex(const vec3& position)
@@ -212,3 +510,34 @@ unsigned RegularGrid::getPositionIndex(int x, int y, int z, const uvec3& numDivs
 {
 	return x * numDivs.y * numDivs.z + y * numDivs.z + z;
 }
+
+void RegularGrid::queryLabels(const float* positions, const size_t stride, const size_t numPositions, uint16_t* labels) const
+{
+	const size_t numChunks = (numPositions + QUERY_CHUNK_SIZE - 1) / QUERY_CHUNK_SIZE;
+	std::vector<size_t> chunks(numChunks);
+	std::iota(chunks.begin(), chunks.end(), 0);
+
+	// Same cell computation as the compute shaders: floor((p - min) / cellSize), clamped to the grid
+	const vec3 aabbMin = _aabb.min();
+	const __m128 minPoint = _mm_setr_ps(aabbMin.x, aabbMin.y, aabbMin.z, .0f);
+	const __m128 invCellSize = _mm_setr_ps(1.0f / _cellSize.x, 1.0f / _cellSize.y, 1.0f / _cellSize.z, .0f);
+	const __m128 maxCell = _mm_setr_ps(float(_numDivs.x - 1), float(_numDivs.y - 1), float(_numDivs.z - 1), .0f);
+	const unsigned strideX = _numDivs.y * _numDivs.z, strideY = _numDivs.z;
+
+	std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](const size_t chunk)
+	{
+		const size_t firstIndex = chunk * QUERY_CHUNK_SIZE, lastIndex = std::min(firstIndex + QUERY_CHUNK_SIZE, numPositions);
+		const char* position = reinterpret_cast<const char*>(positions) + firstIndex * stride;
+		alignas(16) int32_t cell[4];
+
+		for (size_t index = firstIndex; index < lastIndex; ++index, position += stride)
+		{
+			// Clamping before truncation equals floor + clamp; NaN values (degenerate axes) fall into the first cell
+			__m128 xyz = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(reinterpret_cast<const float*>(position)), minPoint), invCellSize);
+			xyz = _mm_min_ps(_mm_max_ps(xyz, _mm_setzero_ps()), maxCell);
+			_mm_store_si128(reinterpret_cast<__m128i*>(cell), _mm_cvttps_epi32(xyz));
+
+			labels[index] = _grid[cell[0] * strideX + cell[1] * strideY + cell[2]];
+		}
+	});
+}
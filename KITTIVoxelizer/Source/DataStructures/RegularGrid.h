@@ -1,11 +1,13 @@
 #pragma once
 
+#include "DataStructures/LabelHistogram.h"
 #include "Geometry/3D/AABB.h"
 #include "Graphics/Core/Group3D.h"
 #include "Graphics/Core/Image.h"
 #include "Graphics/Core/Model3D.h"
 #include "Graphics/Core/PointCloud.h"
 #include "Graphics/Core/Texture.h"
+#include "Utilities/MemoryTracker.h"
 
 /**
 *	@file RegularGrid.h
@@ -16,23 +18,43 @@
 #define VOXEL_EMPTY 0
 #define VOXEL_FREE 1
 
+#define COMPRESSED_GRID_EXTENSION ".vxz"
+
 /**
 *	@brief Data structure which helps us to locate models on a terrain.
 */
 class RegularGrid
 {   
+public:
+	const static unsigned	BRICK_SIZE;								//!< Voxels per axis of the bricks whose modifications are tracked
+
+protected:
+	const static uint32_t	COMPRESSED_SIGNATURE;					//!< First bytes of compressed grids
+	const static size_t		COMPRESSED_SLAB_SIZE;					//!< Number of voxels deflated as an independent stream
+	const static size_t		MAX_COMPRESSED_VOXELS;					//!< Largest grid accepted by importCompressed, so that corrupt headers do not trigger huge allocations
+	const static size_t		QUERY_CHUNK_SIZE;						//!< Number of points labelled or binned by each CPU task
+
 protected:
 	std::vector<uint16_t>	_grid;									//!< Color index of regular grid
+	MemoryTracker::Allocation _gridMemory;							//!< Bytes of _grid reported to the memory tracker
 
 	AABB					_aabb;									//!< Bounding box of the scene
 	vec3					_cellSize;								//!< Size of each grid cell
 	uvec3					_numDivs;								//!< Number of subdivisions of space between mininum and maximum point
 
+	std::vector<uint8_t>	_dirtyBrick;							//!< Bricks modified since the last call to clearDirtyBricks
+	uvec3					_numBricks;								//!< Number of bricks per axis
+
 protected:
 	/**
 	*	@brief Builds a 3D grid. 
 	*/
 	void buildGrid();
+
+	/**
+	*	@return Index of the brick which contains a voxel.
+	*/
+	unsigned getBrickIndex(int x, int y, int z) const { return (x / BRICK_SIZE * _numBricks.y + y / BRICK_SIZE) * _numBricks.z + z / BRICK_SIZE; }
 	
 	/**
 	*	@return Index of grid cell to be filled.
@@ -45,10 +67,9 @@ protected:
 	unsigned getPositionIndex(int x, int y, int z) const;
 
 	/**
-	*	@brief Packs the uint16 vector (https://github.com/jbehley/voxelizer/blob/master/src/data/voxelize_utils.cpp).
+	*	@brief Retrieves the label of the voxel where each position is located. Positions are read from a strided array and must be followed by 4 readable bytes.
 	*/
-	template <typename T>
-	std::vector<uint8_t> pack(const std::vector<T>& vec);
+	void queryLabels(const float* positions, const size_t stride, const size_t numPositions, uint16_t* labels) const;
 
 public:	
 	/**
@@ -56,6 +77,24 @@ public:
 	*/
 	static unsigned getPositionIndex(int x, int y, int z, const uvec3& numDivs);
 
+	/**
+	*	@brief Voxel-grid filter: keeps a representative per occupied voxel, located at the centroid of its points and labelled
+	*	with their most frequent label. Points are binned and sorted in parallel, so that only occupied voxels are stored whatever the resolution.
+	*/
+	static void downsample(const std::vector<PointCloud::PointModel>& points, const AABB& aabb, const uvec3& numDivs, std::vector<PointCloud::PointModel>& representatives);
+
+	/**
+	*	@brief Projects the memory needed to voxelize a point cloud with fill(), including the transient GPU buffers and the readback copy,
+	*	so that a resolution can be refused or lowered before anything is allocated. Instance buffers for rendering are not included.
+	*/
+	static MemoryTracker::Footprint estimateFootprint(const uvec3& numDivs, size_t numPoints, unsigned numLabels);
+
+	/**
+	*	@brief Packs the uint16 vector (https://github.com/jbehley/voxelizer/blob/master/src/data/voxelize_utils.cpp).
+	*/
+	template <typename T>
+	static std::vector<uint8_t> pack(const std::vector<T>& vec);
+
 public:
 	/**
 	*	@brief Constructor which specifies the area and the number of divisions of such area.
@@ -77,45 +116,104 @@ public:
     */
     virtual ~RegularGrid();
 
+	/**
+	*	@brief Forgets modifications, once they have been handled by a consumer such as AABBSet.
+	*/
+	void clearDirtyBricks() { std::fill(_dirtyBrick.begin(), _dirtyBrick.end(), 0); }
+
 	/**
 	*	@brief Exports point clouds as binary file following the function in.
 	*/
 	void exportBinary(const std::string& filename);
 
 	/**
-	*	@brief  
+	*	@brief Exports the labels as a deflated file: a header (signature, resolution, AABB and size of each slab) followed by
+	*	independently deflated slabs of voxels, which are compressed in parallel.
+	*	@return Success of writing process.
+	*/
+	bool exportCompressed(const std::string& filename);
+
+	/**
+	*	@brief Labels each voxel with the most frequent label of its points, using the selected compute backend.
+	*	@param histogram Storage for label votes which is reused across grids, if any.
 	*/
-	void fill(PointCloud* pointCloud);
+	void fill(PointCloud* pointCloud, LabelHistogram* histogram = nullptr);
 
 	/**
 	*	@return Bounding box of the regular grid. 
 	*/
-	AABB getAABB() { return _aabb; }
+	AABB getAABB() const { return _aabb; }
+
+	/**
+	*	@return Bytes allocated for labels, which may exceed the current resolution once the grid is reset.
+	*/
+	size_t getAllocatedSize() const { return _gridMemory.size(); }
 
 	/**
 	*	@brief Retrieves grid AABBs for rendering purposes. 
 	*/
 	void getAABBs(std::vector<AABB>& aabb);
 
+	/**
+	*	@brief Retrieves the indices of bricks modified since the last call to clearDirtyBricks, following the axis order of voxels.
+	*/
+	void getDirtyBricks(std::vector<unsigned>& bricks) const;
+
+	/**
+	*	@return Number of bricks per axis.
+	*/
+	uvec3 getNumBricks() const { return _numBricks; }
+
+	/**
+	*	@brief Replaces resolution, AABB and labels with the content of a file written by exportCompressed. Slabs are inflated in parallel.
+	*	@return False if the file could not be read or is corrupted, in which case the grid is not modified.
+	*/
+	bool importCompressed(const std::string& filename);
+
 	/**
 	*	@brief Inserts a new point in the grid.
 	*/
 	void insertPoint(const vec3& position, unsigned index);
 
+	/**
+	*	@brief Flags every brick as modified. Bulk operations such as fill() call it themselves.
+	*/
+	void markDirty();
+
+	/**
+	*	@brief Flags the bricks overlapping the voxels within [minVoxel, maxVoxel) as modified, e.g. after writing them through data().
+	*/
+	void markDirty(const uvec3& minVoxel, const uvec3& maxVoxel);
+
 	/**
 	*	@brief Queries cluster for each triangle of the given mesh.
 	*/
 	void queryCluster(const std::vector<Model3D::VertexGPUData>& vertices, const std::vector<Model3D::FaceGPUData>& faces, std::vector<float>& clusterIdx);
 
+	/**
+	*	@brief Retrieves the voxel label of each point in CPU, i.e. back-projects the grid onto the point cloud.
+	*/
+	void queryCluster(PointCloud* pointCloud, std::vector<uint16_t>& labels) const;
+
+	/**
+	*	@brief Retrieves the voxel label of each vertex in CPU, without requiring an OpenGL context.
+	*/
+	void queryCluster(const std::vector<Model3D::VertexGPUData>& vertices, std::vector<uint16_t>& labels) const;
+
+	/**
+	*	@brief Empties the grid and moves it to a new area and resolution. Labels are only reallocated if the grid has more voxels than ever before.
+	*/
+	void reset(const AABB& aabb, const uvec3& subdivisions);
+
 	/**
 	*	@brief Substitutes current grid with new values. 
 	*/
-	void swap(const std::vector<uint16_t>& newGrid) { if (newGrid.size() == _grid.size()) _grid = std::move(newGrid); }
+	void swap(const std::vector<uint16_t>& newGrid) { if (newGrid.size() == _grid.size()) { _grid = std::move(newGrid); this->markDirty(); } }
 
 	// ----------- External functions ----------
 
     /**
-    *   Get data pointer.
+    *   Get data pointer. Modifications are not tracked, see markDirty.
     *   @return Internal data pointer.
     */
     uint16_t* data();
@@ -174,7 +272,7 @@ public:
     size_t length() const;
 
     /**
-	*   Set voxel at position [x, y, z].
+	*   Set voxel at position [x, y, z]. Its brick is flagged as modified if the color index changes.
 	*   @pre x in range [-1, size.x].
 	*   @pre y in range [-1, size.y].
 	*    @pre z in range [-1, size.z].
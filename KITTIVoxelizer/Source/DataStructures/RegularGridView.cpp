@@ -0,0 +1,37 @@
+#include "stdafx.h"
+#include "RegularGridView.h"
+
+/// [Public methods]
+
+RegularGridView::RegularGridView(const uvec3& subdivisions) : _encoding(NO_ENCODING), _numDivs(subdivisions)
+{
+}
+
+RegularGridView::~RegularGridView()
+{
+}
+
+bool RegularGridView::open(const std::string& filename)
+{
+	const size_t dotPos = filename.find_last_of('.');
+	const std::string extension = dotPos == std::string::npos ? "" : filename.substr(dotPos);
+
+	_encoding = NO_ENCODING;
+	if (!_file.open(filename)) return false;
+
+	// Packed files hold one bit per voxel, as written by RegularGrid::pack
+	if (extension == LABEL_EXTENSION && _file.size() == this->length() * sizeof(uint16_t))
+	{
+		_encoding = LABELS;
+	}
+	else if ((extension == BINARY_EXTENSION || extension == INVALID_EXTENSION) && _file.size() == this->length() / 8)
+	{
+		_encoding = PACKED_OCCUPANCY;
+	}
+	else
+	{
+		_file.close();
+	}
+
+	return _encoding != NO_ENCODING;
+}
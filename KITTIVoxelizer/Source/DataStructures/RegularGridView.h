@@ -0,0 +1,136 @@
+#pragma once
+
+#include "DataStructures/MappedFile.h"
+#include "DataStructures/RegularGrid.h"
+
+/**
+*	@file RegularGridView.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+#define LABEL_EXTENSION ".label"
+#define INVALID_EXTENSION ".invalid"
+
+/**
+*	@brief Read-only view of an exported voxel file, which is memory-mapped instead of copied. Packed occupancy files (.bin, .invalid,
+*	see RegularGrid::exportBinary) are unpacked voxel by voxel on access, whereas .label files are read as one uint16 label per voxel.
+*/
+class RegularGridView
+{
+public:
+	enum Encoding { PACKED_OCCUPANCY, LABELS, NO_ENCODING };
+
+protected:
+	Encoding			_encoding;									//!< Layout of the mapped file
+	MappedFile			_file;										//!< Mapped voxel file
+	uvec3				_numDivs;									//!< Number of voxels per axis, which is not stored in the files
+
+public:
+	/**
+	*	@brief Constructor of an empty view of a grid with the given resolution.
+	*/
+	RegularGridView(const uvec3& subdivisions);
+
+	/**
+	*	@brief Invalid copy constructor.
+	*/
+	RegularGridView(const RegularGridView& view) = delete;
+
+	/**
+	*	@brief Destructor.
+	*/
+	virtual ~RegularGridView();
+
+	/**
+	*	@brief Maps a voxel file, releasing the previous one. The encoding is deduced from the extension.
+	*	@return False if the file could not be mapped or its size does not match the resolution.
+	*/
+	bool open(const std::string& filename);
+
+	/**
+	*	@brief Invalid assignment operator.
+	*/
+	RegularGridView& operator=(const RegularGridView& view) = delete;
+
+	/**
+	*	@return Label of voxel, or VOXEL_FREE / VOXEL_EMPTY for occupancy files.
+	*/
+	uint16_t at(int x, int y, int z) const { return this->at(RegularGrid::getPositionIndex(x, y, z, _numDivs)); }
+
+	/**
+	*	@return Label of voxel given its index in the grid array. Views which are not open are empty.
+	*/
+	uint16_t at(size_t index) const;
+
+	/**
+	*	@return True if the voxel is not empty.
+	*/
+	bool isOccupied(int x, int y, int z) const { return this->isOccupied(RegularGrid::getPositionIndex(x, y, z, _numDivs)); }
+
+	/**
+	*	@return True if the voxel given by its index in the grid array is not empty.
+	*/
+	bool isOccupied(size_t index) const;
+
+	/**
+	*	@return True if the voxel is empty.
+	*/
+	bool isEmpty(int x, int y, int z) const { return !this->isOccupied(x, y, z); }
+
+	/**
+	*	@return Number of voxels.
+	*/
+	size_t length() const { return size_t(_numDivs.x) * _numDivs.y * _numDivs.z; }
+
+	// Getters
+
+	/**
+	*	@return Layout of the mapped file.
+	*/
+	Encoding getEncoding() const { return _encoding; }
+
+	/**
+	*	@return Labels of the mapped .label file, null for other encodings. Data is not aligned, hence it should be copied with memcpy.
+	*/
+	const uint8_t* getLabelData() const { return _encoding == LABELS ? _file.data() : nullptr; }
+
+	/**
+	*	@return Voxel space dimensions.
+	*/
+	uvec3 getNumSubdivisions() const { return _numDivs; }
+
+	/**
+	*	@return Packed occupancy bits (first voxel in the most significant bit), null for other encodings.
+	*/
+	const uint8_t* getPackedData() const { return _encoding == PACKED_OCCUPANCY ? _file.data() : nullptr; }
+};
+
+inline uint16_t RegularGridView::at(size_t index) const
+{
+	if (_encoding == LABELS)
+	{
+		uint16_t label;
+		std::memcpy(&label, _file.data() + index * sizeof(uint16_t), sizeof(uint16_t));
+
+		return label;
+	}
+
+	// Views which are not open hold no voxel
+	if (_encoding != PACKED_OCCUPANCY) return VOXEL_EMPTY;
+
+	return this->isOccupied(index) ? VOXEL_FREE : VOXEL_EMPTY;
+}
+
+inline bool RegularGridView::isOccupied(size_t index) const
+{
+	if (_encoding == PACKED_OCCUPANCY)
+	{
+		return (_file.data()[index >> 3] >> (7 - (index & 7))) & 1;
+	}
+
+	if (_encoding == LABELS) return this->at(index) != VOXEL_EMPTY;
+
+	return false;
+}
+
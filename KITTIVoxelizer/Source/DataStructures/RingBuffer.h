@@ -0,0 +1,144 @@
+#pragma once
+
+/**
+*	@file RingBuffer.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Lock-free history of the last values pushed by any number of threads. Once full, the oldest value is overwritten.
+*	Readers never block writers: a value read while it is being replaced is either the old or the new one, which suffices
+*	for monitoring purposes. T must be lock-free as an atomic, e.g. float.
+*/
+template<typename T>
+class RingBuffer
+{
+protected:
+	size_t									_capacity;				//!< Maximum number of stored values
+	std::atomic<size_t>						_head;					//!< Number of values pushed so far
+	std::unique_ptr<std::atomic<T>[]>		_value;					//!< Circular storage
+
+public:
+	/**
+	*	@brief Constructor of an empty buffer with a fixed capacity (at least one value).
+	*/
+	RingBuffer(size_t capacity);
+
+	/**
+	*	@brief Invalid copy constructor.
+	*/
+	RingBuffer(const RingBuffer& ringBuffer) = delete;
+
+	/**
+	*	@brief Destructor.
+	*/
+	virtual ~RingBuffer();
+
+	/**
+	*	@return Latest value, or T() if nothing was pushed.
+	*/
+	T back() const;
+
+	/**
+	*	@brief Discards every value. Must not be called while other threads are pushing.
+	*/
+	void clear();
+
+	/**
+	*	@return Maximum value among the stored ones, or T() if nothing was pushed.
+	*/
+	T max() const;
+
+	/**
+	*	@return Mean of the stored values, or T() if nothing was pushed.
+	*/
+	T mean() const;
+
+	/**
+	*	@brief Invalid assignment operator.
+	*/
+	RingBuffer& operator=(const RingBuffer& ringBuffer) = delete;
+
+	/**
+	*	@return Stored value at index, from the oldest (0) to the latest (size() - 1).
+	*/
+	T operator[](size_t index) const;
+
+	/**
+	*	@brief Appends a value, overwriting the oldest one if the buffer is full.
+	*/
+	void push(T value);
+
+	/**
+	*	@return Number of stored values.
+	*/
+	size_t size() const { return std::min(_head.load(std::memory_order_acquire), _capacity); }
+};
+
+template<typename T>
+inline RingBuffer<T>::RingBuffer(size_t capacity) : _capacity(std::max(capacity, size_t(1))), _head(0), _value(new std::atomic<T>[_capacity])
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Ring buffers only store trivially copyable values");
+
+	for (size_t idx = 0; idx < _capacity; ++idx) _value[idx].store(T(), std::memory_order_relaxed);
+}
+
+template<typename T>
+inline RingBuffer<T>::~RingBuffer()
+{
+}
+
+template<typename T>
+inline T RingBuffer<T>::back() const
+{
+	const size_t head = _head.load(std::memory_order_acquire);
+
+	return head ? _value[(head - 1) % _capacity].load(std::memory_order_relaxed) : T();
+}
+
+template<typename T>
+inline void RingBuffer<T>::clear()
+{
+	_head.store(0, std::memory_order_release);
+}
+
+template<typename T>
+inline T RingBuffer<T>::max() const
+{
+	const size_t numValues = this->size();
+	T maxValue = numValues ? (*this)[0] : T();
+
+	for (size_t idx = 1; idx < numValues; ++idx) maxValue = std::max(maxValue, (*this)[idx]);
+
+	return maxValue;
+}
+
+template<typename T>
+inline T RingBuffer<T>::mean() const
+{
+	const size_t numValues = this->size();
+	T sum = T();
+
+	for (size_t idx = 0; idx < numValues; ++idx) sum += (*this)[idx];
+
+	return numValues ? sum / T(numValues) : T();
+}
+
+template<typename T>
+inline T RingBuffer<T>::operator[](size_t index) const
+{
+	const size_t head = _head.load(std::memory_order_acquire), numValues = std::min(head, _capacity);
+
+	return _value[(head - numValues + index) % _capacity].load(std::memory_order_relaxed);
+}
+
+template<typename T>
+inline void RingBuffer<T>::push(T value)
+{
+	// Slots are claimed before being written, hence concurrent producers never write the same slot unless the buffer wraps around.
+	// Until the value is stored, readers see the one it replaces
+	const size_t slot = _head.fetch_add(1, std::memory_order_acq_rel) % _capacity;
+	_value[slot].store(value, std::memory_order_relaxed);
+}
+
@@ -0,0 +1,89 @@
+#include "stdafx.h"
+#include "SlotAllocator.h"
+
+/// [Public methods]
+
+SlotAllocator::SlotAllocator() : _numFreeSlots(0), _size(0)
+{
+}
+
+SlotAllocator::~SlotAllocator()
+{
+}
+
+unsigned SlotAllocator::allocate(unsigned numSlots)
+{
+	const auto range = _freeBySize.lower_bound(std::make_pair(numSlots, 0u));
+
+	// Free ranges never reach the end of the array, hence the array grows if none of them is large enough
+	if (range == _freeBySize.end())
+	{
+		const unsigned firstSlot = _size;
+		_size += numSlots;
+
+		return firstSlot;
+	}
+
+	const unsigned firstSlot = range->second, rangeSize = range->first;
+	this->eraseFree(_freeBySlot.find(firstSlot));
+
+	if (rangeSize > numSlots) this->insertFree(firstSlot + numSlots, rangeSize - numSlots);
+
+	return firstSlot;
+}
+
+void SlotAllocator::clear()
+{
+	_freeBySlot.clear();
+	_freeBySize.clear();
+	_numFreeSlots = 0;
+	_size = 0;
+}
+
+void SlotAllocator::release(unsigned firstSlot, unsigned numSlots)
+{
+	if (!numSlots) return;
+
+	// Merging with free neighbours
+	auto next = _freeBySlot.lower_bound(firstSlot);
+
+	if (next != _freeBySlot.end() && firstSlot + numSlots == next->first)
+	{
+		numSlots += next->second;
+		this->eraseFree(next);
+		next = _freeBySlot.lower_bound(firstSlot);
+	}
+
+	if (next != _freeBySlot.begin())
+	{
+		const auto previous = std::prev(next);
+
+		if (previous->first + previous->second == firstSlot)
+		{
+			firstSlot = previous->first;
+			numSlots += previous->second;
+			this->eraseFree(previous);
+		}
+	}
+
+	if (firstSlot + numSlots == _size)
+		_size = firstSlot;
+	else
+		this->insertFree(firstSlot, numSlots);
+}
+
+/// [Protected methods]
+
+void SlotAllocator::eraseFree(std::map<unsigned, unsigned>::iterator range)
+{
+	_freeBySize.erase(std::make_pair(range->second, range->first));
+	_numFreeSlots -= range->second;
+	_freeBySlot.erase(range);
+}
+
+void SlotAllocator::insertFree(unsigned firstSlot, unsigned numSlots)
+{
+	_freeBySlot[firstSlot] = numSlots;
+	_freeBySize.insert(std::make_pair(numSlots, firstSlot));
+	_numFreeSlots += numSlots;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+/**
+*	@file SlotAllocator.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 19/10/2026
+*/
+
+/**
+*	@brief Allocator of contiguous ranges of slots within a growable array, such as an instance buffer. Released ranges are kept
+*	in a free list, merged with their free neighbours, and reused by later allocations (best fit); the array only grows when no
+*	free range is large enough. Hence, allocated ranges never move, and their content does not need to be written again.
+*/
+class SlotAllocator
+{
+protected:
+	std::map<unsigned, unsigned>					_freeBySlot;		//!< Size of free ranges, indexed by their first slot
+	std::set<std::pair<unsigned, unsigned>>			_freeBySize;		//!< Free ranges sorted by size and first slot
+	unsigned										_numFreeSlots;		//!< Slots within free ranges
+	unsigned										_size;				//!< Slots below the last allocated range, free or not
+
+protected:
+	/**
+	*	@brief Inserts a range in the free list, assuming its neighbours are not free.
+	*/
+	void insertFree(unsigned firstSlot, unsigned numSlots);
+
+	/**
+	*	@brief Removes a range from the free list.
+	*/
+	void eraseFree(std::map<unsigned, unsigned>::iterator range);
+
+public:
+	/**
+	*	@brief Constructor of an empty allocator.
+	*/
+	SlotAllocator();
+
+	/**
+	*	@brief Destructor.
+	*/
+	virtual ~SlotAllocator();
+
+	/**
+	*	@brief Reserves numSlots contiguous slots, from the smallest free range which fits them or from the end of the array.
+	*	@return First reserved slot.
+	*/
+	unsigned allocate(unsigned numSlots);
+
+	/**
+	*	@brief Releases every range.
+	*/
+	void clear();
+
+	/**
+	*	@return Number of slots within free ranges, which are not counted once the array shrinks.
+	*/
+	unsigned getNumFreeSlots() const { return _numFreeSlots; }
+
+	/**
+	*	@brief Returns a range reserved by allocate, or a part of it, to the free list.
+	*/
+	void release(unsigned firstSlot, unsigned numSlots);
+
+	/**
+	*	@return Minimum size of the array so that every allocated range fits in it.
+	*/
+	unsigned size() const { return _size; }
+};
+
@@ -0,0 +1,254 @@
+#include "stdafx.h"
+#include "TriangleBVH.h"
+
+#include "Utilities/Profiler.h"
+
+// Initialization of static attributes
+const unsigned TriangleBVH::PACKET_SIZE = sizeof(RayMask) * 8;
+const unsigned TriangleBVH::MAX_LEAF_TRIANGLES = 4;
+const unsigned TriangleBVH::NUM_BINS = 12;
+
+/// [Public methods]
+
+TriangleBVH::TriangleBVH(const std::vector<Triangle>& triangle) : _triangleIdx(triangle.size()), _memory(MemoryTracker::BVH)
+{
+	PROFILE_ZONE("TriangleBVH::build");
+
+	std::vector<vec3> centroid(triangle.size());
+
+	std::iota(_triangleIdx.begin(), _triangleIdx.end(), 0);
+	std::transform(std::execution::par_unseq, triangle.begin(), triangle.end(), centroid.begin(), [](const Triangle& face)
+	{
+		return (face._vertex[0] + face._vertex[1] + face._vertex[2]) / 3.0f;
+	});
+
+	_node.reserve(std::max(triangle.size() * 2, size_t(1)));
+	_node.push_back(Node{ vec3(.0f), 0, vec3(.0f), unsigned(triangle.size()) });
+	_triangle = triangle;
+
+	if (triangle.empty()) return;
+
+	this->updateBounds(_node[0]);
+
+	std::vector<unsigned> pending{ 0 };
+
+	while (!pending.empty())
+	{
+		const unsigned nodeIdx = pending.back();
+		pending.pop_back();
+
+		Node node = _node[nodeIdx];
+		if (node._count <= MAX_LEAF_TRIANGLES) continue;
+
+		// Binned SAH over centroid bounds
+		vec3 centroidMin(FLT_MAX), centroidMax(-FLT_MAX);
+		for (unsigned idx = node._leftFirst; idx < node._leftFirst + node._count; ++idx)
+		{
+			centroidMin = glm::min(centroidMin, centroid[idx]);
+			centroidMax = glm::max(centroidMax, centroid[idx]);
+		}
+
+		float bestCost = FLT_MAX, bestSplit = .0f;
+		int bestAxis = -1;
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const float extent = centroidMax[axis] - centroidMin[axis];
+			if (extent <= .0f) continue;
+
+			struct Bin { vec3 _min = vec3(FLT_MAX), _max = vec3(-FLT_MAX); unsigned _count = 0; };
+			std::vector<Bin> bin(NUM_BINS);
+			const float scale = NUM_BINS / extent;
+
+			for (unsigned idx = node._leftFirst; idx < node._leftFirst + node._count; ++idx)
+			{
+				Bin& currentBin = bin[std::min(unsigned((centroid[idx][axis] - centroidMin[axis]) * scale), NUM_BINS - 1)];
+				++currentBin._count;
+
+				for (const vec3& vertex : _triangle[idx]._vertex)
+				{
+					currentBin._min = glm::min(currentBin._min, vertex);
+					currentBin._max = glm::max(currentBin._max, vertex);
+				}
+			}
+
+			// Surface areas and counts at the left and right of each plane
+			std::vector<float> leftArea(NUM_BINS - 1), rightArea(NUM_BINS - 1);
+			std::vector<unsigned> leftCount(NUM_BINS - 1), rightCount(NUM_BINS - 1);
+			vec3 leftMin(FLT_MAX), leftMax(-FLT_MAX), rightMin(FLT_MAX), rightMax(-FLT_MAX);
+			unsigned leftSum = 0, rightSum = 0;
+
+			for (unsigned binIdx = 0; binIdx < NUM_BINS - 1; ++binIdx)
+			{
+				leftSum += bin[binIdx]._count;
+				leftMin = glm::min(leftMin, bin[binIdx]._min);
+				leftMax = glm::max(leftMax, bin[binIdx]._max);
+				leftCount[binIdx] = leftSum;
+				leftArea[binIdx] = leftSum ? glm::dot(leftMax - leftMin, vec3((leftMax - leftMin).y, (leftMax - leftMin).z, (leftMax - leftMin).x)) : .0f;
+
+				const unsigned rightBinIdx = NUM_BINS - 1 - binIdx;
+				rightSum += bin[rightBinIdx]._count;
+				rightMin = glm::min(rightMin, bin[rightBinIdx]._min);
+				rightMax = glm::max(rightMax, bin[rightBinIdx]._max);
+				rightCount[rightBinIdx - 1] = rightSum;
+				rightArea[rightBinIdx - 1] = rightSum ? glm::dot(rightMax - rightMin, vec3((rightMax - rightMin).y, (rightMax - rightMin).z, (rightMax - rightMin).x)) : .0f;
+			}
+
+			for (unsigned binIdx = 0; binIdx < NUM_BINS - 1; ++binIdx)
+			{
+				const float cost = leftCount[binIdx] * leftArea[binIdx] + rightCount[binIdx] * rightArea[binIdx];
+
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = centroidMin[axis] + (binIdx + 1) / scale;
+				}
+			}
+		}
+
+		// Splitting must be cheaper than intersecting every triangle of the node
+		const vec3 extent = node._max - node._min;
+		if (bestAxis < 0 || bestCost >= node._count * glm::dot(extent, vec3(extent.y, extent.z, extent.x))) continue;
+
+		int64_t left = node._leftFirst, right = int64_t(node._leftFirst) + node._count - 1;
+		while (left <= right)
+		{
+			if (centroid[left][bestAxis] < bestSplit) ++left;
+			else
+			{
+				std::swap(centroid[left], centroid[right]);
+				std::swap(_triangle[left], _triangle[right]);
+				std::swap(_triangleIdx[left], _triangleIdx[right]);
+				--right;
+			}
+		}
+
+		const unsigned leftCount = unsigned(left - node._leftFirst);
+		if (leftCount == 0 || leftCount == node._count) continue;
+
+		const unsigned childIdx = unsigned(_node.size());
+		_node.push_back(Node{ vec3(.0f), node._leftFirst, vec3(.0f), leftCount });
+		_node.push_back(Node{ vec3(.0f), unsigned(left), vec3(.0f), node._count - leftCount });
+		this->updateBounds(_node[childIdx]);
+		this->updateBounds(_node[childIdx + 1]);
+
+		_node[nodeIdx]._leftFirst = childIdx;
+		_node[nodeIdx]._count = 0;
+
+		pending.push_back(childIdx);
+		pending.push_back(childIdx + 1);
+	}
+
+	_node.shrink_to_fit();
+	_memory.resize(_node.capacity() * sizeof(Node) + _triangle.capacity() * sizeof(Triangle) + _triangleIdx.capacity() * sizeof(unsigned));
+}
+
+TriangleBVH::~TriangleBVH()
+{
+}
+
+void TriangleBVH::intersect(const vec3& origin, const vec3* direction, unsigned numRays, float maxDistance, Hit* hit) const
+{
+	numRays = std::min(numRays, PACKET_SIZE);
+
+	vec3 invDirection[sizeof(RayMask) * 8];
+	for (unsigned rayIdx = 0; rayIdx < numRays; ++rayIdx)
+	{
+		invDirection[rayIdx] = 1.0f / direction[rayIdx];
+		hit[rayIdx] = Hit{ std::numeric_limits<float>::infinity(), UINT_MAX };
+	}
+
+	if (_triangle.empty()) return;
+
+	const RayMask allRays = numRays == PACKET_SIZE ? ~RayMask(0) : (RayMask(1) << numRays) - 1;
+	std::vector<std::pair<unsigned, RayMask>> stack;
+
+	stack.reserve(64);
+	stack.push_back(std::make_pair(0u, allRays));
+
+	while (!stack.empty())
+	{
+		const unsigned nodeIdx = stack.back().first;
+		const RayMask parentMask = stack.back().second;
+		const Node& node = _node[nodeIdx];
+		RayMask mask = 0;
+
+		stack.pop_back();
+
+		// Only rays which reached the parent and hit the box closer than their current hit remain active
+		for (unsigned rayIdx = 0; rayIdx < numRays; ++rayIdx)
+		{
+			if (!((parentMask >> rayIdx) & 1)) continue;
+
+			const vec3 t0 = (node._min - origin) * invDirection[rayIdx], t1 = (node._max - origin) * invDirection[rayIdx];
+			const vec3 tMin = glm::min(t0, t1), tMax = glm::max(t0, t1);
+			const float tNear = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, .0f));
+			const float tFar = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, std::min(maxDistance, hit[rayIdx]._distance)));
+
+			if (tNear <= tFar) mask |= RayMask(1) << rayIdx;
+		}
+
+		if (!mask) continue;
+
+		if (node._count)
+		{
+			for (unsigned triangleIdx = node._leftFirst; triangleIdx < node._leftFirst + node._count; ++triangleIdx)
+			{
+				const Triangle& triangle = _triangle[triangleIdx];
+				const vec3 edge1 = triangle._vertex[1] - triangle._vertex[0], edge2 = triangle._vertex[2] - triangle._vertex[0];
+				const vec3 s = origin - triangle._vertex[0], q = glm::cross(s, edge1);
+
+				// Moller-Trumbore, sharing the terms which only depend on the origin
+				for (unsigned rayIdx = 0; rayIdx < numRays; ++rayIdx)
+				{
+					if (!((mask >> rayIdx) & 1)) continue;
+
+					const vec3 p = glm::cross(direction[rayIdx], edge2);
+					const float determinant = glm::dot(edge1, p);
+					if (std::abs(determinant) < FLT_EPSILON) continue;
+
+					const float invDeterminant = 1.0f / determinant;
+					const float u = glm::dot(s, p) * invDeterminant;
+					if (u < .0f || u > 1.0f) continue;
+
+					const float v = glm::dot(direction[rayIdx], q) * invDeterminant;
+					if (v < .0f || u + v > 1.0f) continue;
+
+					const float t = glm::dot(edge2, q) * invDeterminant;
+					if (t > FLT_EPSILON && t <= maxDistance && t < hit[rayIdx]._distance) hit[rayIdx] = Hit{ t, _triangleIdx[triangleIdx] };
+				}
+			}
+		}
+		else
+		{
+			// The child closer to the first active ray is visited first
+			unsigned firstRay = 0;
+			while (!((mask >> firstRay) & 1)) ++firstRay;
+
+			const vec3 leftCenter = (_node[node._leftFirst]._min + _node[node._leftFirst]._max) * .5f;
+			const vec3 rightCenter = (_node[node._leftFirst + 1]._min + _node[node._leftFirst + 1]._max) * .5f;
+			const bool leftFirst = glm::dot(leftCenter - rightCenter, direction[firstRay]) < .0f;
+
+			stack.push_back(std::make_pair(node._leftFirst + (leftFirst ? 1 : 0), mask));
+			stack.push_back(std::make_pair(node._leftFirst + (leftFirst ? 0 : 1), mask));
+		}
+	}
+}
+
+/// [Protected methods]
+
+void TriangleBVH::updateBounds(Node& node)
+{
+	node._min = vec3(FLT_MAX);
+	node._max = vec3(-FLT_MAX);
+
+	for (unsigned idx = node._leftFirst; idx < node._leftFirst + node._count; ++idx)
+	{
+		for (const vec3& vertex : _triangle[idx]._vertex)
+		{
+			node._min = glm::min(node._min, vertex);
+			node._max = glm::max(node._max, vertex);
+		}
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Utilities/MemoryTracker.h"
+
+/**
+*	@file TriangleBVH.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Bounding volume hierarchy of triangles built on CPU with binned SAH. Rays are traversed in packets sharing their origin,
+*	as the beams of a LiDAR do, so that a node is only fetched once per packet.
+*/
+class TriangleBVH
+{
+public:
+	const static unsigned	PACKET_SIZE;							//!< Maximum number of rays traversed at once
+
+	struct Triangle
+	{
+		vec3		_vertex[3];										//!< Corners in world space
+	};
+
+	struct Hit
+	{
+		float		_distance;										//!< Parametric value along the normalized direction, infinity if there is no hit
+		unsigned	_triangle;										//!< Index of the hit triangle in construction order
+	};
+
+protected:
+	typedef uint64_t		RayMask;								//!< One bit per ray of a packet
+
+	const static unsigned	MAX_LEAF_TRIANGLES;						//!< Nodes with fewer triangles are not split
+	const static unsigned	NUM_BINS;								//!< Candidate planes per axis
+
+	struct Node
+	{
+		vec3		_min;											//!< Bounding box of the node
+		unsigned	_leftFirst;										//!< Left child for inner nodes, first triangle for leaves
+		vec3		_max;
+		unsigned	_count;											//!< Number of triangles for leaves, zero for inner nodes
+	};
+
+protected:
+	std::vector<Node>		_node;									//!< Root is located at index 0, and siblings are consecutive
+	std::vector<Triangle>	_triangle;								//!< Triangles sorted by leaf
+	std::vector<unsigned>	_triangleIdx;							//!< Original index of each sorted triangle
+	MemoryTracker::Allocation _memory;								//!< Bytes of the hierarchy reported to the memory tracker
+
+protected:
+	/**
+	*	@brief Fits the bounding box of a node to its triangles.
+	*/
+	void updateBounds(Node& node);
+
+public:
+	/**
+	*	@brief Constructor. The hierarchy is built at once.
+	*/
+	TriangleBVH(const std::vector<Triangle>& triangle);
+
+	/**
+	*	@brief Destructor.
+	*/
+	virtual ~TriangleBVH();
+
+	/**
+	*	@brief Closest hit of each ray in the packet, within (0, maxDistance].
+	*	@param direction Normalized directions of numRays <= PACKET_SIZE rays.
+	*/
+	void intersect(const vec3& origin, const vec3* direction, unsigned numRays, float maxDistance, Hit* hit) const;
+
+	// Getters
+
+	/**
+	*	@return Number of nodes of the hierarchy.
+	*/
+	size_t getNumNodes() const { return _node.size(); }
+
+	/**
+	*	@return Number of triangles of the hierarchy.
+	*/
+	size_t getNumTriangles() const { return _triangle.size(); }
+};
+
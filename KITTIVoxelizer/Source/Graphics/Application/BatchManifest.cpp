@@ -0,0 +1,161 @@
+#include "stdafx.h"
+#include "BatchManifest.h"
+
+#include <filesystem>
+
+// Initialization of static attributes
+const std::string BatchManifest::MANIFEST_FILENAME = "manifest.txt";
+
+/// [Public methods]
+
+BatchManifest::BatchManifest(const std::string& filename) : _filename(filename)
+{
+}
+
+BatchManifest::~BatchManifest()
+{
+	_log.close();
+}
+
+bool BatchManifest::isUpToDate(const std::string& inputFilename, const std::string& outputFilename, const uvec3& subdivisions)
+{
+	ScanRecord record;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		auto recordIt = _record.find(inputFilename);
+		if (recordIt == _record.end()) return false;
+
+		record = recordIt->second;
+	}
+
+	uintmax_t inputSize, outputSize;
+	long long inputTime, outputTime;
+	uint64_t outputHash;
+
+	if (record._subdivisions != subdivisions) return false;
+	if (!getFileStamp(inputFilename, inputSize, inputTime) || inputSize != record._inputSize || inputTime != record._inputTime) return false;
+	if (!getFileStamp(outputFilename, outputSize, outputTime) || outputSize != record._outputSize || outputTime != record._outputTime) return false;
+
+	return hashFile(outputFilename, outputSize, outputHash) && outputHash == record._outputHash;
+}
+
+void BatchManifest::load()
+{
+	std::ifstream inputStream(_filename);
+	std::string currentLine, inputFilename;
+	std::stringstream line;
+	ScanRecord record;
+
+	if (inputStream.fail()) return;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	while (std::getline(inputStream, currentLine))
+	{
+		line.clear();
+		line.str(currentLine);
+
+		if (!std::getline(line, inputFilename, '\t')) continue;
+
+		line >> record._inputSize >> record._inputTime >> record._subdivisions.x >> record._subdivisions.y >> record._subdivisions.z >> record._outputSize >> record._outputTime >> std::hex >> record._outputHash >> std::dec;
+
+		if (!line.fail())
+		{
+			_record[inputFilename] = record;
+		}
+	}
+}
+
+bool BatchManifest::record(const std::string& inputFilename, const std::string& outputFilename, const uvec3& subdivisions)
+{
+	ScanRecord record;
+	record._subdivisions = subdivisions;
+
+	if (!getFileStamp(inputFilename, record._inputSize, record._inputTime) || !getFileStamp(outputFilename, record._outputSize, record._outputTime)) return false;
+	if (!hashFile(outputFilename, record._outputSize, record._outputHash)) return false;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	if (!_log.is_open())
+	{
+		_log.open(_filename, std::ios::out | std::ios::app);
+		if (!_log.is_open()) return false;
+	}
+
+	_record[inputFilename] = record;
+
+	// Flushed right away so that an interrupted run keeps every finished scan
+	_log << inputFilename << '\t' << record._inputSize << ' ' << record._inputTime << ' ' << subdivisions.x << ' ' << subdivisions.y << ' ' << subdivisions.z << ' '
+		 << record._outputSize << ' ' << record._outputTime << ' ' << std::hex << record._outputHash << std::dec << std::endl;
+
+	return !_log.fail();
+}
+
+bool BatchManifest::save()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	const std::string tempFilename = _filename + ".tmp";
+	std::ofstream outputStream(tempFilename, std::ios::out | std::ios::trunc);
+
+	if (!outputStream.is_open()) return false;
+
+	for (auto& record : _record)
+	{
+		outputStream << record.first << '\t' << record.second._inputSize << ' ' << record.second._inputTime << ' '
+					 << record.second._subdivisions.x << ' ' << record.second._subdivisions.y << ' ' << record.second._subdivisions.z << ' '
+					 << record.second._outputSize << ' ' << record.second._outputTime << ' ' << std::hex << record.second._outputHash << std::dec << '\n';
+	}
+
+	outputStream.close();
+	if (outputStream.fail()) return false;
+
+	// The previous manifest is only replaced once the new one is complete
+	_log.close();
+
+	std::error_code error;
+	std::filesystem::rename(tempFilename, _filename, error);
+
+	return !error;
+}
+
+/// [Protected methods]
+
+bool BatchManifest::getFileStamp(const std::string& filename, uintmax_t& size, long long& time)
+{
+	std::error_code error;
+
+	size = std::filesystem::file_size(filename, error);
+	if (error) return false;
+
+	time = std::filesystem::last_write_time(filename, error).time_since_epoch().count();
+
+	return !error;
+}
+
+bool BatchManifest::hashFile(const std::string& filename, uintmax_t& size, uint64_t& hash)
+{
+	std::ifstream inputStream(filename, std::ios::in | std::ios::binary);
+	if (!inputStream.is_open()) return false;
+
+	std::vector<char> buffer(1 << 20);
+	hash = 14695981039346656037ull;
+	size = 0;
+
+	while (inputStream)
+	{
+		inputStream.read(buffer.data(), buffer.size());
+		const std::streamsize numBytes = inputStream.gcount();
+
+		for (std::streamsize byteIdx = 0; byteIdx < numBytes; ++byteIdx)
+		{
+			hash = (hash ^ uint8_t(buffer[byteIdx])) * 1099511628211ull;
+		}
+
+		size += numBytes;
+	}
+
+	return true;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+/**
+*	@file BatchManifest.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Record of the scans exported by previous batch runs, so that only new or modified scans are voxelized again.
+*	Records are appended as soon as each scan is exported, hence an interrupted run can be resumed.
+*/
+class BatchManifest
+{
+public:
+	const static std::string MANIFEST_FILENAME;					//!< Default name of the manifest within the output folder
+
+public:
+	struct ScanRecord
+	{
+		uintmax_t	_inputSize;									//!< Size of the input point cloud (bytes)
+		long long	_inputTime;									//!< Last modification of the input point cloud
+		uvec3		_subdivisions;								//!< Grid resolution used to voxelize the scan
+		uintmax_t	_outputSize;								//!< Size of the exported grid (bytes)
+		long long	_outputTime;								//!< Last modification of the exported grid
+		uint64_t	_outputHash;								//!< FNV-1a hash of the exported grid
+	};
+
+protected:
+	std::string										_filename;	//!< Location of the manifest
+	std::ofstream									_log;		//!< Stream where new records are appended
+	std::mutex										_mutex;		//!< Records are added by several writing threads
+	std::unordered_map<std::string, ScanRecord>		_record;	//!< Last record of each input point cloud
+
+protected:
+	/**
+	*	@brief Retrieves size and last modification time of a file.
+	*	@return False if the file does not exist.
+	*/
+	static bool getFileStamp(const std::string& filename, uintmax_t& size, long long& time);
+
+	/**
+	*	@brief Computes the size and FNV-1a hash of a file.
+	*	@return False if the file could not be read.
+	*/
+	static bool hashFile(const std::string& filename, uintmax_t& size, uint64_t& hash);
+
+public:
+	/**
+	*	@brief Constructor of a manifest located at filename. Nothing is read until load() is called.
+	*/
+	BatchManifest(const std::string& filename);
+
+	/**
+	*	@brief Invalid copy constructor.
+	*/
+	BatchManifest(const BatchManifest& manifest) = delete;
+
+	/**
+	*	@brief Destructor.
+	*/
+	virtual ~BatchManifest();
+
+	/**
+	*	@return True if the input has not been modified since it was exported with the same settings and the output is still intact.
+	*/
+	bool isUpToDate(const std::string& inputFilename, const std::string& outputFilename, const uvec3& subdivisions);
+
+	/**
+	*	@brief Reads previous records. Incomplete lines (interrupted runs) are ignored.
+	*/
+	void load();
+
+	/**
+	*	@brief Invalid assignment operator.
+	*/
+	BatchManifest& operator=(const BatchManifest& manifest) = delete;
+
+	/**
+	*	@brief Registers an exported scan and appends it to the manifest file.
+	*	@return False if either the input or the output could not be read.
+	*/
+	bool record(const std::string& inputFilename, const std::string& outputFilename, const uvec3& subdivisions);
+
+	/**
+	*	@brief Rewrites the manifest with only the last record of each scan.
+	*	@return Success of writing process.
+	*/
+	bool save();
+};
@@ -4,11 +4,13 @@
 #include <filesystem>
 #include <regex>
 #include "Geometry/3D/Triangle3D.h"
+#include "Graphics/Application/PerformanceMonitor.h"
 #include "Graphics/Application/TextureList.h"
 #include "Graphics/Core/CADModel.h"
 #include "Graphics/Core/Light.h"
 #include "Graphics/Core/OpenGLUtilities.h"
 #include "Utilities/ChronoUtilities.h"
+#include "Utilities/Profiler.h"
 
 /// Initialization of static attributes
 const std::string CADScene::SCENE_ROOT_FOLDER = "Assets/Scene/Basement/";
@@ -18,10 +20,11 @@ const std::string CADScene::SCENE_CAMERA_FILE = "Camera.txt";
 const std::string CADScene::SCENE_LIGHTS_FILE = "Lights.txt";
 
 const std::string CADScene::VELODYNE_PATH = "Assets/velodyne/dataset/sequences/00/";
+const std::string CADScene::STATISTICS_FILENAME = "statistics";
 
 // [Public methods]
 
-CADScene::CADScene() : _aabbRenderer(nullptr), _meshGrid(nullptr), _pointCloud(nullptr)
+CADScene::CADScene() : _aabbRenderer(nullptr), _meshGrid(nullptr), _pointCloud(nullptr), _pointCloudLOD(nullptr), _voxelSurface(nullptr)
 {
 }
 
@@ -30,55 +33,84 @@ CADScene::~CADScene()
 	delete _aabbRenderer;
 	delete _meshGrid;
 	delete _pointCloud;
+	delete _pointCloudLOD;
+	delete _voxelSurface;
 }
 
-void CADScene::loadPointClouds(const std::string& directoryFolder, const ivec3& subdivisions)
+void CADScene::computeStatistics(const std::string& directoryFolder, const ivec3& subdivisions)
 {
-	const unsigned rootFolderLength = directoryFolder.length();
-	std::string modelPath = "";
-	std::vector<std::string> pointCloudPath;
+	DatasetStatistics statistics;
+	statistics.compute(this->getPointCloudPaths(directoryFolder), VELODYNE_PATH, uvec3(subdivisions));
 
-	for (auto& assetFile : std::filesystem::recursive_directory_iterator(directoryFolder))
+	if (!statistics.writeCSV(VELODYNE_PATH + STATISTICS_FILENAME + ".csv") || !statistics.writeJSON(VELODYNE_PATH + STATISTICS_FILENAME + ".json"))
 	{
-		if (!assetFile.is_directory() && this->isExtensionReadable(assetFile.path().generic_string()))
-		{
-			modelPath = assetFile.path().generic_string();
-			const size_t extensionDotIndex_01 = modelPath.find_last_of(".");
-			pointCloudPath.push_back(modelPath.substr(0, extensionDotIndex_01));
-		}
+		std::cerr << "Dataset statistics could not be written in " << VELODYNE_PATH << std::endl;
 	}
+}
 
-	for (std::string& path : pointCloudPath)
-	{
-		delete _pointCloud;
-		delete _meshGrid;
-		_pointCloud = nullptr;
-		_meshGrid = nullptr;
+void CADScene::loadPointClouds(const std::string& directoryFolder, const ivec3& subdivisions, const ivec3& downsampleSubdivisions, const VoxelizationPipeline::Settings& settings)
+{
+	PROFILE_ZONE("CADScene::loadPointClouds");
 
-		_pointCloud = new PointCloud(path, true);
-		_pointCloud->load();
+	const std::vector<std::string> pointCloudPath = this->getPointCloudPaths(directoryFolder);
 
-		_meshGrid = new RegularGrid(_pointCloud->getAABB(), subdivisions);
-		_meshGrid->fill(_pointCloud);
+	delete _pointCloud;
+	delete _meshGrid;
+	_pointCloud = nullptr;
+	_meshGrid = nullptr;
 
-		// Export the point cloud into a readable binary file
-		const std::string pclPath = _pointCloud->getFilename();
-		const unsigned barPos = pclPath.find_last_of("/");
-		_meshGrid->exportBinary(VELODYNE_PATH + pclPath.substr(barPos + 1, pclPath.size() - barPos));
-	}
+	// Reading, voxelization and exporting of consecutive point clouds are overlapped
+	VoxelizationPipeline pipeline(settings);
+	pipeline.run(pointCloudPath, VELODYNE_PATH, uvec3(subdivisions), _pointCloud, _meshGrid);
+
+	PerformanceMonitor* performanceMonitor = PerformanceMonitor::getInstance();
+	const VoxelizationPipeline::Timings timings = pipeline.getTimings();
+
+	// Reading and exporting are summed over their threads
+	performanceMonitor->recordStage(PerformanceMonitor::READ_STAGE, timings._read);
+	performanceMonitor->recordStage(PerformanceMonitor::VOXELIZATION_STAGE, timings._voxelization);
+	performanceMonitor->recordStage(PerformanceMonitor::EXPORT_STAGE, timings._export);
 
 	if (_pointCloud && _meshGrid && _pointCloud->getNumberOfPoints())
 	{
-		std::vector<AABB> aabbs;
+		auto startTime = std::chrono::steady_clock::now();
+		_aabbRenderer->update(_meshGrid);
+		performanceMonitor->recordStage(PerformanceMonitor::INSTANCE_UPDATE_STAGE, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count());
 
-		_meshGrid->getAABBs(aabbs);
-		_aabbRenderer->load(aabbs);
-		_aabbRenderer->setColorIndex(_meshGrid->data(), _meshGrid->getNumSubdivisions().x * _meshGrid->getNumSubdivisions().y * _meshGrid->getNumSubdivisions().z);
+		startTime = std::chrono::steady_clock::now();
+		_voxelSurface->extract(_meshGrid);
+		_voxelSurface->load();
+		performanceMonitor->recordStage(PerformanceMonitor::SURFACE_EXTRACTION_STAGE, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+
+		// Voxelization already used every point, hence only the uploaded cloud is reduced
+		if (downsampleSubdivisions.x > 0 && downsampleSubdivisions.y > 0 && downsampleSubdivisions.z > 0)
+		{
+			PointCloud* downsampledCloud = _pointCloud->downsample(uvec3(downsampleSubdivisions));
+			delete _pointCloud;
+			_pointCloud = downsampledCloud;
+		}
+
+		startTime = std::chrono::steady_clock::now();
+		_pointCloudLOD->build(_pointCloud);
+		_pointCloudLOD->load();
+		performanceMonitor->recordStage(PerformanceMonitor::LOD_BUILD_STAGE, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count());
 
 		this->loadDefaultCamera(_cameraManager->getActiveCamera());
 	}
 }
 
+void CADScene::homogenizeGrid()
+{
+	if (!_meshGrid) return;
+
+	// Only instances of bricks whose labels change are uploaded again
+	_meshGrid->homogenize();
+	_aabbRenderer->update(_meshGrid);
+
+	_voxelSurface->extract(_meshGrid);
+	_voxelSurface->load();
+}
+
 void CADScene::rebuildGrid()
 {
 
@@ -101,6 +133,24 @@ void CADScene::render(const mat4& mModel, RenderingParameters* rendParams)
 
 // [Protected methods]
 
+std::vector<std::string> CADScene::getPointCloudPaths(const std::string& directoryFolder)
+{
+	std::string modelPath = "";
+	std::vector<std::string> pointCloudPath;
+
+	for (auto& assetFile : std::filesystem::recursive_directory_iterator(directoryFolder))
+	{
+		if (!assetFile.is_directory() && this->isExtensionReadable(assetFile.path().generic_string()))
+		{
+			modelPath = assetFile.path().generic_string();
+			const size_t extensionDotIndex_01 = modelPath.find_last_of(".");
+			pointCloudPath.push_back(modelPath.substr(0, extensionDotIndex_01));
+		}
+	}
+
+	return pointCloudPath;
+}
+
 bool CADScene::isExtensionReadable(const std::string& filename)
 {
 	return filename.find(PLY_EXTENSION) != std::string::npos;
@@ -200,6 +250,11 @@ void CADScene::loadModels()
 		_aabbRenderer = new AABBSet();
 		_aabbRenderer->load();
 		_aabbRenderer->setMaterial(MaterialList::getInstance()->getMaterial(CGAppEnum::MATERIAL_CAD_BLUE));
+
+		_pointCloudLOD = new PointCloudLOD();
+
+		_voxelSurface = new VoxelSurface();
+		_voxelSurface->setMaterial(MaterialList::getInstance()->getMaterial(CGAppEnum::MATERIAL_CAD_BLUE));
 		
 		this->rebuildGrid();
 	}
@@ -396,6 +451,11 @@ bool CADScene::readLightsFromSettings()
 
 void CADScene::drawSceneAsPoints(RenderingShader* shader, RendEnum::RendShaderTypes shaderType, std::vector<mat4>* matrix, RenderingParameters* rendParams)
 {
+	if (shaderType == RendEnum::POINT_CLOUD_SHADER && _pointCloudLOD)
+	{
+		_pointCloudLOD->selectNodes(_cameraManager->getActiveCamera(), (*matrix)[RendEnum::MODEL_MATRIX], unsigned(std::max(rendParams->_pointBudget, 0)), rendParams->_maxPointSpacing);
+		_pointCloudLOD->drawAsPoints(shader, shaderType, *matrix);
+	}
 }
 
 void CADScene::drawSceneAsLines(RenderingShader* shader, RendEnum::RendShaderTypes shaderType, std::vector<mat4>* matrix, RenderingParameters* rendParams)
@@ -423,10 +483,12 @@ void CADScene::drawSceneAsTriangles(RenderingShader* shader, RendEnum::RendShade
 				group->drawAsTriangles(shader, shaderType, *matrix);
 			}
 		}
+		else if (rendParams->_renderVoxelSurface)
+			_voxelSurface->drawAsTriangles(shader, shaderType, *matrix);
 	}
 	else
 	{
-		if (rendParams->_renderVoxelizedMesh)
+		if (rendParams->_renderVoxelizedMesh && !rendParams->_renderVoxelSurface)
 			_aabbRenderer->drawAsTriangles(shader, shaderType, *matrix);
 	}
 }
@@ -440,10 +502,12 @@ void CADScene::drawSceneAsTriangles4Normal(RenderingShader* shader, RendEnum::Re
 			for (Group3D* group : _sceneGroup)
 				group->drawAsTriangles4Shadows(shader, shaderType, *matrix);
 		}
+		else if (rendParams->_renderVoxelSurface)
+			_voxelSurface->drawAsTriangles4Shadows(shader, shaderType, *matrix);
 	}
 	else
 	{
-		if (rendParams->_renderVoxelizedMesh)
+		if (rendParams->_renderVoxelizedMesh && !rendParams->_renderVoxelSurface)
 			_aabbRenderer->drawAsTriangles4Shadows(shader, shaderType, *matrix);
 	}
 }
@@ -457,10 +521,12 @@ void CADScene::drawSceneAsTriangles4Position(RenderingShader* shader, RendEnum::
 			for (Group3D* group : _sceneGroup)
 				group->drawAsTriangles4Shadows(shader, shaderType, *matrix);
 		}
+		else if (rendParams->_renderVoxelSurface)
+			_voxelSurface->drawAsTriangles4Shadows(shader, shaderType, *matrix);
 	}
 	else
 	{
-		if (rendParams->_renderVoxelizedMesh)
+		if (rendParams->_renderVoxelizedMesh && !rendParams->_renderVoxelSurface)
 			_aabbRenderer->drawAsTriangles4Shadows(shader, shaderType, *matrix);
 	}
 }
\ No newline at end of file
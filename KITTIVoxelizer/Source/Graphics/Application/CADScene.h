@@ -2,9 +2,13 @@
 
 #include "DataStructures/Octree.h"
 #include "DataStructures/RegularGrid.h"
+#include "Graphics/Application/DatasetStatistics.h"
 #include "Graphics/Application/SSAOScene.h"
+#include "Graphics/Application/VoxelizationPipeline.h"
 #include "Graphics/Core/AABBSet.h"
 #include "Graphics/Core/PointCloud.h"
+#include "Graphics/Core/PointCloudLOD.h"
+#include "Graphics/Core/VoxelSurface.h"
 
 #define NEW_LIGHT "!"
 
@@ -48,13 +52,21 @@ protected:
 
 	// Meshes to be tested
 	const static std::string VELODYNE_PATH;					//!< Location of saved point cloud binaries
+	const static std::string STATISTICS_FILENAME;			//!< Name of dataset statistics (CSV and JSON) within VELODYNE_PATH
 
 protected:
 	AABBSet*			_aabbRenderer;						//!< Buffer of voxels
 	RegularGrid*		_meshGrid;							//!<
 	PointCloud*			_pointCloud;						//!<
+	PointCloudLOD*		_pointCloudLOD;						//!< Level-of-detail hierarchy of the last point cloud
+	VoxelSurface*		_voxelSurface;						//!< Boundary of the voxels, as an alternative to the instanced cubes
 
 protected:
+	/**
+	*	@return Paths of readable point clouds within a directory, without extension.
+	*/
+	std::vector<std::string> getPointCloudPaths(const std::string& directoryFolder);
+
 	/**
 	*	@brief True if the file is a known model file, such as obj.
 	*/
@@ -153,10 +165,22 @@ public:
 	*/
 	virtual ~CADScene();
 
+	/**
+	*	@brief Computes class frequencies, occupancy and extents of the point clouds contained in a directory and their exported grids.
+	*/
+	void computeStatistics(const std::string& directoryFolder, const ivec3& subdivisions);
+
 	/**
 	*	@brief Loads all the point clouds contained in a directory.
+	*	@param downsampleSubdivisions Grid which reduces the last point cloud to a point per voxel before it is uploaded, zero to upload every point.
+	*	@param settings Threads and queue depths of the batch voxelization.
+	*/
+	void loadPointClouds(const std::string& directoryFolder, const ivec3& subdivisions, const ivec3& downsampleSubdivisions = ivec3(0), const VoxelizationPipeline::Settings& settings = VoxelizationPipeline::Settings());
+
+	/**
+	*	@brief Labels every occupied voxel of the last grid as VOXEL_FREE, and updates the voxels being rendered.
 	*/
-	void loadPointClouds(const std::string& directoryFolder, const ivec3& subdivisions);
+	void homogenizeGrid();
 
 	/**
 	*	@brief Rebuilds the whole grid to adapt it to a different number of subdivisions. 
@@ -169,5 +193,42 @@ public:
 	*	@param rendParams Rendering parameters to be taken into account.
 	*/
 	virtual void render(const mat4& mModel, RenderingParameters* rendParams);
+
+	// Getters
+
+	/**
+	*	@return Last loaded point cloud, null if no sequence has been loaded.
+	*/
+	PointCloud* getPointCloud() { return _pointCloud; }
+
+	/**
+	*	@return Number of voxels drawn as instances.
+	*/
+	unsigned getNumVoxelInstances() { return _aabbRenderer ? _aabbRenderer->getNumAABBs() : 0; }
+
+	/**
+	*	@return Number of chunks of voxel instances.
+	*/
+	unsigned getNumVoxelChunks() { return _aabbRenderer ? _aabbRenderer->getNumChunks() : 0; }
+
+	/**
+	*	@return Number of chunks of voxel instances which passed the last frustum culling.
+	*/
+	unsigned getNumVisibleVoxelChunks() { return _aabbRenderer ? _aabbRenderer->getNumVisibleChunks() : 0; }
+
+	/**
+	*	@return Number of triangles of the voxel surface.
+	*/
+	unsigned getNumVoxelSurfaceTriangles() { return _voxelSurface ? _voxelSurface->getNumTriangles() : 0; }
+
+	/**
+	*	@return Number of points of the level-of-detail hierarchy.
+	*/
+	unsigned getNumLODPoints() { return _pointCloudLOD ? _pointCloudLOD->getNumPoints() : 0; }
+
+	/**
+	*	@return Number of points of the level-of-detail hierarchy drawn in the last frame.
+	*/
+	unsigned getNumSelectedLODPoints() { return _pointCloudLOD ? _pointCloudLOD->getNumSelectedPoints() : 0; }
 };
 
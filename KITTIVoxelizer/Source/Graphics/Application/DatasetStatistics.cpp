@@ -0,0 +1,193 @@
+#include "stdafx.h"
+#include "DatasetStatistics.h"
+
+#include <filesystem>
+#include "DataStructures/RegularGridView.h"
+#include "Graphics/Core/PointCloud.h"
+
+/// [Public methods]
+
+DatasetStatistics::DatasetStatistics()
+{
+}
+
+DatasetStatistics::~DatasetStatistics()
+{
+}
+
+void DatasetStatistics::compute(const std::vector<std::string>& pointCloudPath, const std::string& gridFolder, const uvec3& subdivisions)
+{
+	_scan = std::vector<ScanStatistics>(pointCloudPath.size());
+	_summary = ScanStatistics();
+
+	for (size_t scanIdx = 0; scanIdx < pointCloudPath.size(); ++scanIdx)
+		_scan[scanIdx]._path = pointCloudPath[scanIdx];
+
+	// Each scan is counted by a single task, so that no histogram is shared among threads
+	std::for_each(std::execution::par, _scan.begin(), _scan.end(), [&](ScanStatistics& statistics)
+	{
+		countPoints(statistics);
+
+		if (!gridFolder.empty())
+		{
+			countVoxels(gridFolder + std::filesystem::path(statistics._path).filename().string(), subdivisions, statistics);
+		}
+	});
+
+	for (const ScanStatistics& statistics : _scan)
+	{
+		if (statistics._numPoints) _summary._aabb.update(statistics._aabb);
+
+		_summary._numPoints += statistics._numPoints;
+		_summary._numVoxels += statistics._numVoxels;
+		_summary._numOccupied += statistics._numOccupied;
+
+		accumulate(_summary._pointLabel, statistics._pointLabel);
+		accumulate(_summary._voxelLabel, statistics._voxelLabel);
+	}
+}
+
+bool DatasetStatistics::writeCSV(const std::string& filename) const
+{
+	std::ofstream out(filename, std::ios::out | std::ios::trunc);
+	if (!out.is_open()) return false;
+
+	const size_t numLabels = std::max(_summary._pointLabel.size(), _summary._voxelLabel.size());
+	const uint64_t numLabelledVoxels = std::accumulate(_summary._voxelLabel.begin(), _summary._voxelLabel.end(), uint64_t(0));
+
+	out << "label,points,point_frequency,voxels,voxel_frequency\n";
+
+	for (size_t label = 0; label < numLabels; ++label)
+	{
+		const uint64_t numPoints = label < _summary._pointLabel.size() ? _summary._pointLabel[label] : 0;
+		const uint64_t numVoxels = label < _summary._voxelLabel.size() ? _summary._voxelLabel[label] : 0;
+
+		out << label << ',' << numPoints << ',' << double(numPoints) / std::max(_summary._numPoints, size_t(1)) << ','
+			<< numVoxels << ',' << double(numVoxels) / std::max(numLabelledVoxels, uint64_t(1)) << '\n';
+	}
+
+	out.close();
+
+	return !out.fail();
+}
+
+bool DatasetStatistics::writeJSON(const std::string& filename) const
+{
+	std::ofstream out(filename, std::ios::out | std::ios::trunc);
+	if (!out.is_open()) return false;
+
+	auto writeArray = [&](const std::vector<uint64_t>& values)
+	{
+		out << '[';
+		for (size_t idx = 0; idx < values.size(); ++idx) out << (idx ? ", " : "") << values[idx];
+		out << ']';
+	};
+
+	auto writeVector = [&](const vec3& value)
+	{
+		out << '[' << value.x << ", " << value.y << ", " << value.z << ']';
+	};
+
+	auto writeStatistics = [&](const ScanStatistics& statistics, const std::string& indent)
+	{
+		std::string path = statistics._path;
+		std::replace(path.begin(), path.end(), '\\', '/');
+
+		out << indent << "\"path\": \"" << path << "\",\n";
+		out << indent << "\"points\": " << statistics._numPoints << ",\n";
+		out << indent << "\"aabb_min\": "; writeVector(statistics._numPoints ? statistics._aabb.min() : vec3(.0f)); out << ",\n";
+		out << indent << "\"aabb_max\": "; writeVector(statistics._numPoints ? statistics._aabb.max() : vec3(.0f)); out << ",\n";
+		out << indent << "\"voxels\": " << statistics._numVoxels << ",\n";
+		out << indent << "\"occupied_voxels\": " << statistics._numOccupied << ",\n";
+		out << indent << "\"occupancy\": " << double(statistics._numOccupied) / std::max(statistics._numVoxels, uint64_t(1)) << ",\n";
+		out << indent << "\"point_labels\": "; writeArray(statistics._pointLabel); out << ",\n";
+		out << indent << "\"voxel_labels\": "; writeArray(statistics._voxelLabel); out << '\n';
+	};
+
+	out << "{\n\t\"scans\": " << _scan.size() << ",\n\t\"summary\": {\n";
+	writeStatistics(_summary, "\t\t");
+	out << "\t},\n\t\"scan\": [\n";
+
+	for (size_t scanIdx = 0; scanIdx < _scan.size(); ++scanIdx)
+	{
+		out << "\t\t{\n";
+		writeStatistics(_scan[scanIdx], "\t\t\t");
+		out << "\t\t}" << (scanIdx + 1 < _scan.size() ? "," : "") << '\n';
+	}
+
+	out << "\t]\n}\n";
+	out.close();
+
+	return !out.fail();
+}
+
+/// [Protected methods]
+
+void DatasetStatistics::accumulate(std::vector<uint64_t>& a, const std::vector<uint64_t>& b)
+{
+	if (a.size() < b.size()) a.resize(b.size(), 0);
+
+	std::transform(b.begin(), b.end(), a.begin(), a.begin(), std::plus<uint64_t>());
+}
+
+void DatasetStatistics::countVoxels(const std::string& gridName, const uvec3& subdivisions, ScanStatistics& statistics)
+{
+	auto countLabel = [&](const uint16_t label)
+	{
+		if (label >= statistics._voxelLabel.size()) statistics._voxelLabel.resize(label + 1, 0);
+		++statistics._voxelLabel[label];
+	};
+
+	RegularGrid grid(subdivisions);
+
+	if (grid.importCompressed(gridName + COMPRESSED_GRID_EXTENSION))
+	{
+		statistics._numVoxels = grid.length();
+		std::for_each(grid.data(), grid.data() + grid.length(), countLabel);
+	}
+	else
+	{
+		RegularGridView view(subdivisions);
+
+		if (!view.open(gridName + LABEL_EXTENSION) && !view.open(gridName + BINARY_EXTENSION)) return;
+
+		statistics._numVoxels = view.length();
+
+		if (view.getEncoding() == RegularGridView::LABELS)
+		{
+			for (size_t voxel = 0; voxel < view.length(); ++voxel) countLabel(view.at(voxel));
+		}
+		else
+		{
+			// Occupancy files hold no labels
+			for (size_t voxel = 0; voxel < view.length(); ++voxel) statistics._numOccupied += view.isOccupied(voxel);
+			return;
+		}
+	}
+
+	statistics._numOccupied = statistics._numVoxels - (statistics._voxelLabel.empty() ? 0 : statistics._voxelLabel[VOXEL_EMPTY]);
+}
+
+void DatasetStatistics::countPoints(ScanStatistics& statistics)
+{
+	PointCloud pointCloud(statistics._path, true);
+
+	try
+	{
+		pointCloud.load();
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Failed to load " << statistics._path << ": " << e.what() << std::endl;
+		return;
+	}
+
+	const std::vector<PointCloud::PointModel>* points = pointCloud.getPoints();
+
+	statistics._numPoints = points->size();
+	statistics._aabb = pointCloud.getAABB();
+	statistics._pointLabel.assign(size_t(pointCloud.getMaxLabel()) + 1, 0);
+
+	for (const PointCloud::PointModel& point : *points)
+		++statistics._pointLabel[std::min(point._label, pointCloud.getMaxLabel())];
+}
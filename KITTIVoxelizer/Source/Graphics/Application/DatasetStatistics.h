@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Geometry/3D/AABB.h"
+
+/**
+*	@file DatasetStatistics.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Class frequencies, occupancy and extents of a whole sequence. Scans are read and counted in parallel, each one
+*	with its own histograms, which are reduced in scan order at the end.
+*/
+class DatasetStatistics
+{
+public:
+	struct ScanStatistics
+	{
+		std::string				_path;								//!< Point cloud path, without extension
+		AABB					_aabb;								//!< Extent of the point cloud (union of extents for the summary)
+		size_t					_numPoints;							//!< Number of points
+		std::vector<uint64_t>	_pointLabel;						//!< Number of points of each label
+		std::vector<uint64_t>	_voxelLabel;						//!< Number of voxels of each label, empty if there is no exported grid with labels
+		uint64_t				_numVoxels;							//!< Number of voxels of the exported grid, zero if it was not found
+		uint64_t				_numOccupied;						//!< Number of non-empty voxels
+
+		/**
+		*	@brief Default constructor.
+		*/
+		ScanStatistics() : _numPoints(0), _numVoxels(0), _numOccupied(0) {}
+	};
+
+protected:
+	std::vector<ScanStatistics>		_scan;							//!< Statistics of each scan
+	ScanStatistics					_summary;						//!< Reduction of every scan
+
+protected:
+	/**
+	*	@brief Adds the histograms of b to a, growing them if needed.
+	*/
+	static void accumulate(std::vector<uint64_t>& a, const std::vector<uint64_t>& b);
+
+	/**
+	*	@brief Counts voxel labels of the grid exported for a scan, looking for .vxz, .label and .bin files, in that order.
+	*/
+	static void countVoxels(const std::string& gridName, const uvec3& subdivisions, ScanStatistics& statistics);
+
+	/**
+	*	@brief Loads a point cloud and counts its labels.
+	*/
+	static void countPoints(ScanStatistics& statistics);
+
+public:
+	/**
+	*	@brief Constructor.
+	*/
+	DatasetStatistics();
+
+	/**
+	*	@brief Destructor.
+	*/
+	virtual ~DatasetStatistics();
+
+	/**
+	*	@brief Computes the statistics of a sequence.
+	*	@param gridFolder Folder of exported grids, named as the point clouds. Voxels are not counted if it is empty.
+	*/
+	void compute(const std::vector<std::string>& pointCloudPath, const std::string& gridFolder, const uvec3& subdivisions);
+
+	/**
+	*	@brief Writes one row per label with point and voxel counts and frequencies.
+	*	@return Success of writing process.
+	*/
+	bool writeCSV(const std::string& filename) const;
+
+	/**
+	*	@brief Writes the summary and the statistics of each scan.
+	*	@return Success of writing process.
+	*/
+	bool writeJSON(const std::string& filename) const;
+
+	// Getters
+
+	/**
+	*	@return Statistics of each scan.
+	*/
+	const std::vector<ScanStatistics>& getScanStatistics() const { return _scan; }
+
+	/**
+	*	@return Statistics of the whole sequence.
+	*/
+	const ScanStatistics& getSummary() const { return _summary; }
+};
+
@@ -0,0 +1,211 @@
+#include "stdafx.h"
+#include "LiDARSimulator.h"
+
+#include <filesystem>
+#include <iomanip>
+#include "Graphics/Core/PointCloudWriter.h"
+#include "Utilities/Profiler.h"
+
+/// [Public methods]
+
+LiDARSimulator::LiDARSimulator(const Settings& settings) : _settings(settings)
+{
+	const unsigned numBeams = unsigned(_settings._beamElevation.size());
+	_direction.resize(size_t(numBeams) * _settings._numAzimuths);
+
+	for (unsigned azimuthIdx = 0; azimuthIdx < _settings._numAzimuths; ++azimuthIdx)
+	{
+		const float azimuth = 2.0f * glm::pi<float>() * azimuthIdx / _settings._numAzimuths;
+
+		for (unsigned beamIdx = 0; beamIdx < numBeams; ++beamIdx)
+		{
+			const float elevation = glm::radians(_settings._beamElevation[beamIdx]);
+			_direction[size_t(azimuthIdx) * numBeams + beamIdx] = vec3(std::cos(elevation) * std::cos(azimuth), std::cos(elevation) * std::sin(azimuth), std::sin(elevation));
+		}
+	}
+}
+
+LiDARSimulator::~LiDARSimulator()
+{
+}
+
+void LiDARSimulator::addModel(CADModel* model, const std::string& classFilename)
+{
+	const std::vector<unsigned> componentLabel = model->getComponentLabels(classFilename);
+
+	for (unsigned modelCompIdx = 0; modelCompIdx < model->getNumModelComponents(); ++modelCompIdx)
+	{
+		Model3D::ModelComponent* modelComp = model->getModelComponent(modelCompIdx);
+
+		for (const Model3D::FaceGPUData& face : modelComp->_topology)
+		{
+			TriangleBVH::Triangle triangle;
+			for (int vertexIdx = 0; vertexIdx < 3; ++vertexIdx) triangle._vertex[vertexIdx] = modelComp->_geometry[face._vertices[vertexIdx]]._position;
+
+			_triangle.push_back(triangle);
+			_triangleLabel.push_back(componentLabel[modelCompIdx]);
+		}
+	}
+}
+
+void LiDARSimulator::build()
+{
+	_bvh.reset(new TriangleBVH(_triangle));
+	std::vector<TriangleBVH::Triangle>().swap(_triangle);
+}
+
+mat4 LiDARSimulator::getPose(const vec3& position, const vec3& forward) const
+{
+	const vec3 up = glm::normalize(_settings._up);
+	vec3 horizontalForward = forward - glm::dot(forward, up) * up;
+
+	// Looking straight up or down, any horizontal direction is valid
+	if (glm::length(horizontalForward) < glm::epsilon<float>())
+		horizontalForward = glm::cross(up, std::abs(up.x) < .9f ? vec3(1.0f, .0f, .0f) : vec3(.0f, .0f, 1.0f));
+
+	horizontalForward = glm::normalize(horizontalForward);
+
+	return mat4(vec4(horizontalForward, .0f), vec4(glm::cross(up, horizontalForward), .0f), vec4(up, .0f), vec4(position, 1.0f));
+}
+
+bool LiDARSimulator::readWaypoints(const std::string& filename, std::vector<vec4>& waypoints)
+{
+	std::ifstream inputStream(filename);
+	if (!inputStream.is_open()) return false;
+
+	std::string currentLine;
+	waypoints.clear();
+
+	while (std::getline(inputStream, currentLine))
+	{
+		std::stringstream line(currentLine);
+		vec3 waypoint;
+
+		if (currentLine.find(COMMENT_CHAR) != 0 && line >> waypoint.x >> waypoint.y >> waypoint.z) waypoints.push_back(vec4(waypoint, 1.0f));
+	}
+
+	return waypoints.size() >= 2;
+}
+
+void LiDARSimulator::simulate(const mat4& pose, std::vector<PointCloud::PointModel>& points) const
+{
+	PROFILE_ZONE("LiDARSimulator::scan");
+
+	points.clear();
+	if (!_bvh) return;
+
+	const mat3 rotation(pose);
+	const vec3 origin(pose[3]);
+	const size_t numPackets = (_direction.size() + TriangleBVH::PACKET_SIZE - 1) / TriangleBVH::PACKET_SIZE;
+	std::vector<PointCloud::PointModel> hitPoint(_direction.size());
+	std::vector<uint8_t> isHit(_direction.size(), 0);
+	std::vector<size_t> packetIdx(numPackets);
+
+	std::iota(packetIdx.begin(), packetIdx.end(), 0);
+	std::for_each(std::execution::par, packetIdx.begin(), packetIdx.end(), [&](const size_t packet)
+	{
+		const size_t firstRay = packet * TriangleBVH::PACKET_SIZE;
+		const unsigned numRays = unsigned(std::min(size_t(TriangleBVH::PACKET_SIZE), _direction.size() - firstRay));
+		std::vector<vec3> direction(numRays);
+		std::vector<TriangleBVH::Hit> hit(numRays);
+
+		for (unsigned rayIdx = 0; rayIdx < numRays; ++rayIdx) direction[rayIdx] = rotation * _direction[firstRay + rayIdx];
+
+		_bvh->intersect(origin, direction.data(), numRays, _settings._maxRange, hit.data());
+
+		for (unsigned rayIdx = 0; rayIdx < numRays; ++rayIdx)
+		{
+			if (hit[rayIdx]._triangle == UINT_MAX || hit[rayIdx]._distance < _settings._minRange) continue;
+
+			hitPoint[firstRay + rayIdx] = PointCloud::PointModel{ _direction[firstRay + rayIdx] * hit[rayIdx]._distance, _triangleLabel[hit[rayIdx]._triangle] };
+			isHit[firstRay + rayIdx] = 1;
+		}
+	});
+
+	// Points keep the firing order
+	points.reserve(std::count(isHit.begin(), isHit.end(), 1));
+
+	for (size_t rayIdx = 0; rayIdx < hitPoint.size(); ++rayIdx)
+		if (isHit[rayIdx]) points.push_back(hitPoint[rayIdx]);
+}
+
+bool LiDARSimulator::simulate(Interpolation* trajectory, unsigned numScans, const std::string& outputFolder)
+{
+	if (!_bvh) this->build();
+
+	std::filesystem::create_directories(outputFolder);
+
+	std::ofstream posesStream(outputFolder + POSES_FILENAME, std::ios::out | std::ios::trunc);
+	if (!posesStream.is_open()) return false;
+
+	const float tStep = 1.0f / std::max(numScans - 1, 1u), tDelta = tStep * .5f;
+	std::vector<std::future<bool>> written;
+	std::vector<PointCloud::PointModel> points;
+	std::string scanPath;
+	bool finished;
+
+	posesStream << std::setprecision(9);
+
+	for (unsigned scanIdx = 0; scanIdx < numScans; ++scanIdx)
+	{
+		const float t = std::min(scanIdx * tStep, 1.0f);
+		const vec3 position = vec3(trajectory->getPosition(t, finished));
+
+		// Heading follows the tangent, estimated by central differences
+		const vec3 previous = vec3(trajectory->getPosition(std::max(t - tDelta, .0f), finished)), next = vec3(trajectory->getPosition(std::min(t + tDelta, 1.0f), finished));
+		const mat4 pose = this->getPose(position, next - previous);
+
+		this->simulate(pose, points);
+
+		std::stringstream filename;
+		filename << outputFolder << std::setw(6) << std::setfill('0') << scanIdx;
+		scanPath = filename.str();
+		written.push_back(PointCloudWriter::getInstance()->write(points, scanPath + PLY_EXTENSION, false));
+
+		for (int row = 0; row < 3; ++row)
+			posesStream << pose[0][row] << ' ' << pose[1][row] << ' ' << pose[2][row] << ' ' << pose[3][row] << (row < 2 ? ' ' : '\n');
+
+		std::cout << "Simulated scan " << scanIdx + 1 << "/" << numScans << " (" << points.size() << " points)" << std::endl;
+	}
+
+	posesStream.close();
+
+	bool success = !posesStream.fail();
+
+	for (std::future<bool>& future : written)
+	{
+		try
+		{
+			success &= future.get();
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << "Failed to write simulated scan: " << e.what() << std::endl;
+			success = false;
+		}
+	}
+
+	// Points of the last scan are still available
+	if (success && numScans && !checkScan(scanPath, points))
+	{
+		std::cerr << "Simulated scan " << scanPath << PLY_EXTENSION << " does not match once read back" << std::endl;
+		success = false;
+	}
+
+	return success;
+}
+
+/// [Protected methods]
+
+bool LiDARSimulator::checkScan(const std::string& path, const std::vector<PointCloud::PointModel>& points)
+{
+	PointCloud pointCloud(path, false);
+	pointCloud.load();
+
+	const std::vector<PointCloud::PointModel>* loadedPoints = pointCloud.getPoints();
+
+	return loadedPoints->size() == points.size() && std::equal(points.begin(), points.end(), loadedPoints->begin(), [](const PointCloud::PointModel& point, const PointCloud::PointModel& loadedPoint)
+	{
+		return point._point == loadedPoint._point && point._label == loadedPoint._label;
+	});
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "DataStructures/TriangleBVH.h"
+#include "Geometry/Animation/Interpolation.h"
+#include "Graphics/Core/CADModel.h"
+#include "Graphics/Core/PointCloud.h"
+
+/**
+*	@file LiDARSimulator.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+#define CLASS_FILE_SUFFIX "_classes.txt"
+#define POSES_FILENAME "poses.txt"
+
+/**
+*	@brief CPU simulation of a rotating multi-beam LiDAR over CAD scenes. Beams of a revolution are grouped into packets of
+*	rays sharing their origin, which are traced in parallel against a BVH of the scene. Points are labelled with the class
+*	of the hit model component, and expressed in the sensor frame (x forward, y left, z up), as in KITTI.
+*/
+class LiDARSimulator
+{
+public:
+	struct Settings
+	{
+		std::vector<float>	_beamElevation;							//!< Elevation of each beam in degrees
+		unsigned			_numAzimuths;							//!< Firings per revolution
+		float				_minRange;								//!< Closer hits are discarded
+		float				_maxRange;								//!< Farther hits are not returned
+		vec3				_up;									//!< Vertical axis of scenes
+
+		/**
+		*	@brief Default constructor. Resembles a Velodyne HDL-64E, i.e. 64 beams within [-24.9, 2.0] degrees.
+		*/
+		Settings() : _numAzimuths(2048), _minRange(.9f), _maxRange(120.0f), _up(.0f, 1.0f, .0f)
+		{
+			const unsigned numBeams = 64;
+
+			for (unsigned beamIdx = 0; beamIdx < numBeams; ++beamIdx)
+				_beamElevation.push_back(-24.9f + 26.9f * beamIdx / (numBeams - 1));
+		}
+	};
+
+protected:
+	std::unique_ptr<TriangleBVH>			_bvh;					//!< Hierarchy of every scene triangle, null until build() is called
+	std::vector<vec3>						_direction;				//!< Ray directions in the sensor frame, ordered by azimuth and then by beam
+	Settings								_settings;				//!< Beam and azimuth pattern
+	std::vector<TriangleBVH::Triangle>		_triangle;				//!< Triangles of added models, released once the BVH is built
+	std::vector<unsigned>					_triangleLabel;			//!< Class of each triangle
+
+protected:
+	/**
+	*	@brief Loads a written scan back through PointCloud, as batch voxelization does, and compares it with the simulated points.
+	*	@param path Scan file, with no extension.
+	*	@return False if the number of points, any position or any label differ.
+	*/
+	static bool checkScan(const std::string& path, const std::vector<PointCloud::PointModel>& points);
+
+public:
+	/**
+	*	@brief Constructor.
+	*/
+	LiDARSimulator(const Settings& settings = Settings());
+
+	/**
+	*	@brief Invalid copy constructor.
+	*/
+	LiDARSimulator(const LiDARSimulator& simulator) = delete;
+
+	/**
+	*	@brief Destructor.
+	*/
+	virtual ~LiDARSimulator();
+
+	/**
+	*	@brief Adds the triangles of a loaded model to the scene. Labels of its components are read from a class file.
+	*/
+	void addModel(CADModel* model, const std::string& classFilename);
+
+	/**
+	*	@brief Builds the hierarchy of added triangles. Must be called before simulating any scan.
+	*/
+	void build();
+
+	/**
+	*	@return Pose of a sensor located at position and looking towards forward, which is projected onto the horizontal plane.
+	*/
+	mat4 getPose(const vec3& position, const vec3& forward) const;
+
+	/**
+	*	@brief Invalid assignment operator.
+	*/
+	LiDARSimulator& operator=(const LiDARSimulator& simulator) = delete;
+
+	/**
+	*	@brief Reads the waypoints of a trajectory, written as a point (x y z) per line.
+	*	@return False if the file could not be opened or there are fewer than two waypoints.
+	*/
+	static bool readWaypoints(const std::string& filename, std::vector<vec4>& waypoints);
+
+	/**
+	*	@brief Simulates a single revolution from a sensor pose.
+	*	@param points Hits expressed in the sensor frame. Rays with no hit within range are dropped.
+	*/
+	void simulate(const mat4& pose, std::vector<PointCloud::PointModel>& points) const;
+
+	/**
+	*	@brief Simulates numScans revolutions evenly spread along a trajectory, heading towards its tangent. Scans are written as
+	*	numbered PLY files and sensor poses are written in KITTI format (a 3x4 row-major matrix per line). The last scan is read back to
+	*	check that written files are readable by PointCloud.
+	*	@return Success of writing process.
+	*/
+	bool simulate(Interpolation* trajectory, unsigned numScans, const std::string& outputFolder);
+};
+
@@ -0,0 +1,118 @@
+#include "stdafx.h"
+#include "PerformanceMonitor.h"
+
+// Initialization of static attributes
+const unsigned PerformanceMonitor::HISTORY_SIZE = 128;
+const unsigned PerformanceMonitor::MAX_INTERVALS = 8;
+const unsigned PerformanceMonitor::NUM_FRAMES_IN_FLIGHT = 3;
+
+const char* PerformanceMonitor::FRAME_PASS_NAME[NUM_FRAME_PASSES] = { "Shadows", "Scene", "SSAO", "Voxel draw" };
+const char* PerformanceMonitor::LOAD_STAGE_NAME[NUM_LOAD_STAGES] = { "Load", "Fill", "Export", "Instance update", "Surface extraction", "LOD hierarchy" };
+
+/// [Public methods]
+
+PerformanceMonitor::ScopedPass::ScopedPass(FramePass pass) : _pass(pass), _interval(-1)
+{
+	PerformanceMonitor* monitor = PerformanceMonitor::getInstance();
+	if (!monitor->_frameOpen) return;
+
+	FrameQueries& frame = monitor->_frame[monitor->_frameIdx];
+	if (frame._numIntervals[pass] >= MAX_INTERVALS) return;
+
+	_interval = int(frame._numIntervals[pass]++);
+	glQueryCounter(frame._query[(pass * MAX_INTERVALS + _interval) * 2], GL_TIMESTAMP);
+}
+
+PerformanceMonitor::ScopedPass::~ScopedPass()
+{
+	if (_interval < 0) return;
+
+	PerformanceMonitor* monitor = PerformanceMonitor::getInstance();
+	if (!monitor->_frameOpen) return;
+
+	FrameQueries& frame = monitor->_frame[monitor->_frameIdx];
+	frame._lastQuery = frame._query[(_pass * MAX_INTERVALS + _interval) * 2 + 1];
+	glQueryCounter(frame._lastQuery, GL_TIMESTAMP);
+}
+
+PerformanceMonitor::~PerformanceMonitor()
+{
+	// Queries are released along with the OpenGL context, which no longer exists when singletons are destroyed
+}
+
+void PerformanceMonitor::beginFrame()
+{
+	_frameOpen = false;
+	if (!_enabled) return;
+
+	if (_frame.empty())
+	{
+		_frame.resize(NUM_FRAMES_IN_FLIGHT);
+
+		for (FrameQueries& frame : _frame)
+		{
+			frame._query.resize(NUM_FRAME_PASSES * MAX_INTERVALS * 2);
+			glGenQueries(GLsizei(frame._query.size()), frame._query.data());
+			frame._pending = false;
+		}
+	}
+
+	// The slot to be reused holds the oldest frame in flight
+	FrameQueries& frame = _frame[_frameIdx];
+	this->collect(frame);
+
+	std::fill(frame._numIntervals, frame._numIntervals + NUM_FRAME_PASSES, 0);
+	frame._lastQuery = 0;
+	_frameOpen = true;
+	_frameStart = std::chrono::steady_clock::now();
+}
+
+void PerformanceMonitor::endFrame()
+{
+	if (!_frameOpen) return;
+
+	_frame[_frameIdx]._pending = _frame[_frameIdx]._lastQuery != 0;
+	_frameTime.push(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - _frameStart).count());
+	_frameIdx = (_frameIdx + 1) % NUM_FRAMES_IN_FLIGHT;
+	_frameOpen = false;
+}
+
+void PerformanceMonitor::recordStage(LoadStage stage, double milliseconds)
+{
+	_stageTime[stage]->push(float(milliseconds));
+}
+
+/// [Protected methods]
+
+PerformanceMonitor::PerformanceMonitor() : _enabled(false), _frameIdx(0), _frameOpen(false), _frameTime(HISTORY_SIZE)
+{
+	for (unsigned pass = 0; pass < NUM_FRAME_PASSES; ++pass) _passTime.emplace_back(new RingBuffer<float>(HISTORY_SIZE));
+	for (unsigned stage = 0; stage < NUM_LOAD_STAGES; ++stage) _stageTime.emplace_back(new RingBuffer<float>(HISTORY_SIZE));
+}
+
+void PerformanceMonitor::collect(FrameQueries& frame)
+{
+	if (!frame._pending) return;
+
+	frame._pending = false;
+
+	GLint available = 0;
+	glGetQueryObjectiv(frame._lastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available) return;
+
+	GLuint64 begin, end;
+
+	for (unsigned pass = 0; pass < NUM_FRAME_PASSES; ++pass)
+	{
+		GLuint64 elapsed = 0;
+
+		for (unsigned interval = 0; interval < frame._numIntervals[pass]; ++interval)
+		{
+			glGetQueryObjectui64v(frame._query[(pass * MAX_INTERVALS + interval) * 2], GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(frame._query[(pass * MAX_INTERVALS + interval) * 2 + 1], GL_QUERY_RESULT, &end);
+			elapsed += end > begin ? end - begin : 0;
+		}
+
+		_passTime[pass]->push(elapsed / 1e6f);
+	}
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "DataStructures/RingBuffer.h"
+#include "Utilities/Singleton.h"
+
+/**
+*	@file PerformanceMonitor.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Rolling timings shown by the performance HUD. Scene passes are measured on GPU with timestamp queries, which are read
+*	NUM_FRAMES_IN_FLIGHT frames later so that the pipeline is never stalled; results which are not yet available are dropped. Stages
+*	of the last voxelization are measured on CPU. Histories are kept in lock-free ring buffers, hence they can be plotted while
+*	being written. Scene passes are not measured while the monitor is disabled.
+*/
+class PerformanceMonitor: public Singleton<PerformanceMonitor>
+{
+	friend class Singleton<PerformanceMonitor>;
+
+public:
+	enum FramePass { SHADOW_PASS, SCENE_PASS, SSAO_PASS, VOXEL_DRAW_PASS, NUM_FRAME_PASSES };
+	enum LoadStage { READ_STAGE, VOXELIZATION_STAGE, EXPORT_STAGE, INSTANCE_UPDATE_STAGE, SURFACE_EXTRACTION_STAGE, LOD_BUILD_STAGE, NUM_LOAD_STAGES };
+
+	/**
+	*	@brief Measures the GPU commands issued during the lifetime of the object as part of a pass.
+	*/
+	class ScopedPass
+	{
+	protected:
+		FramePass	_pass;											//!< Measured pass
+		int			_interval;										//!< Index of the measured interval within the frame, negative if nothing is measured
+
+	public:
+		/**
+		*	@brief Issues the starting timestamp if a frame is being measured.
+		*/
+		ScopedPass(FramePass pass);
+
+		/**
+		*	@brief Issues the ending timestamp.
+		*/
+		~ScopedPass();
+	};
+
+public:
+	const static unsigned		HISTORY_SIZE;						//!< Number of frames and voxelizations kept for plotting
+
+protected:
+	const static unsigned		MAX_INTERVALS;						//!< Measured intervals of a pass per frame, as voxels are drawn in several passes
+	const static unsigned		NUM_FRAMES_IN_FLIGHT;				//!< Frames whose queries may still be pending on GPU
+
+	struct FrameQueries
+	{
+		std::vector<GLuint>		_query;								//!< Begin and end timestamps of every interval of every pass
+		unsigned				_numIntervals[NUM_FRAME_PASSES];	//!< Issued intervals per pass
+		GLuint					_lastQuery;							//!< Latest issued timestamp, whose availability implies the others
+		bool					_pending;							//!< Queries were issued and have not been read yet
+	};
+
+protected:
+	const static char*			FRAME_PASS_NAME[NUM_FRAME_PASSES];	//!< Names shown by the HUD
+	const static char*			LOAD_STAGE_NAME[NUM_LOAD_STAGES];	//!< Names shown by the HUD
+
+	bool						_enabled;							//!< Scene passes are measured from the next frame on
+	std::vector<FrameQueries>	_frame;								//!< Queries of frames in flight, created once enabled
+	unsigned					_frameIdx;							//!< Slot of the current frame
+	bool						_frameOpen;							//!< A frame is being measured
+	std::chrono::steady_clock::time_point _frameStart;				//!< CPU start of the current frame
+
+	RingBuffer<float>			_frameTime;							//!< CPU milliseconds of each frame, including the GUI
+	std::vector<std::unique_ptr<RingBuffer<float>>> _passTime;		//!< GPU milliseconds of each pass
+	std::vector<std::unique_ptr<RingBuffer<float>>> _stageTime;		//!< Milliseconds of each stage, one value per voxelization
+
+protected:
+	/**
+	*	@brief Constructor.
+	*/
+	PerformanceMonitor();
+
+	/**
+	*	@brief Reads the timestamps of a frame in flight if they are available, and releases the slot.
+	*/
+	void collect(FrameQueries& frame);
+
+public:
+	/**
+	*	@brief Destructor.
+	*/
+	virtual ~PerformanceMonitor();
+
+	/**
+	*	@brief Starts measuring a frame, and collects the oldest frame in flight. Must be called from the thread which owns the OpenGL context.
+	*/
+	void beginFrame();
+
+	/**
+	*	@brief Finishes the current frame.
+	*/
+	void endFrame();
+
+	/**
+	*	@return CPU milliseconds of the last frames.
+	*/
+	const RingBuffer<float>& getFrameTime() const { return _frameTime; }
+
+	/**
+	*	@return Name of a pass.
+	*/
+	static const char* getPassName(FramePass pass) { return FRAME_PASS_NAME[pass]; }
+
+	/**
+	*	@return GPU milliseconds of a pass in the last measured frames.
+	*/
+	const RingBuffer<float>& getPassTime(FramePass pass) const { return *_passTime[pass]; }
+
+	/**
+	*	@return Name of a voxelization stage.
+	*/
+	static const char* getStageName(LoadStage stage) { return LOAD_STAGE_NAME[stage]; }
+
+	/**
+	*	@return Milliseconds of a stage in the last voxelizations.
+	*/
+	const RingBuffer<float>& getStageTime(LoadStage stage) const { return *_stageTime[stage]; }
+
+	/**
+	*	@return True if scene passes are measured.
+	*/
+	bool isEnabled() const { return _enabled; }
+
+	/**
+	*	@brief Appends the time spent by a stage of the last voxelization.
+	*/
+	void recordStage(LoadStage stage, double milliseconds);
+
+	/**
+	*	@brief Starts or stops measuring scene passes. Changes take effect at the next frame.
+	*/
+	void setEnabled(bool enabled) { _enabled = enabled; }
+};
+
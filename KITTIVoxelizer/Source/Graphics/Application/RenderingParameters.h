@@ -38,6 +38,10 @@ public:
 	// Point cloud	
 	float							_scenePointSize;						//!< Size of points in a cloud
 	vec3							_scenePointCloudColor;					//!< Color of point cloud which shows all the vertices
+	int								_pointBudget;							//!< Maximum number of points drawn per frame from the level-of-detail hierarchy
+	float							_maxPointSpacing;						//!< Nodes whose points are projected closer than this number of pixels are not refined
+	bool							_downsamplePointCloud;					//!< Loaded point clouds are reduced to a point per voxel before being uploaded
+	ivec3							_downsampleResolution;					//!< Size of the grid used to downsample point clouds
 
 	// Wireframe
 	vec3							_bvhWireframeColor;						//!< Color of BVH structure
@@ -56,6 +60,8 @@ public:
 	vec4							_planeCoefficients;						//!< 
 	int								_pointCloudType;						//!< ID of the point cloud type which must be rendered
 	bool							_renderVoxelizedMesh;					//!< Renders mesh as a voxelized model
+	bool							_renderVoxelSurface;					//!< Voxels are drawn as their greedy-meshed boundary instead of a cube per voxel
+	bool							_cullVoxelChunks;						//!< Chunks of voxel instances out of the frustum are not drawn
 	bool							_showBVH;								//!< Render BVH data structure
 	bool							_showTriangleMesh;						//!< Render original scene
 
@@ -81,6 +87,10 @@ public:
 
 		_scenePointSize(2.0f),
 		_scenePointCloudColor(1.0f, .0f, .0f),
+		_pointBudget(5000000),
+		_maxPointSpacing(2.0f),
+		_downsamplePointCloud(false),
+		_downsampleResolution(1024, 1024, 128),
 
 		_bvhWireframeColor(1.0f, 1.0f, .0f),
 		_normalLength(1.0f),
@@ -95,6 +105,8 @@ public:
 		_planeCoefficients(.0f),
 		_pointCloudType(PointCloudType::UNIFORM),
 		_renderVoxelizedMesh(true),
+		_renderVoxelSurface(false),
+		_cullVoxelChunks(true),
 		_showBVH(false),
 		_showTriangleMesh(true),
 
@@ -2,6 +2,7 @@
 #include "SSAOScene.h"
 
 #include "Geometry/3D/Intersections3D.h"
+#include "Graphics/Application/PerformanceMonitor.h"
 #include "Graphics/Application/Renderer.h"
 #include "Graphics/Application/TextureList.h"
 #include "Graphics/Core/OpenGLUtilities.h"
@@ -29,12 +30,20 @@ void SSAOScene::render(const mat4& mModel, RenderingParameters* rendParams)
 {
 	Camera* activeCamera = _cameraManager->getActiveCamera();
 
-	this->drawAsTriangles4Shadows(mModel, rendParams);
+	{
+		PerformanceMonitor::ScopedPass shadowPass(PerformanceMonitor::SHADOW_PASS);
+		this->drawAsTriangles4Shadows(mModel, rendParams);
+	}
 
 	if (rendParams->_ambientOcclusion && this->needToApplyAmbientOcclusion(rendParams))
 	{
 		_ssaoFBO->bindMultisamplingFBO();
-		this->renderScene(mModel, rendParams);
+		{
+			PerformanceMonitor::ScopedPass scenePass(PerformanceMonitor::SCENE_PASS);
+			this->renderScene(mModel, rendParams);
+		}
+
+		PerformanceMonitor::ScopedPass ssaoPass(PerformanceMonitor::SSAO_PASS);
 		_ssaoFBO->writeGBuffer(0);
 
 		_ssaoFBO->bindGBufferFBO(1);
@@ -53,6 +62,7 @@ void SSAOScene::render(const mat4& mModel, RenderingParameters* rendParams)
 	{
 		this->bindDefaultFramebuffer(rendParams);
 
+		PerformanceMonitor::ScopedPass scenePass(PerformanceMonitor::SCENE_PASS);
 		this->renderScene(mModel, rendParams);
 	}
 }
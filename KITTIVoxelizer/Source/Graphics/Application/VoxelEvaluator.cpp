@@ -0,0 +1,266 @@
+#include "stdafx.h"
+#include "VoxelEvaluator.h"
+
+#include <emmintrin.h>
+#include <filesystem>
+
+// Initialization of static attributes
+const size_t VoxelEvaluator::SIMD_CHUNK_SIZE = 1 << 24;
+
+/// [Public methods]
+
+VoxelEvaluator::VoxelEvaluator(const uvec3& subdivisions, unsigned numClasses) : _numClasses(glm::clamp(numClasses, 1u, 255u)), _numDivs(subdivisions)
+{
+}
+
+VoxelEvaluator::~VoxelEvaluator()
+{
+}
+
+VoxelEvaluator::Metrics VoxelEvaluator::computeMetrics(const ConfusionMatrix& matrix, bool semantic) const
+{
+	Metrics metrics;
+	uint64_t truePositive = 0, falsePositive = 0, falseNegative = 0;
+
+	// Completion: any class but the empty one is occupied
+	for (unsigned gt = 0; gt < _numClasses; ++gt)
+	{
+		for (unsigned pred = 0; pred < _numClasses; ++pred)
+		{
+			const uint64_t count = matrix[gt * _numClasses + pred];
+
+			if (gt && pred) truePositive += count;
+			else if (pred) falsePositive += count;
+			else if (gt) falseNegative += count;
+		}
+	}
+
+	metrics._completionIoU = double(truePositive) / std::max(truePositive + falsePositive + falseNegative, uint64_t(1));
+	metrics._precision = double(truePositive) / std::max(truePositive + falsePositive, uint64_t(1));
+	metrics._recall = double(truePositive) / std::max(truePositive + falseNegative, uint64_t(1));
+	metrics._classIoU.resize(_numClasses, NAN);
+	metrics._mIoU = .0;
+	metrics._semantic = semantic;
+	metrics._valid = true;
+
+	if (!semantic)
+	{
+		metrics._mIoU = NAN;
+		return metrics;
+	}
+
+	unsigned numSeenClasses = 0;
+
+	for (unsigned label = 1; label < _numClasses; ++label)
+	{
+		uint64_t row = 0, column = 0;
+
+		for (unsigned idx = 0; idx < _numClasses; ++idx)
+		{
+			row += matrix[label * _numClasses + idx];
+			column += matrix[idx * _numClasses + label];
+		}
+
+		const uint64_t classTP = matrix[label * _numClasses + label], classUnion = row + column - classTP;
+
+		if (classUnion)
+		{
+			metrics._classIoU[label] = double(classTP) / classUnion;
+			metrics._mIoU += metrics._classIoU[label];
+			++numSeenClasses;
+		}
+	}
+
+	metrics._mIoU /= std::max(numSeenClasses, 1u);
+
+	return metrics;
+}
+
+VoxelEvaluator::Metrics VoxelEvaluator::evaluate(const std::vector<ScanPair>& scanPair, std::vector<Metrics>& scanMetrics) const
+{
+	// A matrix per thread rather than per scan, as each one holds numClasses^2 counters
+	const size_t numBins = _numClasses * _numClasses + 1;
+	const size_t numRanges = std::min(scanPair.size(), size_t(std::max(std::thread::hardware_concurrency(), 1u)));
+	std::vector<ConfusionMatrix> rangeMatrix(numRanges, ConfusionMatrix(numBins, 0));
+	std::vector<uint8_t> rangeSemantic(numRanges, 1);
+	std::vector<size_t> rangeIdx(numRanges);
+	std::iota(rangeIdx.begin(), rangeIdx.end(), 0);
+
+	scanMetrics.resize(scanPair.size());
+
+	std::for_each(std::execution::par, rangeIdx.begin(), rangeIdx.end(), [&](const size_t idx)
+	{
+		const size_t firstScan = idx * scanPair.size() / numRanges, lastScan = (idx + 1) * scanPair.size() / numRanges;
+		ConfusionMatrix scanMatrix;
+
+		for (size_t scan = firstScan; scan < lastScan; ++scan)
+		{
+			bool semantic = true;
+			const bool success = this->accumulate(scanPair[scan], scanMatrix, semantic);
+
+			scanMetrics[scan] = this->computeMetrics(scanMatrix, semantic);
+			scanMetrics[scan]._valid = success;
+
+			if (!success) continue;
+
+			std::transform(scanMatrix.begin(), scanMatrix.end(), rangeMatrix[idx].begin(), rangeMatrix[idx].begin(), std::plus<uint64_t>());
+			rangeSemantic[idx] &= semantic;
+		}
+	});
+
+	// Counts are integers, hence the reduction does not depend on scheduling
+	ConfusionMatrix sequenceMatrix(numBins, 0);
+
+	for (const ConfusionMatrix& matrix : rangeMatrix)
+		std::transform(matrix.begin(), matrix.end(), sequenceMatrix.begin(), sequenceMatrix.begin(), std::plus<uint64_t>());
+
+	const bool semantic = std::all_of(rangeSemantic.begin(), rangeSemantic.end(), [](const uint8_t rangeIsSemantic) { return rangeIsSemantic; });
+	const bool valid = std::all_of(scanMetrics.begin(), scanMetrics.end(), [](const Metrics& metrics) { return metrics._valid; });
+
+	Metrics sequenceMetrics = this->computeMetrics(sequenceMatrix, semantic);
+	sequenceMetrics._valid = valid;
+
+	return sequenceMetrics;
+}
+
+std::vector<VoxelEvaluator::ScanPair> VoxelEvaluator::getScanPairs(const std::string& predictionFolder, const std::string& groundTruthFolder)
+{
+	std::vector<ScanPair> scanPair;
+	std::error_code error;
+
+	for (const auto& entry : std::filesystem::directory_iterator(groundTruthFolder, error))
+	{
+		if (entry.path().extension() != LABEL_EXTENSION) continue;
+
+		const std::filesystem::path invalidPath = std::filesystem::path(entry.path()).replace_extension(INVALID_EXTENSION);
+
+		ScanPair pair;
+		pair._groundTruth = entry.path().string();
+		pair._prediction = (std::filesystem::path(predictionFolder) / entry.path().filename()).string();
+		pair._invalid = std::filesystem::exists(invalidPath) ? invalidPath.string() : "";
+
+		scanPair.push_back(pair);
+	}
+
+	std::sort(scanPair.begin(), scanPair.end(), [](const ScanPair& a, const ScanPair& b) { return a._groundTruth < b._groundTruth; });
+
+	return scanPair;
+}
+
+bool VoxelEvaluator::writeReport(const std::string& filename, const std::vector<ScanPair>& scanPair, const std::vector<Metrics>& scanMetrics, const Metrics& sequenceMetrics) const
+{
+	std::ofstream out(filename, std::ios::out | std::ios::trunc);
+	if (!out.is_open()) return false;
+
+	auto writeRow = [&](const std::string& name, const Metrics& metrics)
+	{
+		out << name << ',' << metrics._valid << ',' << metrics._completionIoU << ',' << metrics._precision << ',' << metrics._recall << ',' << metrics._mIoU;
+		for (unsigned label = 1; label < _numClasses; ++label) out << ',' << metrics._classIoU[label];
+		out << '\n';
+	};
+
+	out << "scan,valid,completion_iou,precision,recall,miou";
+	for (unsigned label = 1; label < _numClasses; ++label) out << ",iou_" << label;
+	out << '\n';
+
+	for (size_t idx = 0; idx < scanPair.size() && idx < scanMetrics.size(); ++idx)
+		writeRow(scanPair[idx]._groundTruth, scanMetrics[idx]);
+
+	writeRow("sequence", sequenceMetrics);
+
+	out.close();
+
+	return !out.fail();
+}
+
+/// [Protected methods]
+
+bool VoxelEvaluator::accumulate(const ScanPair& scanPair, ConfusionMatrix& matrix, bool& semantic) const
+{
+	RegularGridView prediction(_numDivs), groundTruth(_numDivs), invalid(_numDivs);
+
+	matrix.assign(_numClasses * _numClasses + 1, 0);
+	semantic = true;
+
+	if (!prediction.open(scanPair._prediction) || !groundTruth.open(scanPair._groundTruth)) return false;
+	if (!scanPair._invalid.empty() && !invalid.open(scanPair._invalid)) return false;
+
+	const uint8_t* invalidData = scanPair._invalid.empty() ? nullptr : invalid.getPackedData();
+
+	if (prediction.getLabelData() && groundTruth.getLabelData())
+	{
+		this->accumulateLabels(prediction.getLabelData(), groundTruth.getLabelData(), invalidData, matrix);
+	}
+	else
+	{
+		// Occupancy files only distinguish empty from occupied voxels, hence labels of the other grid are not compared either
+		const size_t numVoxels = groundTruth.length(), trashBin = _numClasses * _numClasses;
+		const unsigned occupied = std::min(_numClasses - 1, 1u);
+
+		semantic = false;
+
+		for (size_t voxel = 0; voxel < numVoxels; ++voxel)
+		{
+			const unsigned gt = groundTruth.isOccupied(voxel) ? occupied : 0, pred = prediction.isOccupied(voxel) ? occupied : 0;
+			const bool masked = invalidData && invalid.isOccupied(voxel);
+
+			++matrix[masked ? trashBin : gt * _numClasses + pred];
+		}
+	}
+
+	return true;
+}
+
+void VoxelEvaluator::accumulateLabels(const uint8_t* prediction, const uint8_t* groundTruth, const uint8_t* invalid, ConfusionMatrix& matrix) const
+{
+	const size_t numVoxels = size_t(_numDivs.x) * _numDivs.y * _numDivs.z, numBins = matrix.size(), trashBin = numBins - 1;
+	const __m128i signFlip = _mm_set1_epi16(int16_t(0x8000)), limit = _mm_set1_epi16(int16_t(_numClasses ^ 0x8000));
+	const __m128i numClasses = _mm_set1_epi16(int16_t(_numClasses)), trash = _mm_set1_epi16(int16_t(trashBin));
+	const __m128i bitMask = _mm_setr_epi16(0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+
+	// Two 32-bit histograms interleave consecutive increments, and are merged before they could overflow
+	std::vector<uint32_t> histogram(numBins * 2);
+	alignas(16) uint16_t binIdx[8];
+
+	for (size_t firstVoxel = 0; firstVoxel < numVoxels; firstVoxel += SIMD_CHUNK_SIZE)
+	{
+		const size_t lastVoxel = std::min(firstVoxel + SIMD_CHUNK_SIZE, numVoxels), lastSimdVoxel = firstVoxel + (lastVoxel - firstVoxel) / 8 * 8;
+		std::fill(histogram.begin(), histogram.end(), 0);
+
+		for (size_t voxel = firstVoxel; voxel < lastSimdVoxel; voxel += 8)
+		{
+			const __m128i gt = _mm_loadu_si128(reinterpret_cast<const __m128i*>(groundTruth + voxel * sizeof(uint16_t)));
+			const __m128i pred = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prediction + voxel * sizeof(uint16_t)));
+
+			// Unsigned comparison through the sign bit, as SSE2 only compares signed integers
+			__m128i valid = _mm_and_si128(_mm_cmplt_epi16(_mm_xor_si128(gt, signFlip), limit), _mm_cmplt_epi16(_mm_xor_si128(pred, signFlip), limit));
+
+			if (invalid)
+			{
+				const __m128i maskBits = _mm_and_si128(_mm_set1_epi16(invalid[voxel >> 3]), bitMask);
+				valid = _mm_and_si128(valid, _mm_cmpeq_epi16(maskBits, _mm_setzero_si128()));
+			}
+
+			const __m128i index = _mm_add_epi16(_mm_mullo_epi16(gt, numClasses), pred);
+			_mm_store_si128(reinterpret_cast<__m128i*>(binIdx), _mm_or_si128(_mm_and_si128(valid, index), _mm_andnot_si128(valid, trash)));
+
+			++histogram[binIdx[0]]; ++histogram[numBins + binIdx[1]];
+			++histogram[binIdx[2]]; ++histogram[numBins + binIdx[3]];
+			++histogram[binIdx[4]]; ++histogram[numBins + binIdx[5]];
+			++histogram[binIdx[6]]; ++histogram[numBins + binIdx[7]];
+		}
+
+		for (size_t voxel = lastSimdVoxel; voxel < lastVoxel; ++voxel)
+		{
+			uint16_t gt, pred;
+			std::memcpy(&gt, groundTruth + voxel * sizeof(uint16_t), sizeof(uint16_t));
+			std::memcpy(&pred, prediction + voxel * sizeof(uint16_t), sizeof(uint16_t));
+
+			const bool masked = (invalid && ((invalid[voxel >> 3] >> (7 - (voxel & 7))) & 1)) || gt >= _numClasses || pred >= _numClasses;
+			++histogram[masked ? trashBin : gt * _numClasses + pred];
+		}
+
+		for (size_t bin = 0; bin < numBins; ++bin)
+			matrix[bin] += uint64_t(histogram[bin]) + histogram[numBins + bin];
+	}
+}
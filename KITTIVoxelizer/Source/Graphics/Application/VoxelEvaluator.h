@@ -0,0 +1,97 @@
+#pragma once
+
+#include "DataStructures/RegularGridView.h"
+
+/**
+*	@file VoxelEvaluator.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Semantic scene completion metrics (completion IoU, per-class IoU and mIoU) of predicted grids against ground-truth grids.
+*	Confusion matrices are accumulated with SIMD over the mapped label volumes, and scan pairs are evaluated in parallel. Grids which
+*	only store occupancy are compared as occupied or empty voxels, hence they only contribute to completion metrics.
+*/
+class VoxelEvaluator
+{
+public:
+	struct ScanPair
+	{
+		std::string				_prediction;						//!< Predicted voxel file (.label or .bin)
+		std::string				_groundTruth;						//!< Ground-truth voxel file
+		std::string				_invalid;							//!< Mask of voxels excluded from evaluation (.invalid), may be empty
+	};
+
+	struct Metrics
+	{
+		double					_completionIoU;						//!< IoU of occupied vs. empty voxels
+		double					_precision;							//!< Precision of occupied voxels
+		double					_recall;							//!< Recall of occupied voxels
+		std::vector<double>		_classIoU;							//!< IoU of each semantic class, NaN if the class was never seen nor predicted
+		double					_mIoU;								//!< Mean IoU of semantic classes, empty class excluded
+		bool					_semantic;							//!< False if any grid only stores occupancy, in which case class IoUs and mIoU are NaN
+		bool					_valid;								//!< False if any of the files could not be read
+	};
+
+	typedef std::vector<uint64_t> ConfusionMatrix;					//!< Ground truth as rows, prediction as columns
+
+protected:
+	const static size_t		SIMD_CHUNK_SIZE;						//!< Voxels accumulated in 32-bit counters before merging
+
+protected:
+	unsigned				_numClasses;							//!< Labels in [0, numClasses) are evaluated, 0 being the empty class
+	uvec3					_numDivs;								//!< Resolution of every grid
+
+protected:
+	/**
+	*	@brief Accumulates the confusion matrix of a single scan pair. If either grid only stores occupancy, occupied voxels of both
+	*	grids are accounted to the first class rather than comparing labels against occupancy.
+	*	@param semantic False if labels were not compared.
+	*	@return False if any of the files could not be read.
+	*/
+	bool accumulate(const ScanPair& scanPair, ConfusionMatrix& matrix, bool& semantic) const;
+
+	/**
+	*	@brief Accumulates label volumes eight voxels at a time. Labels out of range and masked voxels are sent to an additional bin.
+	*/
+	void accumulateLabels(const uint8_t* prediction, const uint8_t* groundTruth, const uint8_t* invalid, ConfusionMatrix& matrix) const;
+
+public:
+	/**
+	*	@brief Constructor.
+	*	@param numClasses Number of classes, including the empty one. At most 255.
+	*/
+	VoxelEvaluator(const uvec3& subdivisions, unsigned numClasses);
+
+	/**
+	*	@brief Destructor.
+	*/
+	virtual ~VoxelEvaluator();
+
+	/**
+	*	@brief Computes metrics from a confusion matrix.
+	*	@param semantic False if the matrix only tells occupied from empty voxels, in which case only completion metrics are computed.
+	*/
+	Metrics computeMetrics(const ConfusionMatrix& matrix, bool semantic = true) const;
+
+	/**
+	*	@brief Evaluates a sequence of scan pairs in parallel. Each thread evaluates a contiguous range of scans and accumulates them
+	*	in its own confusion matrix, so that memory does not grow with the length of the sequence.
+	*	@param scanMetrics Metrics of each scan pair, in the same order.
+	*	@return Metrics of the whole sequence, computed from the merged confusion matrices of valid scans.
+	*/
+	Metrics evaluate(const std::vector<ScanPair>& scanPair, std::vector<Metrics>& scanMetrics) const;
+
+	/**
+	*	@brief Pairs every .label file of the ground-truth folder with the prediction of the same name, and with its .invalid mask if it exists.
+	*/
+	static std::vector<ScanPair> getScanPairs(const std::string& predictionFolder, const std::string& groundTruthFolder);
+
+	/**
+	*	@brief Writes a CSV report with one row per scan and a final row for the sequence.
+	*	@return Success of writing process.
+	*/
+	bool writeReport(const std::string& filename, const std::vector<ScanPair>& scanPair, const std::vector<Metrics>& scanMetrics, const Metrics& sequenceMetrics) const;
+};
+
@@ -0,0 +1,364 @@
+#include "stdafx.h"
+#include "VoxelizationPipeline.h"
+
+#include "DataStructures/BrickedGrid.h"
+#include "Graphics/Core/ComputeBackend.h"
+#include "Utilities/MemoryTracker.h"
+#include "Utilities/Profiler.h"
+
+// Initialization of static attributes
+const unsigned VoxelizationPipeline::NUM_VOXELIZATION_THREADS = 1;
+
+/// [Public methods]
+
+VoxelizationPipeline::VoxelizationPipeline(const Settings& settings) : _settings(settings), _nextScan(0), _numFailed(0), _manifest(nullptr), _readTime(0), _voxelizationTime(0), _exportTime(0), _timings()
+{
+}
+
+VoxelizationPipeline::~VoxelizationPipeline()
+{
+}
+
+void VoxelizationPipeline::run(const std::vector<std::string>& pointCloudPath, const std::string& outputFolder, const uvec3& subdivisions, PointCloud*& pointCloud, RegularGrid*& grid)
+{
+	pointCloud = nullptr;
+	grid = nullptr;
+
+	const auto startTime = std::chrono::steady_clock::now();
+	_readTime = _voxelizationTime = _exportTime = 0;
+	_timings = Timings();
+
+	std::unique_ptr<BatchManifest> manifest;
+	std::vector<std::string> pendingPath;
+
+	if (_settings._incremental)
+	{
+		manifest.reset(new BatchManifest(outputFolder + BatchManifest::MANIFEST_FILENAME));
+		manifest->load();
+		_manifest = manifest.get();
+
+		pendingPath = this->getPendingScans(pointCloudPath, outputFolder, subdivisions);
+		std::cout << "Skipping " << pointCloudPath.size() - pendingPath.size() << " up-to-date scans." << std::endl;
+	}
+	else
+	{
+		pendingPath = pointCloudPath;
+	}
+
+	if (pendingPath.empty())
+	{
+		_manifest = nullptr;
+		return;
+	}
+
+	_timings._numScans = pendingPath.size();
+
+	_loadedQueue.reset(new BoundedQueue<ScanTask>(_settings._readQueueDepth));
+	_voxelizedQueue.reset(new BoundedQueue<ScanTask>(_settings._writeQueueDepth));
+	_nextScan = 0;
+	_numFailed = 0;
+	_lastScan = ScanTask();
+
+	// Every reader, queue slot, the voxelization stage and every writer may hold a point cloud at once
+	const size_t numArenas = std::max(_settings._numReaders, 1u) + _settings._readQueueDepth + 1 + _settings._writeQueueDepth + std::max(_settings._numWriters, 1u);
+	while (_arena.size() < numArenas) _arena.emplace_back(new ScanArena());
+
+	_freeArena.reset(new BoundedQueue<ScanArena*>(_arena.size()));
+	for (std::unique_ptr<ScanArena>& arena : _arena) _freeArena->push(arena.get());
+
+	std::vector<std::thread> readers, writers;
+	std::exception_ptr exception;
+
+	for (unsigned threadIdx = 0; threadIdx < std::max(_settings._numReaders, 1u); ++threadIdx)
+		readers.push_back(std::thread(&VoxelizationPipeline::readScans, this, std::cref(pendingPath)));
+
+	for (unsigned threadIdx = 0; threadIdx < std::max(_settings._numWriters, 1u); ++threadIdx)
+		writers.push_back(std::thread(&VoxelizationPipeline::exportScans, this, std::cref(outputFolder)));
+
+	try
+	{
+		this->voxelizeScans(pendingPath.size(), subdivisions);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Voxelization pipeline stopped: " << e.what() << std::endl;
+		exception = std::current_exception();
+	}
+
+	// Readers may be waiting for room or arenas if voxelization did not finish
+	_loadedQueue->close();
+	_freeArena->close();
+	for (std::thread& reader : readers) reader.join();
+
+	// Grids which are already voxelized are still exported
+	_voxelizedQueue->close();
+	for (std::thread& writer : writers) writer.join();
+
+	// Buffers of the last scan are handed over, and its arena will allocate new ones if the pipeline runs again
+	if (_lastScan._arena) pointCloud = _lastScan._arena->_pointCloud.release();
+	grid = _lastScan._grid.release();
+	_lastScan = ScanTask();
+
+	// Grids are only reused within a run, as they are the largest buffers
+	{
+		std::lock_guard<std::mutex> lock(_freeGridMutex);
+		_freeGrid.clear();
+	}
+
+	// Records were already appended as scans were exported; only the compaction of the manifest is lost otherwise
+	if (_manifest)
+	{
+		if (!_manifest->save()) std::cerr << "Manifest of " << outputFolder << " could not be rewritten." << std::endl;
+		_manifest = nullptr;
+	}
+
+	_timings._numFailed = _numFailed;
+	if (_numFailed) std::cerr << _numFailed << " of " << _timings._numScans << " scans could not be exported or recorded." << std::endl;
+
+	_timings._read = _readTime / 1e6;
+	_timings._voxelization = _voxelizationTime / 1e6;
+	_timings._export = _exportTime / 1e6;
+	_timings._total = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+	if (exception) std::rethrow_exception(exception);
+}
+
+/// [Protected methods]
+
+std::unique_ptr<RegularGrid> VoxelizationPipeline::acquireGrid(const AABB& aabb, const uvec3& subdivisions)
+{
+	std::unique_ptr<RegularGrid> grid;
+
+	{
+		std::lock_guard<std::mutex> lock(_freeGridMutex);
+
+		if (!_freeGrid.empty())
+		{
+			grid = std::move(_freeGrid.back());
+			_freeGrid.pop_back();
+		}
+	}
+
+	if (grid)	grid->reset(aabb, subdivisions);
+	else		grid.reset(new RegularGrid(aabb, subdivisions));
+
+	return grid;
+}
+
+void VoxelizationPipeline::exportScans(const std::string& outputFolder)
+{
+	const std::string outputExtension = this->getOutputExtension();
+	ScanTask task;
+
+	while (_voxelizedQueue->pop(task))
+	{
+		if (task._grid)
+		{
+			const std::string outputName = getOutputName(outputFolder, task._path);
+			const auto startTime = std::chrono::steady_clock::now();
+
+			try
+			{
+				PROFILE_ZONE("VoxelizationPipeline::export");
+
+				switch (_settings._format)
+				{
+				case COMPRESSED_LABELS:
+					if (!task._grid->exportCompressed(outputName)) throw std::runtime_error("Compressed grid could not be written");
+					break;
+				case BRICKED_LABELS:
+					if (!BrickedGrid::exportGrid(task._grid.get(), outputName)) throw std::runtime_error("Bricked grid could not be written");
+					break;
+				default:
+					task._grid->exportBinary(outputName);
+					break;
+				}
+
+				// Otherwise, the next incremental run would voxelize it again
+				if (_manifest && !_manifest->record(task._path + PLY_EXTENSION, outputName + outputExtension, task._grid->getNumSubdivisions()))
+					throw std::runtime_error("Manifest could not be updated");
+			}
+			catch (const std::exception& e)
+			{
+				std::cerr << "Failed to export " << task._path << ": " << e.what() << std::endl;
+				++_numFailed;
+			}
+
+			_exportTime += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+		}
+
+		if (task._keep)
+		{
+			std::lock_guard<std::mutex> lock(_lastScanMutex);
+			_lastScan = std::move(task);
+		}
+		else
+		{
+			if (task._grid) this->releaseGrid(std::move(task._grid));
+			_freeArena->push(std::move(task._arena));
+		}
+
+		task = ScanTask();
+	}
+}
+
+bool VoxelizationPipeline::fitMemoryBudget(ScanArena* arena, uvec3& subdivisions) const
+{
+	if (!_settings._memoryBudget) return true;
+
+	// Points of this scan and buffers of every arena are already reported to the tracker
+	const size_t numPoints = arena->_pointCloud->getNumberOfPoints(), inUse = MemoryTracker::getInstance()->getCurrentTotal();
+	const size_t histogramSize = _histogram.capacity() * sizeof(unsigned);
+	size_t gridSize = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(_freeGridMutex);
+		if (!_freeGrid.empty()) gridSize = _freeGrid.back()->getAllocatedSize();
+	}
+
+	const unsigned numLabels = arena->_pointCloud->getMaxLabel() + 1;
+
+	auto growth = [](size_t needed, size_t allocated) -> size_t { return needed > allocated ? needed - allocated : 0; };
+
+	auto fits = [&](const uvec3& numDivs) -> bool
+	{
+		MemoryTracker::Footprint footprint = RegularGrid::estimateFootprint(numDivs, numPoints, numLabels);
+		footprint._bytes[MemoryTracker::POINTS] = 0;
+		footprint._bytes[MemoryTracker::VOXEL_GRID] = growth(footprint._bytes[MemoryTracker::VOXEL_GRID], gridSize);
+
+		// The GPU compute backend allocates its own histogram, which is not reused
+		if (ComputeBackend::getSelectedBackend() == ComputeBackend::CPU_BACKEND)
+			footprint._bytes[MemoryTracker::LABEL_HISTOGRAM] = growth(footprint._bytes[MemoryTracker::LABEL_HISTOGRAM], histogramSize);
+
+		return inUse + footprint.getTotal() <= _settings._memoryBudget;
+	};
+
+	while (!fits(subdivisions))
+	{
+		if (!_settings._downscaleOverBudget || subdivisions == uvec3(1)) return false;
+
+		subdivisions = glm::max(subdivisions / uvec3(2), uvec3(1));
+	}
+
+	return true;
+}
+
+std::string VoxelizationPipeline::getOutputExtension() const
+{
+	switch (_settings._format)
+	{
+	case COMPRESSED_LABELS:	return COMPRESSED_GRID_EXTENSION;
+	case BRICKED_LABELS:	return BRICKED_GRID_EXTENSION;
+	default:				return BINARY_EXTENSION;
+	}
+}
+
+std::string VoxelizationPipeline::getOutputName(const std::string& outputFolder, const std::string& path)
+{
+	const size_t barPos = path.find_last_of("/");
+
+	return outputFolder + path.substr(barPos + 1);
+}
+
+std::vector<std::string> VoxelizationPipeline::getPendingScans(const std::vector<std::string>& pointCloudPath, const std::string& outputFolder, const uvec3& subdivisions)
+{
+	std::vector<uint8_t> upToDate(pointCloudPath.size());
+	std::vector<std::string> pendingPath;
+	const std::string outputExtension = this->getOutputExtension();
+
+	// Outputs are hashed to verify them, hence the scans are checked in parallel
+	std::transform(std::execution::par, pointCloudPath.begin(), pointCloudPath.end(), upToDate.begin(), [&](const std::string& path) -> uint8_t
+	{
+		return _manifest->isUpToDate(path + PLY_EXTENSION, getOutputName(outputFolder, path) + outputExtension, subdivisions);
+	});
+
+	// The last scan is always voxelized, as it is returned for rendering
+	for (size_t scanIdx = 0; scanIdx < pointCloudPath.size(); ++scanIdx)
+	{
+		if (!upToDate[scanIdx] || scanIdx + 1 == pointCloudPath.size()) pendingPath.push_back(pointCloudPath[scanIdx]);
+	}
+
+	return pendingPath;
+}
+
+void VoxelizationPipeline::readScans(const std::vector<std::string>& pointCloudPath)
+{
+	size_t scanIdx;
+	ScanArena* arena;
+
+	// Blocks while every arena is in use by later stages
+	while ((scanIdx = _nextScan++) < pointCloudPath.size() && _freeArena->pop(arena))
+	{
+		ScanTask task;
+		task._path = pointCloudPath[scanIdx];
+		task._arena = arena;
+
+		// Scans are popped in any order by several readers, whereas the returned scan must be the last one of the list
+		task._keep = scanIdx + 1 == pointCloudPath.size();
+
+		const auto startTime = std::chrono::steady_clock::now();
+
+		try
+		{
+			PROFILE_ZONE("VoxelizationPipeline::read");
+
+			if (arena->_pointCloud)	arena->_pointCloud->reset(task._path);
+			else					arena->_pointCloud.reset(new PointCloud(task._path, true));
+
+			arena->_pointCloud->load();
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << "Failed to load " << task._path << ": " << e.what() << std::endl;
+		}
+
+		_readTime += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+		// Blocks while the voxelization stage is behind
+		if (!_loadedQueue->push(std::move(task))) break;
+	}
+}
+
+void VoxelizationPipeline::releaseGrid(std::unique_ptr<RegularGrid>&& grid)
+{
+	std::lock_guard<std::mutex> lock(_freeGridMutex);
+
+	// Grids beyond the pool capacity are destroyed right away instead of being held until the run ends
+	if (_freeGrid.size() < NUM_VOXELIZATION_THREADS) _freeGrid.push_back(std::move(grid));
+	else grid.reset();
+}
+
+void VoxelizationPipeline::voxelizeScans(const size_t numScans, const uvec3& subdivisions)
+{
+	ScanTask task;
+
+	for (size_t scanIdx = 0; scanIdx < numScans && _loadedQueue->pop(task); ++scanIdx)
+	{
+		uvec3 scanSubdivisions = subdivisions;
+		ScanArena* arena = task._arena;
+
+		// Point clouds which could not be allocated are not voxelized
+		const size_t numPoints = arena->_pointCloud ? arena->_pointCloud->getNumberOfPoints() : 0;
+
+		if (numPoints && !this->fitMemoryBudget(arena, scanSubdivisions))
+		{
+			std::cerr << "Skipping " << task._path << ": its grid exceeds the memory budget." << std::endl;
+		}
+		else if (numPoints)
+		{
+			if (scanSubdivisions != subdivisions)
+				std::cout << "Voxelizing " << task._path << " at " << scanSubdivisions.x << "x" << scanSubdivisions.y << "x" << scanSubdivisions.z << " to fit the memory budget." << std::endl;
+
+			const auto startTime = std::chrono::steady_clock::now();
+			PROFILE_ZONE("VoxelizationPipeline::voxelize");
+
+			task._grid = this->acquireGrid(arena->_pointCloud->getAABB(), scanSubdivisions);
+			task._grid->fill(arena->_pointCloud.get(), &_histogram);
+
+			_voxelizationTime += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+		}
+
+		_voxelizedQueue->push(std::move(task));
+		task = ScanTask();
+	}
+}
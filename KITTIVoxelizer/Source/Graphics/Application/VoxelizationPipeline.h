@@ -0,0 +1,193 @@
+#pragma once
+
+#include "DataStructures/BoundedQueue.h"
+#include "DataStructures/RegularGrid.h"
+#include "Graphics/Application/BatchManifest.h"
+#include "Graphics/Core/PointCloud.h"
+
+/**
+*	@file VoxelizationPipeline.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Batch voxelization of point clouds split into three overlapping stages: reading (prefetching threads),
+*	voxelization (calling thread, as it owns the OpenGL context of the GPU compute backend) and exporting (writing threads).
+*	Scans travel through the stages inside arenas which are recycled once exported, so that points are reallocated only when a scan
+*	larger than any previous one arrives. Grids are pooled apart, as only the voxelization stage needs a new one; exported grids are
+*	handed out again last-in first-out, and the pool keeps no more grids than voxelization threads, released once the run ends. Votes
+*	are only needed by the voxelization stage, hence a single histogram is shared by every scan.
+*/
+class VoxelizationPipeline
+{
+public:
+	enum GridFormat
+	{
+		PACKED_OCCUPANCY,									//!< RegularGrid::exportBinary
+		COMPRESSED_LABELS,									//!< RegularGrid::exportCompressed
+		BRICKED_LABELS										//!< BrickedGrid::exportGrid, which allows reading regions without inflating the whole grid
+	};
+
+	struct Settings
+	{
+		GridFormat	_format;								//!< Encoding of exported grids
+		bool		_downscaleOverBudget;					//!< Scans over the memory budget are voxelized at halved resolutions instead of being skipped
+		bool		_incremental;							//!< Skips scans whose input, grid resolution and output did not change since the last run
+		size_t		_memoryBudget;							//!< Bytes which can be reported to MemoryTracker while voxelizing, zero if there is no limit
+		unsigned	_numReaders;							//!< Threads which load point clouds in advance
+		unsigned	_numWriters;							//!< Threads which export voxelized grids
+		unsigned	_readQueueDepth;						//!< Maximum number of loaded point clouds waiting to be voxelized
+		unsigned	_writeQueueDepth;						//!< Maximum number of grids waiting to be exported
+
+		/**
+		*	@brief Default constructor.
+		*/
+		Settings() :
+			_format(PACKED_OCCUPANCY), _downscaleOverBudget(false), _incremental(true), _memoryBudget(0), _numReaders(std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u)), _numWriters(2), _readQueueDepth(4), _writeQueueDepth(4)
+		{
+		}
+	};
+
+	struct Timings
+	{
+		double		_read;									//!< Milliseconds spent loading point clouds, summed over reading threads
+		double		_voxelization;							//!< Milliseconds spent voxelizing
+		double		_export;								//!< Milliseconds spent exporting grids, summed over writing threads
+		double		_total;									//!< Wall-clock milliseconds of the whole run
+		size_t		_numScans;								//!< Voxelized scans
+		size_t		_numFailed;								//!< Scans whose grid could not be exported or recorded in the manifest
+	};
+
+protected:
+	const static unsigned				NUM_VOXELIZATION_THREADS;	//!< Threads which voxelize scans, i.e., the calling thread
+
+	struct ScanArena
+	{
+		std::unique_ptr<PointCloud>		_pointCloud;		//!< Buffers of loaded points
+	};
+
+	struct ScanTask
+	{
+		std::string						_path;				//!< Point cloud path, with no extension
+		ScanArena*						_arena;				//!< Buffers of the scan, owned by the pipeline
+		std::unique_ptr<RegularGrid>	_grid;				//!< Voxelized scan, null if it was not voxelized
+		bool							_keep;				//!< Last scan, kept for rendering purposes
+
+		/**
+		*	@brief Default constructor.
+		*/
+		ScanTask() : _arena(nullptr), _keep(false) {}
+	};
+
+protected:
+	Settings							_settings;			//!< Threads and queue depths
+
+	// Buffers
+	std::vector<std::unique_ptr<ScanArena>>	_arena;		//!< Enough arenas to fill every stage and queue, kept across runs
+	std::unique_ptr<BoundedQueue<ScanArena*>>	_freeArena;	//!< Exported arenas which can be reused by reading threads
+	std::vector<std::unique_ptr<RegularGrid>>	_freeGrid;	//!< Exported grids, reused from the back while their memory is likely cached
+	mutable std::mutex					_freeGridMutex;		//!< Grids are released by writing threads
+	LabelHistogram						_histogram;			//!< Votes of the CPU compute backend, kept across runs
+
+	// Stages communication
+	std::unique_ptr<BoundedQueue<ScanTask>>	_loadedQueue;		//!< Reading => voxelization
+	std::unique_ptr<BoundedQueue<ScanTask>>	_voxelizedQueue;	//!< Voxelization => exporting
+	std::atomic<size_t>					_nextScan;			//!< Next scan to be read
+	std::atomic<size_t>					_numFailed;			//!< Scans which could not be exported or recorded
+	BatchManifest*						_manifest;			//!< Record of exported scans, null if the run is not incremental
+
+	// Last scan
+	std::mutex							_lastScanMutex;		//!< Protects last scan, as it is returned by a writing thread
+	ScanTask							_lastScan;			//!< Scan which is returned to the caller
+
+	// Profiling
+	std::atomic<long long>				_readTime;			//!< Nanoseconds spent by reading threads
+	std::atomic<long long>				_voxelizationTime;	//!< Nanoseconds spent by the voxelization stage
+	std::atomic<long long>				_exportTime;		//!< Nanoseconds spent by writing threads
+	Timings								_timings;			//!< Breakdown of the last run
+
+protected:
+	/**
+	*	@brief Takes the last released grid, or a new one if the pool is empty, and resets it to the given bounds and resolution.
+	*/
+	std::unique_ptr<RegularGrid> acquireGrid(const AABB& aabb, const uvec3& subdivisions);
+
+	/**
+	*	@brief Exports the voxelized grids as they arrive. The manifest records the resolution of each exported grid, which is lower
+	*	than the requested one if it was downscaled to fit the memory budget.
+	*/
+	void exportScans(const std::string& outputFolder);
+
+	/**
+	*	@brief Checks the projected footprint of a scan against the memory budget, on top of the memory already held by the pipeline.
+	*	The next pooled grid and the histogram are reused, hence they only count as far as they need to grow.
+	*	@param subdivisions Requested resolution, which is halved until it fits if downscaling is enabled.
+	*	@return False if the scan must be skipped.
+	*/
+	bool fitMemoryBudget(ScanArena* arena, uvec3& subdivisions) const;
+
+	/**
+	*	@return Extension appended to exported grids according to the selected format.
+	*/
+	std::string getOutputExtension() const;
+
+	/**
+	*	@return Name of the exported grid, with no extension.
+	*/
+	static std::string getOutputName(const std::string& outputFolder, const std::string& path);
+
+	/**
+	*	@brief Discards those scans which are up to date according to the manifest, except for the last one, which is returned by run.
+	*/
+	std::vector<std::string> getPendingScans(const std::vector<std::string>& pointCloudPath, const std::string& outputFolder, const uvec3& subdivisions);
+
+	/**
+	*	@brief Loads point clouds until every scan has been read.
+	*/
+	void readScans(const std::vector<std::string>& pointCloudPath);
+
+	/**
+	*	@brief Returns an exported grid to the pool, or releases it if the pool is full.
+	*/
+	void releaseGrid(std::unique_ptr<RegularGrid>&& grid);
+
+	/**
+	*	@brief Voxelizes as many scans as contained in the input list. With the GPU compute backend, it must be called from the thread which owns the OpenGL context.
+	*/
+	void voxelizeScans(const size_t numScans, const uvec3& subdivisions);
+
+public:
+	/**
+	*	@brief Constructor.
+	*/
+	VoxelizationPipeline(const Settings& settings = Settings());
+
+	/**
+	*	@brief Invalid copy constructor.
+	*/
+	VoxelizationPipeline(const VoxelizationPipeline& pipeline) = delete;
+
+	/**
+	*	@brief Destructor.
+	*/
+	virtual ~VoxelizationPipeline();
+
+	/**
+	*	@return Time spent by each stage during the last run.
+	*/
+	Timings getTimings() const { return _timings; }
+
+	/**
+	*	@brief Voxelizes every point cloud and exports its grid into the output folder. Returns only once every file has been written.
+	*	@param pointCloudPath Point clouds to be voxelized, with no extension.
+	*	@param pointCloud Last point cloud, whose ownership is transferred to the caller (null if there are no scans).
+	*	@param grid Grid of the last point cloud, whose ownership is transferred to the caller (null if there are no scans or it was skipped).
+	*/
+	void run(const std::vector<std::string>& pointCloudPath, const std::string& outputFolder, const uvec3& subdivisions, PointCloud*& pointCloud, RegularGrid*& grid);
+
+	/**
+	*	@brief Invalid assignment operator.
+	*/
+	VoxelizationPipeline& operator=(const VoxelizationPipeline& pipeline) = delete;
+};
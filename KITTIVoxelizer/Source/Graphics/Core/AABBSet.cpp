@@ -1,17 +1,29 @@
 #include "stdafx.h"
 #include "AABBSet.h"
 
-#include "DataStructures/RegularGrid.h"
+#include <emmintrin.h>
+#include "Graphics/Application/PerformanceMonitor.h"
+#include "Graphics/Application/Renderer.h"
 #include "Graphics/Core/OpenGLUtilities.h"
+#include "Utilities/Profiler.h"
+
+// Initialization of static attributes
+const unsigned AABBSet::CHUNK_SIZE = 32;
+const unsigned AABBSet::CHUNK_GROUP_SIZE = 64;
+const unsigned AABBSet::CULLING_BATCH_SIZE = 128;
+const float AABBSet::SLOT_GROWTH = 0.25f;
 
 // [Public methods]
 
-AABBSet::AABBSet() : Model3D(mat4(1.0f), 1), _numAABBs(0)
+AABBSet::AABBSet() :
+	Model3D(mat4(1.0f), 1), _numAABBs(0), _instanceMemory(MemoryTracker::INSTANCE_BUFFER), _numOccupiedChunks(0), _numSlots(0), _gridDivs(0), _cellBits(0), _packedInstances(false), _drawCommandBuffer(0), _culledMatrix(1.0f), _culled(false), _culledFrustum(false),
+	_numVisibleChunks(0)
 {
 }
 
 AABBSet::~AABBSet()
 {
+	if (_drawCommandBuffer) glDeleteBuffers(1, &_drawCommandBuffer);
 }
 
 bool AABBSet::load(const mat4& modelMatrix)
@@ -24,7 +36,11 @@ bool AABBSet::load(const mat4& modelMatrix)
 		vao->defineMultiInstancingVBO(RendEnum::VBO_OFFSET, vec3(), .0f, GL_FLOAT);
 		vao->defineMultiInstancingVBO(RendEnum::VBO_SCALE, vec3(), .0f, GL_FLOAT);
 		vao->defineMultiInstancingVBO(RendEnum::VBO_INDEX, float(), .0f, GL_FLOAT);
-		
+		vao->defineMultiInstancingIntegerVBO(RendEnum::VBO_PACKED_INSTANCE, uint32_t(), uint32_t(), GL_UNSIGNED_INT);
+		vao->enableVBO(RendEnum::VBO_PACKED_INSTANCE, false);
+
+		glGenBuffers(1, &_drawCommandBuffer);
+
 		_loaded = true;
 	}
 
@@ -33,32 +49,40 @@ bool AABBSet::load(const mat4& modelMatrix)
 
 void AABBSet::homogenize()
 {
-	std::vector<float> colorIndex(_numAABBs);
+	// A tracked grid is not modified, hence its labels are uploaded again once its bricks are updated
+	if (_packedInstances)
+	{
+		const uint32_t cellMask = uint32_t((uint64_t(1) << _cellBits) - 1);
 
-	for (int idx = 0; idx < _numAABBs; ++idx)
+		std::for_each(std::execution::par_unseq, _instanceCode.begin(), _instanceCode.end(), [&](uint32_t& code) { code = (code & cellMask) | (uint32_t(VOXEL_FREE) << _cellBits); });
+		if (_numSlots) _modelComp[0]->_vao->setVBOSubData(RendEnum::VBO_PACKED_INSTANCE, _instanceCode.data(), 0, _numSlots);
+	}
+	else
 	{
-		colorIndex[idx] = VOXEL_FREE;
+		std::fill(_instanceIndex.begin(), _instanceIndex.end(), float(VOXEL_FREE));
+		if (_numSlots) _modelComp[0]->_vao->setVBOSubData(RendEnum::VBO_INDEX, _instanceIndex.data(), 0, _numSlots);
 	}
-
-	_modelComp[0]->_vao->setVBOData(RendEnum::VBO_INDEX, colorIndex);
 }
 
 void AABBSet::load(std::vector<AABB>& aabbs)
 {
-	// Multi-instancing VBOs
-	std::vector<vec3> offset, scale;
-	VAO* vao = _modelComp[0]->_vao;
+	this->buildChunks(aabbs);
+
+	// Multi-instancing VBOs, sorted by chunk
+	_instanceOffset.resize(aabbs.size());
+	_instanceScale.resize(aabbs.size());
+	_instanceIndex.assign(aabbs.size(), .0f);
 
-	for (AABB& aabb : aabbs)
+	for (size_t instanceIdx = 0; instanceIdx < aabbs.size(); ++instanceIdx)
 	{
-		offset.push_back(aabb.center());
-		scale.push_back(aabb.extent() * 2.0f);
-	}
+		const AABB& aabb = aabbs[_instanceOrder[instanceIdx]];
 
-	vao->setVBOData(RendEnum::VBO_OFFSET, offset);
-	vao->setVBOData(RendEnum::VBO_SCALE, scale);
+		_instanceOffset[instanceIdx] = aabb.center();
+		_instanceScale[instanceIdx] = aabb.extent() * 2.0f;
+	}
 
-	_numAABBs = aabbs.size();
+	_numAABBs = _numSlots = unsigned(aabbs.size());
+	this->uploadInstances();
 }
 
 void AABBSet::setColorIndex(uint16_t* colorBuffer, unsigned size)
@@ -72,12 +96,474 @@ void AABBSet::setColorIndex(uint16_t* colorBuffer, unsigned size)
 			colorIndex.push_back(colorBuffer[idx]);
 		}
 	}
-	
-	_modelComp[0]->_vao->setVBOData(RendEnum::VBO_INDEX, colorIndex);
+
+	// Occupied voxels follow the order of RegularGrid::getAABBs, whereas instances are sorted by chunk
+	if (colorIndex.size() != _instanceOrder.size()) return;
+
+	for (size_t instanceIdx = 0; instanceIdx < colorIndex.size(); ++instanceIdx) _instanceIndex[instanceIdx] = colorIndex[_instanceOrder[instanceIdx]];
+
+	_modelComp[0]->_vao->setVBOData(RendEnum::VBO_INDEX, _instanceIndex);
+}
+
+void AABBSet::update(RegularGrid* grid)
+{
+	PROFILE_ZONE("AABBSet::update");
+
+	const AABB aabb = grid->getAABB();
+	const uvec3 numDivs = grid->getNumSubdivisions();
+	const vec3 cellSize = (aabb.max() - aabb.min()) / vec3(numDivs);
+	std::vector<unsigned> brick;
+
+	// Bricks of another grid do not match the current chunks. Fragmented slots are also packed again by extracting every brick
+	bool rebuild = numDivs != _gridDivs || aabb.min() != _gridAABB.min() || aabb.max() != _gridAABB.max() || _slotAllocator.getNumFreeSlots() > _slotAllocator.size() / 2;
+
+	if (rebuild)
+	{
+		this->buildGridChunks(grid, true, brick);
+	}
+	else
+	{
+		grid->getDirtyBricks(brick);
+
+		// Bricks are handled in chunk order, so that consecutive chunks take consecutive slots once every brick is extracted
+		std::sort(brick.begin(), brick.end(), [&](unsigned brick01, unsigned brick02) { return _brickChunk[brick01] < _brickChunk[brick02]; });
+	}
+
+	grid->clearDirtyBricks();
+	if (brick.empty() && !rebuild) return;
+
+	std::vector<BrickInstances> instances;
+
+	// Packed instances can no longer hold the labels of the grid, hence they are stored apart from now on
+	if (!this->extractBricks(grid, brick, instances))
+	{
+		this->buildGridChunks(grid, false, brick);
+		this->extractBricks(grid, brick, instances);
+		rebuild = true;
+	}
+
+	// Slots are only reassigned to chunks which outgrow their range, or become empty
+	std::vector<std::pair<unsigned, unsigned>> uploadRange;
+	std::vector<unsigned> modifiedGroup;
+
+	for (unsigned idx = 0; idx < brick.size(); ++idx)
+	{
+		if (!instances[idx]._modified) continue;
+
+		const unsigned chunk = _brickChunk[brick[idx]], numInstances = instances[idx].size();
+
+		if (numInstances > _chunkNumSlots[chunk] || !numInstances)
+		{
+			// Chunks which grow are likely to keep growing, e.g. while being edited, hence some spare slots are reserved
+			const unsigned numSlots = _chunkNumSlots[chunk] ? numInstances + unsigned(numInstances * SLOT_GROWTH) : numInstances;
+
+			_slotAllocator.release(_chunkFirstInstance[chunk], _chunkNumSlots[chunk]);
+			_chunkFirstInstance[chunk] = numSlots ? _slotAllocator.allocate(numSlots) : 0;
+			_chunkNumSlots[chunk] = numSlots;
+
+			if (_slotAllocator.size() > (_packedInstances ? _instanceCode.size() : _instanceOffset.size())) this->resizeInstances(_slotAllocator.size());
+		}
+
+		const unsigned firstInstance = _chunkFirstInstance[chunk];
+
+		if (_packedInstances)
+		{
+			std::copy(instances[idx]._code.begin(), instances[idx]._code.end(), _instanceCode.begin() + firstInstance);
+		}
+		else
+		{
+			std::copy(instances[idx]._offset.begin(), instances[idx]._offset.end(), _instanceOffset.begin() + firstInstance);
+			std::copy(instances[idx]._index.begin(), instances[idx]._index.end(), _instanceIndex.begin() + firstInstance);
+			std::fill(_instanceScale.begin() + firstInstance, _instanceScale.begin() + firstInstance + numInstances, cellSize);
+		}
+
+		_numAABBs = _numAABBs - _chunkNumInstances[chunk] + numInstances;
+		_chunkNumInstances[chunk] = numInstances;
+
+		if (numInstances) uploadRange.push_back(std::make_pair(firstInstance, numInstances));
+		if (modifiedGroup.empty() || modifiedGroup.back() != chunk / CHUNK_GROUP_SIZE) modifiedGroup.push_back(chunk / CHUNK_GROUP_SIZE);
+	}
+
+	if (modifiedGroup.empty() && !rebuild) return;
+
+	std::for_each(std::execution::par_unseq, modifiedGroup.begin(), modifiedGroup.end(), [&](unsigned group) { this->updateGroupBounds(group); });
+
+	_numOccupiedChunks = unsigned(std::count_if(_chunkNumInstances.begin(), _chunkNumInstances.end(), [](unsigned numInstances) { return numInstances > 0; }));
+	_culled = false;
+
+	if (rebuild || _slotAllocator.size() > _numSlots)
+	{
+		// Buffers are reallocated with room to spare, unless every brick was extracted
+		_numSlots = rebuild ? _slotAllocator.size() : std::max(_slotAllocator.size(), _numSlots + _numSlots / 2);
+
+		this->resizeInstances(_numSlots);
+		this->uploadInstances();
+	}
+	else
+	{
+		PROFILE_ZONE("upload");
+
+		// Ranges of slots which follow each other are uploaded at once
+		VAO* vao = _modelComp[0]->_vao;
+		std::sort(uploadRange.begin(), uploadRange.end());
+
+		for (size_t rangeIdx = 0; rangeIdx < uploadRange.size(); )
+		{
+			const unsigned firstInstance = uploadRange[rangeIdx].first;
+			unsigned lastInstance = firstInstance + uploadRange[rangeIdx].second;
+
+			while (++rangeIdx < uploadRange.size() && uploadRange[rangeIdx].first == lastInstance) lastInstance += uploadRange[rangeIdx].second;
+
+			if (_packedInstances)
+			{
+				vao->setVBOSubData(RendEnum::VBO_PACKED_INSTANCE, _instanceCode.data() + firstInstance, firstInstance, lastInstance - firstInstance);
+			}
+			else
+			{
+				vao->setVBOSubData(RendEnum::VBO_OFFSET, _instanceOffset.data() + firstInstance, firstInstance, lastInstance - firstInstance);
+				vao->setVBOSubData(RendEnum::VBO_SCALE, _instanceScale.data() + firstInstance, firstInstance, lastInstance - firstInstance);
+				vao->setVBOSubData(RendEnum::VBO_INDEX, _instanceIndex.data() + firstInstance, firstInstance, lastInstance - firstInstance);
+			}
+		}
+	}
 }
 
 // [Protected methods]
 
+void AABBSet::buildChunks(const std::vector<AABB>& aabbs)
+{
+	PROFILE_ZONE("AABBSet::buildChunks");
+
+	// Instances no longer come from a grid
+	_instanceOrder.clear();
+	_brickChunk.clear();
+	_slotAllocator.clear();
+	_gridDivs = uvec3(0);
+	_packedInstances = false;
+	std::vector<uint32_t>().swap(_instanceCode);
+
+	if (aabbs.empty())
+	{
+		this->resizeChunks(0);
+		return;
+	}
+
+	// Voxels share their size, hence chunks are laid out from the lowest corner with the size of the first voxel
+	vec3 minPoint = aabbs[0].min();
+	for (const AABB& aabb : aabbs) minPoint = glm::min(minPoint, aabb.min());
+
+	const vec3 chunkSize = glm::max(aabbs[0].extent() * 2.0f * float(CHUNK_SIZE), vec3(FLT_EPSILON));
+
+	std::vector<std::pair<uint64_t, unsigned>> key(aabbs.size());
+	std::vector<unsigned> instanceIdx(aabbs.size());
+	std::iota(instanceIdx.begin(), instanceIdx.end(), 0);
+
+	std::for_each(std::execution::par_unseq, instanceIdx.begin(), instanceIdx.end(), [&](unsigned idx)
+		{
+			key[idx] = std::make_pair(getMortonCode(uvec3((aabbs[idx].center() - minPoint) / chunkSize)), idx);
+		});
+
+	std::sort(std::execution::par_unseq, key.begin(), key.end());
+
+	std::vector<unsigned> chunkStart;
+	_instanceOrder.resize(aabbs.size());
+
+	for (size_t idx = 0; idx < key.size(); ++idx)
+	{
+		_instanceOrder[idx] = key[idx].second;
+		if (!idx || key[idx].first != key[idx - 1].first) chunkStart.push_back(unsigned(idx));
+	}
+	chunkStart.push_back(unsigned(aabbs.size()));
+
+	// Chunks are packed, as they are never updated
+	const unsigned numChunks = unsigned(chunkStart.size() - 1), numGroups = (numChunks + CHUNK_GROUP_SIZE - 1) / CHUNK_GROUP_SIZE;
+	this->resizeChunks(numChunks);
+
+	for (unsigned chunk = 0; chunk < numChunks; ++chunk)
+	{
+		_chunkFirstInstance[chunk] = chunkStart[chunk];
+		_chunkNumInstances[chunk] = _chunkNumSlots[chunk] = chunkStart[chunk + 1] - chunkStart[chunk];
+	}
+	_numOccupiedChunks = numChunks;
+
+	// Bounds are tight, as chunks on the border of the scene may be partially occupied
+	std::vector<unsigned> groupIdx(numGroups);
+	std::iota(groupIdx.begin(), groupIdx.end(), 0);
+
+	std::for_each(std::execution::par_unseq, groupIdx.begin(), groupIdx.end(), [&](unsigned group)
+		{
+			const unsigned firstChunk = group * CHUNK_GROUP_SIZE, lastChunk = std::min(firstChunk + CHUNK_GROUP_SIZE, numChunks);
+
+			for (unsigned chunk = firstChunk; chunk < lastChunk; ++chunk)
+			{
+				vec3 chunkMin(FLT_MAX), chunkMax(-FLT_MAX);
+
+				for (unsigned idx = chunkStart[chunk]; idx < chunkStart[chunk + 1]; ++idx)
+				{
+					chunkMin = glm::min(chunkMin, aabbs[_instanceOrder[idx]].min());
+					chunkMax = glm::max(chunkMax, aabbs[_instanceOrder[idx]].max());
+				}
+
+				this->setChunkBounds(chunk, chunkMin, chunkMax);
+			}
+
+			this->updateGroupBounds(group);
+		});
+}
+
+void AABBSet::buildGridChunks(RegularGrid* grid, bool allowPacking, std::vector<unsigned>& brick)
+{
+	const uvec3 numBricks = grid->getNumBricks();
+	const unsigned numChunks = numBricks.x * numBricks.y * numBricks.z;
+
+	// Every brick is a chunk, even if empty, so that chunks do not move as bricks are filled
+	std::vector<std::pair<uint64_t, unsigned>> key(numChunks);
+	std::vector<unsigned> brickIdx(numChunks);
+	std::iota(brickIdx.begin(), brickIdx.end(), 0);
+
+	std::for_each(std::execution::par_unseq, brickIdx.begin(), brickIdx.end(), [&](unsigned idx)
+		{
+			key[idx] = std::make_pair(getMortonCode(uvec3(idx / (numBricks.y * numBricks.z), (idx / numBricks.z) % numBricks.y, idx % numBricks.z)), idx);
+		});
+
+	std::sort(std::execution::par_unseq, key.begin(), key.end());
+
+	_brickChunk.resize(numChunks);
+	brick.resize(numChunks);
+
+	for (unsigned chunk = 0; chunk < numChunks; ++chunk)
+	{
+		_brickChunk[key[chunk].second] = chunk;
+		brick[chunk] = key[chunk].second;
+	}
+
+	this->resizeChunks(numChunks);
+
+	_instanceOrder.clear();
+	_slotAllocator.clear();
+	_numAABBs = 0;
+	_gridAABB = grid->getAABB();
+	_gridDivs = grid->getNumSubdivisions();
+
+	// The cell index takes the lowest bits of packed instances, and labels must fit in the remaining ones
+	const size_t numCells = grid->length();
+	uint16_t maxLabel = 0;
+
+	_cellBits = 0;
+	while ((size_t(1) << _cellBits) < numCells) ++_cellBits;
+
+	if (allowPacking && _cellBits < 32 && numCells)
+		maxLabel = *std::max_element(std::execution::par_unseq, grid->data(), grid->data() + numCells);
+
+	_packedInstances = allowPacking && _cellBits < 32 && uint64_t(maxLabel) < (uint64_t(1) << (32 - _cellBits));
+
+	// Buffers which are not used by the chosen encoding are released
+	if (_packedInstances)
+	{
+		std::vector<vec3>().swap(_instanceOffset);
+		std::vector<vec3>().swap(_instanceScale);
+		std::vector<float>().swap(_instanceIndex);
+	}
+	else
+	{
+		std::vector<uint32_t>().swap(_instanceCode);
+	}
+}
+
+void AABBSet::cullChunks(const mat4& viewProjection)
+{
+	PROFILE_ZONE("AABBSet::cullChunks");
+
+	// Planes are combinations of the rows of the matrix (Gribb & Hartmann), whereas GLM stores columns. Normals point to the inside
+	vec4 row[4];
+	for (int rowIdx = 0; rowIdx < 4; ++rowIdx) row[rowIdx] = vec4(viewProjection[0][rowIdx], viewProjection[1][rowIdx], viewProjection[2][rowIdx], viewProjection[3][rowIdx]);
+
+	const vec4 plane[6] = { row[3] + row[0], row[3] - row[0], row[3] + row[1], row[3] - row[1], row[3] + row[2], row[3] - row[2] };
+	__m128 planeCoefficient[6][7];
+
+	for (int planeIdx = 0; planeIdx < 6; ++planeIdx)
+	{
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			planeCoefficient[planeIdx][axis] = _mm_set1_ps(plane[planeIdx][axis]);
+			planeCoefficient[planeIdx][axis + 3] = _mm_set1_ps(std::abs(plane[planeIdx][axis]));
+		}
+
+		planeCoefficient[planeIdx][6] = _mm_set1_ps(plane[planeIdx].w);
+	}
+
+	// Four boxes are tested at once. A box intersects the frustum unless the corner which lies furthest along the normal of a plane is behind it,
+	// and it is inside the frustum if the nearest corner is in front of every plane
+	auto classify = [&planeCoefficient](const std::vector<float>* bounds, unsigned firstBox, int& intersectMask, int& insideMask)
+	{
+		__m128 center[3], halfSize[3];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			center[axis] = _mm_loadu_ps(&bounds[axis][firstBox]);
+			halfSize[axis] = _mm_loadu_ps(&bounds[axis + 3][firstBox]);
+		}
+
+		__m128 intersect = _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps()), inside = intersect;
+
+		for (int planeIdx = 0; planeIdx < 6; ++planeIdx)
+		{
+			__m128 distance = planeCoefficient[planeIdx][6], radius = _mm_setzero_ps();
+
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				distance = _mm_add_ps(distance, _mm_mul_ps(planeCoefficient[planeIdx][axis], center[axis]));
+				radius = _mm_add_ps(radius, _mm_mul_ps(planeCoefficient[planeIdx][axis + 3], halfSize[axis]));
+			}
+
+			intersect = _mm_and_ps(intersect, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_sub_ps(distance, radius), _mm_setzero_ps()));
+		}
+
+		intersectMask = _mm_movemask_ps(intersect);
+		insideMask = _mm_movemask_ps(inside);
+	};
+
+	const unsigned numChunks = unsigned(_chunkVisible.size()), numGroups = unsigned(_groupState.size());
+	const unsigned numBatches = (numGroups + CULLING_BATCH_SIZE - 1) / CULLING_BATCH_SIZE;
+	std::vector<unsigned> batchIdx(numBatches);
+	std::iota(batchIdx.begin(), batchIdx.end(), 0);
+
+	std::for_each(std::execution::par_unseq, batchIdx.begin(), batchIdx.end(), [&](unsigned batch)
+		{
+			const unsigned firstGroup = batch * CULLING_BATCH_SIZE, lastGroup = std::min(firstGroup + CULLING_BATCH_SIZE, numGroups);
+			int intersectMask, insideMask;
+
+			for (unsigned group = firstGroup; group < lastGroup; group += 4)
+			{
+				classify(_groupBounds, group, intersectMask, insideMask);
+
+				for (unsigned lane = 0; lane < 4 && group + lane < lastGroup; ++lane)
+				{
+					_groupState[group + lane] = (insideMask >> lane) & 1 ? INSIDE : ((intersectMask >> lane) & 1 ? INTERSECTING : OUTSIDE);
+					if (_groupState[group + lane] != INTERSECTING) continue;
+
+					const unsigned firstChunk = (group + lane) * CHUNK_GROUP_SIZE, lastChunk = std::min(firstChunk + CHUNK_GROUP_SIZE, numChunks);
+					int chunkIntersectMask, chunkInsideMask;
+
+					for (unsigned chunk = firstChunk; chunk < lastChunk; chunk += 4)
+					{
+						classify(_chunkBounds, chunk, chunkIntersectMask, chunkInsideMask);
+						for (unsigned chunkLane = 0; chunkLane < 4 && chunk + chunkLane < lastChunk; ++chunkLane) _chunkVisible[chunk + chunkLane] = (chunkIntersectMask >> chunkLane) & 1;
+					}
+				}
+			}
+		});
+}
+
+void AABBSet::drawVisibleChunks(const std::vector<mat4>& matrix, const GLuint primitive)
+{
+	// Several passes share the camera, e.g. one per light, so that culling is only repeated once the transformation changes
+	const bool cullFrustum = Renderer::getInstance()->getRenderingParameters()->_cullVoxelChunks;
+	const mat4 viewProjection = matrix[RendEnum::VIEW_PROJ_MATRIX] * matrix[RendEnum::MODEL_MATRIX];
+
+	if (!_culled || cullFrustum != _culledFrustum || (cullFrustum && viewProjection != _culledMatrix))
+	{
+		// Chunks are still drawn through their ranges without culling, as slots between them may be free
+		if (cullFrustum)	this->cullChunks(viewProjection);
+		else				std::fill(_groupState.begin(), _groupState.end(), INSIDE);
+
+		this->updateDrawCommands();
+
+		_culledMatrix = viewProjection;
+		_culledFrustum = cullFrustum;
+		_culled = true;
+	}
+
+	if (!_drawCommand.empty()) _modelComp[0]->_vao->drawObjectIndirect(RendEnum::IBO_TRIANGLE_MESH, primitive, _drawCommandBuffer, GLuint(_drawCommand.size()));
+}
+
+bool AABBSet::extractBricks(RegularGrid* grid, const std::vector<unsigned>& brick, std::vector<BrickInstances>& instances)
+{
+	PROFILE_ZONE("AABBSet::extractBricks");
+
+	const AABB aabb = grid->getAABB();
+	const uvec3 numDivs = grid->getNumSubdivisions(), numBricks = grid->getNumBricks();
+	const vec3 aabbMin = aabb.min(), cellSize = (aabb.max() - aabb.min()) / vec3(numDivs);
+	const uint64_t maxLabel = _packedInstances ? (uint64_t(1) << (32 - _cellBits)) - 1 : UINT16_MAX;
+	const uint16_t* voxels = grid->data();
+	std::atomic<bool> labelOverflow(false);
+
+	std::vector<unsigned> brickIdx(brick.size());
+	std::iota(brickIdx.begin(), brickIdx.end(), 0);
+
+	instances.clear();
+	instances.resize(brick.size());
+
+	std::for_each(std::execution::par, brickIdx.begin(), brickIdx.end(), [&](unsigned idx)
+		{
+			const unsigned chunk = _brickChunk[brick[idx]];
+			const uvec3 brickCoord(brick[idx] / (numBricks.y * numBricks.z), (brick[idx] / numBricks.z) % numBricks.y, brick[idx] % numBricks.z);
+			const uvec3 minVoxel = brickCoord * RegularGrid::BRICK_SIZE, maxVoxel = glm::min(minVoxel + uvec3(RegularGrid::BRICK_SIZE), numDivs);
+			BrickInstances& brickInstances = instances[idx];
+			uvec3 minCell(UINT_MAX), maxCell(0);
+
+			for (unsigned x = minVoxel.x; x < maxVoxel.x; ++x)
+			{
+				for (unsigned y = minVoxel.y; y < maxVoxel.y; ++y)
+				{
+					const unsigned rowIndex = RegularGrid::getPositionIndex(x, y, 0, numDivs);
+					const uint16_t* row = voxels + rowIndex;
+
+					for (unsigned z = minVoxel.z; z < maxVoxel.z; ++z)
+					{
+						if (row[z] == VOXEL_EMPTY) continue;
+
+						if (row[z] > maxLabel)
+						{
+							labelOverflow = true;
+							return;
+						}
+
+						if (_packedInstances)
+						{
+							brickInstances._code.push_back((rowIndex + z) | (uint32_t(row[z]) << _cellBits));
+						}
+						else
+						{
+							brickInstances._offset.push_back(aabbMin + cellSize * (vec3(x, y, z) + .5f));
+							brickInstances._index.push_back(row[z]);
+						}
+
+						minCell = glm::min(minCell, uvec3(x, y, z));
+						maxCell = glm::max(maxCell, uvec3(x, y, z));
+					}
+				}
+			}
+
+			// Bricks flagged by bulk operations may hold the same voxels as before, in which case nothing is uploaded
+			const unsigned numInstances = brickInstances.size(), firstInstance = _chunkFirstInstance[chunk];
+
+			if (numInstances != _chunkNumInstances[chunk])
+				brickInstances._modified = true;
+			else if (_packedInstances)
+				brickInstances._modified = !std::equal(brickInstances._code.begin(), brickInstances._code.end(), _instanceCode.begin() + firstInstance);
+			else
+				brickInstances._modified = !std::equal(brickInstances._offset.begin(), brickInstances._offset.end(), _instanceOffset.begin() + firstInstance) ||
+										   !std::equal(brickInstances._index.begin(), brickInstances._index.end(), _instanceIndex.begin() + firstInstance);
+
+			if (brickInstances._modified && numInstances) this->setChunkBounds(chunk, aabbMin + cellSize * vec3(minCell), aabbMin + cellSize * vec3(maxCell + 1u));
+		});
+
+	return !labelOverflow;
+}
+
+uint64_t AABBSet::getMortonCode(const uvec3& chunk)
+{
+	uint64_t code = 0;
+
+	for (unsigned bit = 0; bit < 21; ++bit)
+	{
+		for (int axis = 0; axis < 3; ++axis) code |= uint64_t((chunk[axis] >> bit) & 1) << (bit * 3 + axis);
+	}
+
+	return code;
+}
+
 void AABBSet::renderTriangles(RenderingShader* shader, const RendEnum::RendShaderTypes shaderType, std::vector<mat4>& matrix, ModelComponent* modelComp, const GLuint primitive)
 {
 	VAO* vao = modelComp->_vao;
@@ -85,11 +571,13 @@ void AABBSet::renderTriangles(RenderingShader* shader, const RendEnum::RendShade
 
 	if (vao && _numAABBs && modelComp->_enabled)
 	{
+		PerformanceMonitor::ScopedPass voxelPass(PerformanceMonitor::VOXEL_DRAW_PASS);
 		this->setShaderUniforms(shader, shaderType, matrix);
+		this->setInstanceUniforms(shader);
 
 		if (material) material->applyMaterial(shader);
 
-		vao->drawObject(RendEnum::IBO_TRIANGLE_MESH, primitive, 64, _numAABBs);
+		this->drawVisibleChunks(matrix, primitive);
 	}
 }
 
@@ -99,8 +587,151 @@ void AABBSet::renderTriangles4Shadows(RenderingShader* shader, const RendEnum::R
 
 	if (vao && _numAABBs && modelComp->_enabled)
 	{
+		PerformanceMonitor::ScopedPass voxelPass(PerformanceMonitor::VOXEL_DRAW_PASS);
 		this->setShaderUniforms(shader, shaderType, matrix);
+		this->setInstanceUniforms(shader);
+
+		this->drawVisibleChunks(matrix, primitive);
+	}
+}
+
+void AABBSet::resizeChunks(unsigned numChunks)
+{
+	const unsigned numGroups = (numChunks + CHUNK_GROUP_SIZE - 1) / CHUNK_GROUP_SIZE;
+
+	// Padding boxes are never read back
+	for (int boundIdx = 0; boundIdx < 6; ++boundIdx)
+	{
+		_chunkBounds[boundIdx].assign((numChunks + 3) / 4 * 4, .0f);
+		_groupBounds[boundIdx].assign((numGroups + 3) / 4 * 4, .0f);
+	}
+
+	_chunkFirstInstance.assign(numChunks, 0);
+	_chunkNumInstances.assign(numChunks, 0);
+	_chunkNumSlots.assign(numChunks, 0);
+	_chunkVisible.assign(numChunks, 0);
+	_groupState.assign(numGroups, OUTSIDE);
+	_drawCommand.clear();
+	_culled = false;
+	_numOccupiedChunks = _numVisibleChunks = 0;
+}
+
+void AABBSet::resizeInstances(unsigned numSlots)
+{
+	if (_packedInstances)
+	{
+		_instanceCode.resize(numSlots);
+	}
+	else
+	{
+		_instanceOffset.resize(numSlots);
+		_instanceScale.resize(numSlots);
+		_instanceIndex.resize(numSlots);
+	}
+}
+
+void AABBSet::setChunkBounds(unsigned chunk, const vec3& minPoint, const vec3& maxPoint)
+{
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		_chunkBounds[axis][chunk] = (minPoint[axis] + maxPoint[axis]) / 2.0f;
+		_chunkBounds[axis + 3][chunk] = (maxPoint[axis] - minPoint[axis]) / 2.0f;
+	}
+}
+
+void AABBSet::setInstanceUniforms(RenderingShader* shader)
+{
+	shader->setUniform("packedInstances", GLint(_packedInstances));
 
-		vao->drawObject(RendEnum::IBO_TRIANGLE_MESH, primitive, 64, _numAABBs);
+	if (_packedInstances)
+	{
+		shader->setUniform("cellBits", GLuint(_cellBits));
+		shader->setUniform("cellSize", (_gridAABB.max() - _gridAABB.min()) / vec3(_gridDivs));
+		shader->setUniform("gridDims", _gridDivs);
+		shader->setUniform("gridOrigin", _gridAABB.min());
 	}
-}
\ No newline at end of file
+}
+
+void AABBSet::updateDrawCommands()
+{
+	// Visible chunks whose slots follow each other are merged into a single range of instances
+	const unsigned numChunks = unsigned(_chunkVisible.size()), numGroups = unsigned(_groupState.size());
+
+	_drawCommand.clear();
+	_numVisibleChunks = 0;
+
+	auto drawChunk = [&](unsigned chunk)
+	{
+		const unsigned firstInstance = _chunkFirstInstance[chunk], numInstances = _chunkNumInstances[chunk];
+		if (!numInstances) return;
+
+		if (!_drawCommand.empty() && _drawCommand.back()._baseInstance + _drawCommand.back()._numInstances == firstInstance)
+			_drawCommand.back()._numInstances += numInstances;
+		else
+			_drawCommand.push_back(DrawCommand{ 64, numInstances, 0, 0, firstInstance });
+
+		++_numVisibleChunks;
+	};
+
+	for (unsigned group = 0; group < numGroups; ++group)
+	{
+		const unsigned firstChunk = group * CHUNK_GROUP_SIZE, lastChunk = std::min(firstChunk + CHUNK_GROUP_SIZE, numChunks);
+		if (_groupState[group] == OUTSIDE) continue;
+
+		for (unsigned chunk = firstChunk; chunk < lastChunk; ++chunk)
+		{
+			if (_groupState[group] == INSIDE || _chunkVisible[chunk]) drawChunk(chunk);
+		}
+	}
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _drawCommandBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, _drawCommand.size() * sizeof(DrawCommand), _drawCommand.data(), GL_STREAM_DRAW);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void AABBSet::updateGroupBounds(unsigned group)
+{
+	const unsigned numChunks = unsigned(_chunkVisible.size()), firstChunk = group * CHUNK_GROUP_SIZE, lastChunk = std::min(firstChunk + CHUNK_GROUP_SIZE, numChunks);
+	vec3 groupMin(FLT_MAX), groupMax(-FLT_MAX);
+
+	for (unsigned chunk = firstChunk; chunk < lastChunk; ++chunk)
+	{
+		if (!_chunkNumInstances[chunk]) continue;
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			groupMin[axis] = std::min(groupMin[axis], _chunkBounds[axis][chunk] - _chunkBounds[axis + 3][chunk]);
+			groupMax[axis] = std::max(groupMax[axis], _chunkBounds[axis][chunk] + _chunkBounds[axis + 3][chunk]);
+		}
+	}
+
+	// Groups of empty chunks are never drawn, whatever their bounds
+	if (groupMin.x > groupMax.x) groupMin = groupMax = vec3(.0f);
+
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		_groupBounds[axis][group] = (groupMin[axis] + groupMax[axis]) / 2.0f;
+		_groupBounds[axis + 3][group] = (groupMax[axis] - groupMin[axis]) / 2.0f;
+	}
+}
+
+void AABBSet::uploadInstances()
+{
+	PROFILE_ZONE("AABBSet::uploadInstances");
+
+	VAO* vao = _modelComp[0]->_vao;
+	const GLuint changeFrequency = _gridDivs.x ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW;
+
+	const size_t instanceSize = _packedInstances ? sizeof(uint32_t) : sizeof(vec3) * 2 + sizeof(float);
+
+	// Copies of the encoding which is not in use are empty, hence their VBOs are released. Their inputs are also disabled, so that they are not read
+	vao->setVBOData(RendEnum::VBO_OFFSET, _instanceOffset, changeFrequency);
+	vao->setVBOData(RendEnum::VBO_SCALE, _instanceScale, changeFrequency);
+	vao->setVBOData(RendEnum::VBO_INDEX, _instanceIndex, changeFrequency);
+	vao->setVBOData(RendEnum::VBO_PACKED_INSTANCE, _instanceCode, changeFrequency);
+
+	for (const RendEnum::VBOTypes vboType : { RendEnum::VBO_OFFSET, RendEnum::VBO_SCALE, RendEnum::VBO_INDEX }) vao->enableVBO(vboType, !_packedInstances);
+	vao->enableVBO(RendEnum::VBO_PACKED_INSTANCE, _packedInstances);
+
+	_instanceMemory.resize(size_t(_numSlots) * instanceSize * 2);
+}
@@ -6,18 +6,167 @@
 *	@date 18/07/2021
 */
 
+#include "DataStructures/RegularGrid.h"
+#include "DataStructures/SlotAllocator.h"
 #include "Geometry/3D/AABB.h"
 #include "Graphics/Core/Model3D.h"
+#include "Utilities/MemoryTracker.h"
 
 /**
-*	@brief Set of bounding boxes to be rendered/processed.
+*	@brief Set of bounding boxes to be rendered/processed. Instances are sorted into spatial chunks, which are culled against the frustum
+*	of each draw call on CPU; visible chunks are then drawn with a single indirect call. Chunks follow a Morton order, so that consecutive
+*	chunks are bounded by groups which are culled first; hence, only chunks of groups crossing the frustum are tested one by one.
+*	Instances of a regular grid are kept up to date incrementally: each brick of the grid is a chunk with its own range of slots in the
+*	instance buffers, so that only the ranges of modified bricks are extracted and uploaded again. Moreover, each voxel of a grid is a single
+*	32-bit word, holding its cell index in the lowest bits and its label in the remaining ones, which the vertex shaders decode from the
+*	bounds of the grid; offset, scale and label are only stored apart for loose boxes and for grids whose labels do not fit in a word.
 */
 class AABBSet: public Model3D
 {
+public:
+	const static unsigned	CHUNK_SIZE;								//!< Voxels per axis of a chunk
+	const static unsigned	CHUNK_GROUP_SIZE;						//!< Consecutive chunks bounded together, multiple of 4
+	const static unsigned	CULLING_BATCH_SIZE;						//!< Chunk groups tested by each CPU task
+	const static float		SLOT_GROWTH;							//!< Spare slots reserved by a chunk which outgrows its range, relative to its instances
+
+protected:
+	enum CullingResult : uint8_t { OUTSIDE, INTERSECTING, INSIDE };
+
+	/**
+	*	@brief Layout of GL_DRAW_INDIRECT_BUFFER commands for indexed geometry.
+	*/
+	struct DrawCommand
+	{
+		GLuint		_numIndices;									//!< Indices of the cube
+		GLuint		_numInstances;									//!< Instances of consecutive visible chunks
+		GLuint		_firstIndex;									//!< First index of the cube
+		GLint		_baseVertex;									//!< Offset of vertices of the cube
+		GLuint		_baseInstance;									//!< First instance of the first visible chunk
+	};
+
+	/**
+	*	@brief Occupied voxels of a brick, encoded as in the instance buffers.
+	*/
+	struct BrickInstances
+	{
+		std::vector<uint32_t>	_code;								//!< Packed cell index and label of voxels, if instances are packed
+		std::vector<vec3>		_offset;							//!< Center of voxels, otherwise
+		std::vector<float>		_index;								//!< Label of voxels, otherwise
+		bool					_modified;							//!< Voxels differ from those stored in the slots of the chunk
+
+		/**
+		*	@return Number of voxels.
+		*/
+		unsigned size() const { return unsigned(std::max(_code.size(), _offset.size())); }
+	};
+
 protected:
 	unsigned _numAABBs;
+	MemoryTracker::Allocation _instanceMemory;						//!< Bytes of instance VBOs (packed words, or offset, scale and color index) and their CPU copy reported to the memory tracker
+
+	// Chunks
+	std::vector<float>			_chunkBounds[6];					//!< Center (XYZ) and half size (XYZ) of chunks, padded to a multiple of 4 chunks
+	std::vector<float>			_groupBounds[6];					//!< Center (XYZ) and half size (XYZ) of chunk groups, padded to a multiple of 4 groups
+	std::vector<uint8_t>		_groupState;						//!< Result of the last culling for each group
+	std::vector<unsigned>		_chunkFirstInstance;				//!< First slot of each chunk
+	std::vector<unsigned>		_chunkNumInstances;					//!< Instances of each chunk, stored from its first slot on
+	std::vector<unsigned>		_chunkNumSlots;						//!< Slots reserved by each chunk, at least as many as its instances
+	std::vector<unsigned>		_instanceOrder;						//!< Index in the loaded AABB array of each instance
+	std::vector<uint8_t>		_chunkVisible;						//!< Result of the last culling, only valid for intersecting groups
+	unsigned					_numOccupiedChunks;					//!< Chunks with at least one instance
+
+	// Instance slots
+	std::vector<vec3>			_instanceOffset;					//!< CPU copy of the offset VBO, so that it can be reallocated without reading it back
+	std::vector<vec3>			_instanceScale;						//!< CPU copy of the scale VBO
+	std::vector<float>			_instanceIndex;						//!< CPU copy of the color index VBO
+	std::vector<uint32_t>		_instanceCode;						//!< CPU copy of the packed instance VBO, which replaces the former ones for grids
+	SlotAllocator				_slotAllocator;						//!< Ranges of slots reserved by the chunks of a grid
+	unsigned					_numSlots;							//!< Slots allocated in GPU
+
+	// Tracked grid
+	std::vector<unsigned>		_brickChunk;						//!< Chunk of each brick of the tracked grid
+	AABB						_gridAABB;							//!< Bounding box of the tracked grid
+	uvec3						_gridDivs;							//!< Resolution of the tracked grid, zero if instances do not come from a grid
+	unsigned					_cellBits;							//!< Lowest bits of packed instances taken by the cell index
+	bool						_packedInstances;					//!< Instances of the tracked grid are stored as packed words
+
+	// Indirect drawing
+	std::vector<DrawCommand>	_drawCommand;						//!< Ranges of visible instances
+	GLuint						_drawCommandBuffer;					//!< GPU copy of _drawCommand
+	mat4						_culledMatrix;						//!< Transformation of the last culling, which is reused while it does not change
+	bool						_culled;							//!< Draw commands are valid for _culledMatrix
+	bool						_culledFrustum;						//!< Draw commands were computed with frustum culling
+	unsigned					_numVisibleChunks;					//!< Chunks which passed the last culling
 
 protected:
+	/**
+	*	@return Interleaved bits of the coordinates of a chunk, so that chunks close in space are also close in the instance buffers.
+	*/
+	static uint64_t getMortonCode(const uvec3& chunk);
+
+	/**
+	*	@brief Sorts instances into chunks of CHUNK_SIZE^3 voxels and computes the bounds of chunks and groups.
+	*/
+	void buildChunks(const std::vector<AABB>& aabbs);
+
+	/**
+	*	@brief Sorts the bricks of a grid into chunks, in the same order as buildChunks, and releases every slot. Instances are packed if
+	*	allowed and every label of the grid fits in the bits left by the cell index.
+	*	@param brick Every brick of the grid, in chunk order.
+	*/
+	void buildGridChunks(RegularGrid* grid, bool allowPacking, std::vector<unsigned>& brick);
+
+	/**
+	*	@brief Tests groups and then chunks against the frustum planes of a view-projection matrix, four boxes at a time with SSE.
+	*/
+	void cullChunks(const mat4& viewProjection);
+
+	/**
+	*	@brief Uploads a draw command per range of consecutive slots of visible chunks.
+	*/
+	void updateDrawCommands();
+
+	/**
+	*	@brief Collects the occupied voxels of some bricks of the tracked grid, in parallel, encoded as in the instance buffers.
+	*	@return False if instances are packed and a label does not fit in them.
+	*/
+	bool extractBricks(RegularGrid* grid, const std::vector<unsigned>& brick, std::vector<BrickInstances>& instances);
+
+	/**
+	*	@brief Draws the instances which passed the culling for the transformation of the given matrices.
+	*/
+	void drawVisibleChunks(const std::vector<mat4>& matrix, const GLuint primitive);
+
+	/**
+	*	@brief Allocates chunks and bounds for a number of chunks, which are left empty.
+	*/
+	void resizeChunks(unsigned numChunks);
+
+	/**
+	*	@brief Resizes the CPU copy of the instance buffers which are in use.
+	*/
+	void resizeInstances(unsigned numSlots);
+
+	/**
+	*	@brief Writes the bounds of a chunk. Empty chunks are given any bounds, as they are never drawn.
+	*/
+	void setChunkBounds(unsigned chunk, const vec3& minPoint, const vec3& maxPoint);
+
+	/**
+	*	@brief Communicates to the shader how instances are encoded, and the bounds of the tracked grid to decode packed instances.
+	*/
+	void setInstanceUniforms(RenderingShader* shader);
+
+	/**
+	*	@brief Computes the bounds of a group from those of its non-empty chunks.
+	*/
+	void updateGroupBounds(unsigned group);
+
+	/**
+	*	@brief Sends the whole CPU copy of instances to GPU, reallocating the VBOs.
+	*/
+	void uploadInstances();
+
 	/**
 	*	@brief Renders a component as a set of triangles.
 	*	@param modelComp Component where the VAO is located.
@@ -64,5 +213,29 @@ public:
 	*	@brief Setup VAO to integrate colors of each voxel.
 	*/
 	void setColorIndex(uint16_t* colorBuffer, unsigned siz);
+
+	/**
+	*	@brief Synchronizes instances with the occupied voxels of a grid. Only bricks flagged as modified by the grid are extracted, in
+	*	parallel, and only those whose voxels actually changed are uploaded, within the slots of their chunk if they still fit there;
+	*	otherwise, a new range is taken from the free list. Every brick is extracted again if the grid is not the one tracked so far,
+	*	or if too many slots are free. Modifications of the grid are cleared. Instances are stored apart, rather than packed, from the first
+	*	label which does not fit in a word until every brick is extracted again.
+	*/
+	void update(RegularGrid* grid);
+
+	/**
+	*	@return Number of rendered instances.
+	*/
+	unsigned getNumAABBs() const { return _numAABBs; }
+
+	/**
+	*	@return Number of chunks with at least one instance.
+	*/
+	unsigned getNumChunks() const { return _numOccupiedChunks; }
+
+	/**
+	*	@return Number of chunks which passed the last culling.
+	*/
+	unsigned getNumVisibleChunks() const { return _numVisibleChunks; }
 };
 
@@ -1,12 +1,15 @@
 #include "stdafx.h"
 #include "CADModel.h"
 
+#include <charconv>
 #include <filesystem>
 #include "Graphics/Application/MaterialList.h"
+#include "Graphics/Core/ComputeBackend.h"
 #include "Graphics/Core/ShaderList.h"
 #include "Graphics/Core/VAO.h"
 #include "Utilities/FileManagement.h"
 #include "Utilities/ChronoUtilities.h"
+#include "Utilities/Profiler.h"
 
 // Initialization of static attributes
 std::unordered_map<std::string, std::unique_ptr<Material>> CADModel::_cadMaterials;
@@ -26,8 +29,29 @@ CADModel::~CADModel()
 {
 }
 
+std::vector<unsigned> CADModel::getComponentLabels(const std::string& classFilename)
+{
+	std::map<std::string, std::string> keyMap;
+	std::string defaultClass;
+	std::vector<unsigned> label(_modelComp.size(), 0);
+
+	this->readClassFile(classFilename, keyMap, defaultClass);
+
+	for (size_t modelCompIdx = 0; modelCompIdx < _modelComp.size(); ++modelCompIdx)
+	{
+		std::string modelName = _modelComp[modelCompIdx]->_modelDescription._modelName;
+		const std::string modelClass = this->getKeyValue(keyMap, modelName, defaultClass);
+
+		std::from_chars(modelClass.data(), modelClass.data() + modelClass.size(), label[modelCompIdx]);
+	}
+
+	return label;
+}
+
 bool CADModel::load(const mat4& modelMatrix)
 {
+	PROFILE_ZONE("CADModel::load");
+
 	if (!_loaded)
 	{
 		bool success = false, binaryExists = false;
@@ -57,29 +81,7 @@ bool CADModel::load(const mat4& modelMatrix)
 
 void CADModel::computeMeshData(ModelComponent* modelComp)
 {
-	ComputeShader* shader = ShaderList::getInstance()->getComputeShader(RendEnum::MODEL_MESH_GENERATION);
-	const int arraySize = modelComp->_topology.size();
-	const int numGroups = ComputeShader::getNumGroups(arraySize);
-
-	GLuint modelBufferID, meshBufferID, outBufferID;
-	modelBufferID = ComputeShader::setReadBuffer(modelComp->_geometry);
-	meshBufferID = ComputeShader::setReadBuffer(modelComp->_topology);
-	outBufferID = ComputeShader::setWriteBuffer(GLuint(), arraySize * 4);
-
-	shader->bindBuffers(std::vector<GLuint> { modelBufferID, meshBufferID, outBufferID });
-	shader->use();
-	shader->setUniform("size", arraySize);
-	shader->setUniform("restartPrimitiveIndex", Model3D::RESTART_PRIMITIVE_INDEX);
-	shader->execute(numGroups, 1, 1, ComputeShader::getMaxGroupSize(), 1, 1);
-
-	FaceGPUData* faceData = shader->readData(meshBufferID, FaceGPUData());
-	GLuint* rawMeshData = shader->readData(outBufferID, GLuint());
-	modelComp->_topology = std::move(std::vector<FaceGPUData>(faceData, faceData + arraySize));
-	modelComp->_triangleMesh = std::move(std::vector<GLuint>(rawMeshData, rawMeshData + arraySize * 4));
-
-	glDeleteBuffers(1, &modelBufferID);
-	glDeleteBuffers(1, &meshBufferID);
-	glDeleteBuffers(1, &outBufferID);
+	ComputeBackend::getInstance()->computeMeshData(modelComp->_geometry, modelComp->_topology, modelComp->_triangleMesh);
 }
 
 Material* CADModel::createMaterial(ModelComponent* modelComp)
@@ -138,8 +140,8 @@ Material* CADModel::createMaterial(ModelComponent* modelComp)
 
 void CADModel::createModelComponent(objl::Mesh* mesh)
 {
-	const GLuint maxVertices	= ComputeShader::getMaxSSBOSize(sizeof(VertexGPUData)) / 3;
-	const GLuint maxFaces		= ComputeShader::getMaxSSBOSize(sizeof(FaceGPUData));
+	const GLuint maxVertices	= GLuint(ComputeBackend::getInstance()->getMaxBufferSize(sizeof(VertexGPUData)) / 3);
+	const GLuint maxFaces		= GLuint(ComputeBackend::getInstance()->getMaxBufferSize(sizeof(FaceGPUData)));
 	VertexGPUData vertexData;
 
 	// Defined number of splits of the mesh
@@ -216,28 +218,11 @@ void CADModel::createModelComponent(objl::Mesh* mesh)
 
 void CADModel::generateGeometryTopology(Model3D::ModelComponent* modelComp, const mat4& modelMatrix)
 {
-	ComputeShader* shader = ShaderList::getInstance()->getComputeShader(RendEnum::MODEL_APPLY_MODEL_MATRIX);
-	const int arraySize = modelComp->_geometry.size();
-	const int numGroups = ComputeShader::getNumGroups(arraySize);
-
-	GLuint modelBufferID;
-	modelBufferID = ComputeShader::setReadBuffer(modelComp->_geometry);
-
-	shader->bindBuffers(std::vector<GLuint> { modelBufferID});
-	shader->use();
-	shader->setUniform("mModel", modelMatrix * _modelMatrix);
-	shader->setUniform("size", arraySize);
-	if (modelComp->_material) modelComp->_material->applyMaterial4ComputeShader(shader);
-	shader->execute(numGroups, 1, 1, ComputeShader::getMaxGroupSize(), 1, 1);
-
-	VertexGPUData* data = shader->readData(modelBufferID, VertexGPUData());
-	modelComp->_geometry = std::move(std::vector<VertexGPUData>(data, data + arraySize));
+	ComputeBackend::getInstance()->applyModelMatrix(modelComp->_geometry, modelMatrix * _modelMatrix, modelComp->_material);
 
 	this->computeTangents(modelComp);
 	this->computeMeshData(modelComp);
 
-	glDeleteBuffers(1, &modelBufferID);
-
 	// Wireframe & point cloud are derived from previous operations
 	//modelComp->buildPointCloudTopology();
 	//modelComp->buildWireframeTopology();
@@ -42,7 +42,7 @@ protected:
 	void createModelComponent(objl::Mesh* mesh);
 
 	/**
-	*	@brief Generates geometry via GPU.
+	*	@brief Generates geometry with the selected compute backend.
 	*/
 	void generateGeometryTopology(Model3D::ModelComponent* modelComp, const mat4& modelMatrix);
 
@@ -96,6 +96,13 @@ public:
 	*/
 	virtual ~CADModel();
 
+	/**
+	*	@brief Semantic label of each model component according to a class file. Each line of such file is a class followed by the
+	*	keywords (separated by ';') which are searched in component names. A class with no keywords is the default one.
+	*	@return Labels indexed by component. Classes are expected to be numeric labels; any other class is translated to zero.
+	*/
+	std::vector<unsigned> getComponentLabels(const std::string& classFilename);
+
 	/**
 	*	@brief Loads the model data from file.
 	*	@return Success of operation.
@@ -0,0 +1,157 @@
+#include "stdafx.h"
+#include "CPUComputeBackend.h"
+
+#include "Utilities/Profiler.h"
+
+// Initialization of static attributes
+const size_t CPUComputeBackend::CHUNK_SIZE = 8192;
+const float CPUComputeBackend::TANGENT_FIXED_POINT_FACTOR = 1000.0f;
+
+/// [Public methods]
+
+void CPUComputeBackend::applyModelMatrix(std::vector<Model3D::VertexGPUData>& vertices, const mat4& modelMatrix, Material* material)
+{
+	parallelChunks(vertices.size(), [&](size_t firstIndex, size_t lastIndex)
+	{
+		for (size_t index = firstIndex; index < lastIndex; ++index)
+		{
+			vertices[index]._position = vec3(modelMatrix * vec4(vertices[index]._position, 1.0f));
+			vertices[index]._normal = vec3(modelMatrix * vec4(vertices[index]._normal, .0f));
+		}
+	});
+}
+
+void CPUComputeBackend::computeMeshData(const std::vector<Model3D::VertexGPUData>& vertices, std::vector<Model3D::FaceGPUData>& faces, std::vector<GLuint>& triangleMesh)
+{
+	triangleMesh.resize(faces.size() * 4);
+
+	parallelChunks(faces.size(), [&](size_t firstIndex, size_t lastIndex)
+	{
+		for (size_t index = firstIndex; index < lastIndex; ++index)
+		{
+			Model3D::FaceGPUData& face = faces[index];
+			const vec3 a = vertices[face._vertices.x]._position, b = vertices[face._vertices.y]._position, c = vertices[face._vertices.z]._position;
+
+			triangleMesh[index * 4] = face._vertices.x;
+			triangleMesh[index * 4 + 1] = face._vertices.y;
+			triangleMesh[index * 4 + 2] = face._vertices.z;
+			triangleMesh[index * 4 + 3] = Model3D::RESTART_PRIMITIVE_INDEX;
+
+			// Boundaries and location data for BVH
+			face._minPoint = glm::min(a, glm::min(b, c));
+			face._maxPoint = glm::max(a, glm::max(b, c));
+			face._normal = glm::normalize(glm::cross(b - a, c - a));
+		}
+	});
+}
+
+void CPUComputeBackend::computeTangents(std::vector<Model3D::VertexGPUData>& vertices, const std::vector<Model3D::FaceGPUData>& faces)
+{
+	// Tangent (xyz) and number of faces (w) of each vertex; sums of integers do not depend on the order of the threads
+	std::unique_ptr<std::atomic<uint32_t>[]> vertexTangent(new std::atomic<uint32_t>[vertices.size() * 4]());
+
+	parallelChunks(faces.size(), [&](size_t firstIndex, size_t lastIndex)
+	{
+		for (size_t index = firstIndex; index < lastIndex; ++index)
+		{
+			const uvec3 vertexIndex = faces[index]._vertices;
+
+			const vec3 v1 = vertices[vertexIndex.x]._position, v2 = vertices[vertexIndex.y]._position, v3 = vertices[vertexIndex.z]._position;
+			const vec2 w1 = vertices[vertexIndex.x]._textCoord, w2 = vertices[vertexIndex.y]._textCoord, w3 = vertices[vertexIndex.z]._textCoord;
+
+			const float x1 = v2.x - v1.x, x2 = v3.x - v1.x;
+			const float y1 = v2.y - v1.y, y2 = v3.y - v1.y;
+			const float z1 = v2.z - v1.z, z2 = v3.z - v1.z;
+
+			const float s1 = w2.x - w1.x, s2 = w3.x - w1.x;
+			const float t1 = w2.y - w1.y, t2 = w3.y - w1.y;
+
+			const float r = 1.0f / (s1 * t2 - s2 * t1);
+			const vec3 sdir = vec3((t2 * x1 - t1 * x2) * r, (t2 * y1 - t1 * y2) * r, (t2 * z1 - t1 * z2) * r);
+			const vec3 fixedDir = (sdir + TANGENT_FIXED_POINT_FACTOR) * TANGENT_FIXED_POINT_FACTOR;
+
+			// Conversion through a signed type wraps around as the shaders do, instead of being undefined for negative values
+			const uint32_t udir[3] = { uint32_t(int64_t(fixedDir.x)), uint32_t(int64_t(fixedDir.y)), uint32_t(int64_t(fixedDir.z)) };
+
+			for (const unsigned vertex : { vertexIndex.x, vertexIndex.y, vertexIndex.z })
+			{
+				for (int axis = 0; axis < 3; ++axis) vertexTangent[vertex * 4 + axis].fetch_add(udir[axis], std::memory_order_relaxed);
+				vertexTangent[vertex * 4 + 3].fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+	});
+
+	parallelChunks(vertices.size(), [&](size_t firstIndex, size_t lastIndex)
+	{
+		for (size_t index = firstIndex; index < lastIndex; ++index)
+		{
+			const uvec3 sum = uvec3(vertexTangent[index * 4].load(std::memory_order_relaxed), vertexTangent[index * 4 + 1].load(std::memory_order_relaxed), vertexTangent[index * 4 + 2].load(std::memory_order_relaxed));
+			const float count = float(vertexTangent[index * 4 + 3].load(std::memory_order_relaxed));
+
+			const vec3 n = vertices[index]._normal;
+			const vec3 t = vec3(sum) / TANGENT_FIXED_POINT_FACTOR - TANGENT_FIXED_POINT_FACTOR * count;		// Undo summatory by multiplying for tangent counter
+			vertices[index]._tangent = glm::normalize(t - n * glm::dot(n, t));									// Gram-Schmidt orthogonalize
+		}
+	});
+}
+
+void CPUComputeBackend::voxelize(const std::vector<PointCloud::PointModel>& points, const vec3& aabbMin, const vec3& cellSize, const uvec3& numDivs, unsigned numLabels, std::vector<uint16_t>& grid, LabelHistogram* histogram)
+{
+	const size_t numCells = size_t(numDivs.x) * numDivs.y * numDivs.z;
+	const unsigned strideX = numDivs.y * numDivs.z, strideY = numDivs.z;
+
+	std::unique_ptr<LabelHistogram> temporaryHistogram;
+	if (!histogram) temporaryHistogram.reset(histogram = new LabelHistogram());
+
+	histogram->reset(numCells * numLabels);
+	std::atomic<unsigned>* votes = histogram->data();
+
+	// Same cell computation as buildRegularGrid shader: floor((p - min) / cellSize), clamped to the grid. NaN values fall into the first cell
+	auto getCell = [](float position, float minPoint, float size, unsigned numDivisions) -> unsigned
+	{
+		const float cell = std::floor((position - minPoint) / size);
+
+		return cell >= float(numDivisions - 1) ? numDivisions - 1 : (cell > .0f ? unsigned(cell) : 0);
+	};
+
+	{
+		PROFILE_ZONE("accumulate");
+
+		parallelChunks(points.size(), [&](size_t firstIndex, size_t lastIndex)
+		{
+			for (size_t index = firstIndex; index < lastIndex; ++index)
+			{
+				const vec3& point = points[index]._point;
+				const size_t cell = size_t(getCell(point.x, aabbMin.x, cellSize.x, numDivs.x)) * strideX + getCell(point.y, aabbMin.y, cellSize.y, numDivs.y) * strideY + getCell(point.z, aabbMin.z, cellSize.z, numDivs.z);
+
+				votes[cell * numLabels + points[index]._label].fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+	}
+
+	{
+		PROFILE_ZONE("vote");
+
+		// Every occupied voxel has at least a vote, hence marking it as VOXEL_FREE beforehand is not needed
+		parallelChunks(numCells, [&](size_t firstIndex, size_t lastIndex)
+		{
+			for (size_t cell = firstIndex; cell < lastIndex; ++cell)
+			{
+				unsigned maxOccurrence = 0, maxOccurrLabel = 0;
+
+				for (unsigned label = 0; label < numLabels; ++label)
+				{
+					const unsigned occurrence = votes[cell * numLabels + label].load(std::memory_order_relaxed);
+
+					if (occurrence > maxOccurrence)
+					{
+						maxOccurrence = occurrence;
+						maxOccurrLabel = label;
+					}
+				}
+
+				if (maxOccurrence > 0) grid[cell] = uint16_t(maxOccurrLabel);
+			}
+		});
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Graphics/Core/ComputeBackend.h"
+
+/**
+*	@file CPUComputeBackend.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Executor which runs kernels as parallel loops over CPU threads. Arithmetic follows the compute shaders step by step,
+*	including the fixed-point accumulation of tangents, so that both backends produce the same results without an OpenGL context.
+*/
+class CPUComputeBackend: public ComputeBackend
+{
+protected:
+	const static size_t		CHUNK_SIZE;							//!< Number of elements processed by each CPU task
+	const static float		TANGENT_FIXED_POINT_FACTOR;			//!< Scale of tangents accumulated as unsigned integers, as in computeTangents shaders
+
+protected:
+	/**
+	*	@brief Runs kernel(firstIndex, lastIndex) over consecutive chunks of [0, numElements) in parallel.
+	*/
+	template<typename Kernel>
+	static void parallelChunks(size_t numElements, const Kernel& kernel);
+
+public:
+	/**
+	*	@brief Transforms positions and normals of vertices by a model matrix. Displacement textures are not supported.
+	*/
+	virtual void applyModelMatrix(std::vector<Model3D::VertexGPUData>& vertices, const mat4& modelMatrix, Material* material);
+
+	/**
+	*	@brief Computes the bounding box and normal of each face, as well as the index buffer of the triangle mesh.
+	*/
+	virtual void computeMeshData(const std::vector<Model3D::VertexGPUData>& vertices, std::vector<Model3D::FaceGPUData>& faces, std::vector<GLuint>& triangleMesh);
+
+	/**
+	*	@brief Computes the tangent of each vertex from the texture coordinates of its faces.
+	*/
+	virtual void computeTangents(std::vector<Model3D::VertexGPUData>& vertices, const std::vector<Model3D::FaceGPUData>& faces);
+
+	/**
+	*	@return Maximum number of elements of a given size which fit in the smallest shader storage block allowed by OpenGL. There is
+	*	no context to query, and meshes split this way can still be rendered by any device.
+	*/
+	virtual size_t getMaxBufferSize(size_t elementSize) { return MAX_BUFFER_BYTES / std::max(elementSize, size_t(1)); }
+
+	/**
+	*	@return Type of this executor.
+	*/
+	virtual BackendTypes getType() const { return CPU_BACKEND; }
+
+	/**
+	*	@brief Accumulates label votes in a histogram of atomic counters and then selects the most voted label of each voxel.
+	*/
+	virtual void voxelize(const std::vector<PointCloud::PointModel>& points, const vec3& aabbMin, const vec3& cellSize, const uvec3& numDivs, unsigned numLabels, std::vector<uint16_t>& grid, LabelHistogram* histogram = nullptr);
+};
+
+template<typename Kernel>
+inline void CPUComputeBackend::parallelChunks(size_t numElements, const Kernel& kernel)
+{
+	std::vector<size_t> chunks((numElements + CHUNK_SIZE - 1) / CHUNK_SIZE);
+	std::iota(chunks.begin(), chunks.end(), 0);
+
+	std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](const size_t chunk)
+	{
+		kernel(chunk * CHUNK_SIZE, std::min(chunk * CHUNK_SIZE + CHUNK_SIZE, numElements));
+	});
+}
+
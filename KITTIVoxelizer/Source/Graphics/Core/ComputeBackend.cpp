@@ -0,0 +1,24 @@
+#include "stdafx.h"
+#include "ComputeBackend.h"
+
+#include "Graphics/Core/CPUComputeBackend.h"
+#include "Graphics/Core/GPUComputeBackend.h"
+
+// Initialization of static attributes
+const char* ComputeBackend::BACKEND_NAME[NUM_BACKEND_TYPES] = { "GPU", "CPU" };
+const size_t ComputeBackend::MAX_BUFFER_BYTES = size_t(1) << 27;
+
+const std::vector<std::unique_ptr<ComputeBackend>> ComputeBackend::BACKEND = ComputeBackend::getBackends();
+ComputeBackend::BackendTypes ComputeBackend::_selectedBackend = ComputeBackend::GPU_BACKEND;
+
+/// [Protected methods]
+
+std::vector<std::unique_ptr<ComputeBackend>> ComputeBackend::getBackends()
+{
+	std::vector<std::unique_ptr<ComputeBackend>> backend(NUM_BACKEND_TYPES);
+
+	backend[ComputeBackend::GPU_BACKEND].reset(new GPUComputeBackend());
+	backend[ComputeBackend::CPU_BACKEND].reset(new CPUComputeBackend());
+
+	return backend;
+}
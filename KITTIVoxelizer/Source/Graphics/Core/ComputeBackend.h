@@ -0,0 +1,105 @@
+#pragma once
+
+#include "DataStructures/LabelHistogram.h"
+#include "Graphics/Core/Material.h"
+#include "Graphics/Core/Model3D.h"
+#include "Graphics/Core/PointCloud.h"
+
+/**
+*	@file ComputeBackend.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Executor of the data-parallel kernels needed to load scenes and voxelize scans. Every backend produces the same results,
+*	so that the same code runs either on compute shaders or on CPU threads. The backend is selected once at startup, before any
+*	scene is loaded; the GPU backend requires an active OpenGL context whereas the CPU backend requires none.
+*/
+class ComputeBackend
+{
+public:
+	// [Strategy pattern]
+	enum BackendTypes: uint8_t
+	{
+		GPU_BACKEND, CPU_BACKEND, NUM_BACKEND_TYPES
+	};
+
+protected:
+	const static char* BACKEND_NAME[NUM_BACKEND_TYPES];						//!< Names shown in logs and reports
+	const static size_t MAX_BUFFER_BYTES;									//!< Minimum GL_MAX_SHADER_STORAGE_BLOCK_SIZE guaranteed by OpenGL
+
+	// [Strategy pattern]
+	const static std::vector<std::unique_ptr<ComputeBackend>> BACKEND;		//!< Executors for each backend type
+	static BackendTypes _selectedBackend;										//!< Backend used by scene loading and voxelization
+
+protected:
+	/**
+	*	@return Executor of each backend type.
+	*/
+	static std::vector<std::unique_ptr<ComputeBackend>> getBackends();
+
+public:
+	/**
+	*	@brief Destructor.
+	*/
+	virtual ~ComputeBackend() {}
+
+	/**
+	*	@brief Transforms positions and normals of vertices by a model matrix. Displacement textures of the material, if any, are only applied on GPU.
+	*/
+	virtual void applyModelMatrix(std::vector<Model3D::VertexGPUData>& vertices, const mat4& modelMatrix, Material* material) = 0;
+
+	/**
+	*	@brief Computes the bounding box and normal of each face, as well as the index buffer of the triangle mesh, where faces are separated by restart indices.
+	*/
+	virtual void computeMeshData(const std::vector<Model3D::VertexGPUData>& vertices, std::vector<Model3D::FaceGPUData>& faces, std::vector<GLuint>& triangleMesh) = 0;
+
+	/**
+	*	@brief Computes the tangent of each vertex from the texture coordinates of its faces.
+	*/
+	virtual void computeTangents(std::vector<Model3D::VertexGPUData>& vertices, const std::vector<Model3D::FaceGPUData>& faces) = 0;
+
+	/**
+	*	@return Executor of a backend type, regardless of the selected one.
+	*/
+	static ComputeBackend* getBackend(BackendTypes type) { return BACKEND[type].get(); }
+
+	/**
+	*	@return Name of a backend type.
+	*/
+	static const char* getBackendName(BackendTypes type) { return BACKEND_NAME[type]; }
+
+	/**
+	*	@return Selected executor.
+	*/
+	static ComputeBackend* getInstance() { return BACKEND[_selectedBackend].get(); }
+
+	/**
+	*	@return Maximum number of elements of a given size which can be processed by a single kernel.
+	*/
+	virtual size_t getMaxBufferSize(size_t elementSize) = 0;
+
+	/**
+	*	@return Type of the selected executor.
+	*/
+	static BackendTypes getSelectedBackend() { return _selectedBackend; }
+
+	/**
+	*	@return Type of this executor.
+	*/
+	virtual BackendTypes getType() const = 0;
+
+	/**
+	*	@brief Selects the backend used from now on. Must be called before loading any scene.
+	*/
+	static void selectBackend(BackendTypes type) { _selectedBackend = type; }
+
+	/**
+	*	@brief Labels the voxels of a grid with the most frequent label of the points they contain, where ties are solved in favour of the lowest label.
+	*	The grid is indexed as x * numDivs.y * numDivs.z + y * numDivs.z + z, and voxels with no points are not modified.
+	*	@param histogram Storage for label votes which is reused across calls, if any. Otherwise, votes are stored in a temporary buffer.
+	*/
+	virtual void voxelize(const std::vector<PointCloud::PointModel>& points, const vec3& aabbMin, const vec3& cellSize, const uvec3& numDivs, unsigned numLabels, std::vector<uint16_t>& grid, LabelHistogram* histogram = nullptr) = 0;
+};
+
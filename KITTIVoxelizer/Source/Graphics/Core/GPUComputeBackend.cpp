@@ -0,0 +1,157 @@
+#include "stdafx.h"
+#include "GPUComputeBackend.h"
+
+#include "Graphics/Core/ShaderList.h"
+#include "Utilities/MemoryTracker.h"
+#include "Utilities/Profiler.h"
+
+/// [Public methods]
+
+void GPUComputeBackend::applyModelMatrix(std::vector<Model3D::VertexGPUData>& vertices, const mat4& modelMatrix, Material* material)
+{
+	ComputeShader* shader = ShaderList::getInstance()->getComputeShader(RendEnum::MODEL_APPLY_MODEL_MATRIX);
+	const int arraySize = vertices.size();
+	const int numGroups = ComputeShader::getNumGroups(arraySize);
+
+	GLuint modelBufferID;
+	modelBufferID = ComputeShader::setReadBuffer(vertices);
+
+	shader->bindBuffers(std::vector<GLuint> { modelBufferID});
+	shader->use();
+	shader->setUniform("mModel", modelMatrix);
+	shader->setUniform("size", arraySize);
+	if (material) material->applyMaterial4ComputeShader(shader);
+	shader->execute(numGroups, 1, 1, ComputeShader::getMaxGroupSize(), 1, 1);
+
+	Model3D::VertexGPUData* data = shader->readData(modelBufferID, Model3D::VertexGPUData());
+	vertices = std::vector<Model3D::VertexGPUData>(data, data + arraySize);
+
+	glDeleteBuffers(1, &modelBufferID);
+}
+
+void GPUComputeBackend::computeMeshData(const std::vector<Model3D::VertexGPUData>& vertices, std::vector<Model3D::FaceGPUData>& faces, std::vector<GLuint>& triangleMesh)
+{
+	ComputeShader* shader = ShaderList::getInstance()->getComputeShader(RendEnum::MODEL_MESH_GENERATION);
+	const int arraySize = faces.size();
+	const int numGroups = ComputeShader::getNumGroups(arraySize);
+
+	GLuint modelBufferID, meshBufferID, outBufferID;
+	modelBufferID = ComputeShader::setReadBuffer(vertices);
+	meshBufferID = ComputeShader::setReadBuffer(faces);
+	outBufferID = ComputeShader::setWriteBuffer(GLuint(), arraySize * 4);
+
+	shader->bindBuffers(std::vector<GLuint> { modelBufferID, meshBufferID, outBufferID });
+	shader->use();
+	shader->setUniform("size", arraySize);
+	shader->setUniform("restartPrimitiveIndex", Model3D::RESTART_PRIMITIVE_INDEX);
+	shader->execute(numGroups, 1, 1, ComputeShader::getMaxGroupSize(), 1, 1);
+
+	Model3D::FaceGPUData* faceData = shader->readData(meshBufferID, Model3D::FaceGPUData());
+	GLuint* rawMeshData = shader->readData(outBufferID, GLuint());
+	faces = std::vector<Model3D::FaceGPUData>(faceData, faceData + arraySize);
+	triangleMesh = std::vector<GLuint>(rawMeshData, rawMeshData + arraySize * 4);
+
+	glDeleteBuffers(1, &modelBufferID);
+	glDeleteBuffers(1, &meshBufferID);
+	glDeleteBuffers(1, &outBufferID);
+}
+
+void GPUComputeBackend::computeTangents(std::vector<Model3D::VertexGPUData>& vertices, const std::vector<Model3D::FaceGPUData>& faces)
+{
+	ComputeShader* shader	= ShaderList::getInstance()->getComputeShader(RendEnum::COMPUTE_TANGENTS_1);
+	const int numVertices	= vertices.size(), numTriangles = faces.size();
+	int numGroups			= ComputeShader::getNumGroups(numTriangles);
+
+	GLuint geometryBufferID, meshBufferID, outBufferID;
+	geometryBufferID	= ComputeShader::setReadBuffer(vertices);
+	meshBufferID		= ComputeShader::setReadBuffer(faces);
+	outBufferID			= ComputeShader::setWriteBuffer(vec4(), numVertices);
+
+	shader->bindBuffers(std::vector<GLuint> { geometryBufferID, meshBufferID, outBufferID });
+	shader->use();
+	shader->setUniform("numTriangles", numTriangles);
+	shader->execute(numGroups, 1, 1, ComputeShader::getMaxGroupSize(), 1, 1);
+
+	shader = ShaderList::getInstance()->getComputeShader(RendEnum::COMPUTE_TANGENTS_2);
+	numGroups = ComputeShader::getNumGroups(numVertices);
+
+	shader->bindBuffers(std::vector<GLuint> { geometryBufferID, outBufferID });
+	shader->use();
+	shader->setUniform("numVertices", numVertices);
+	shader->execute(numGroups, 1, 1, ComputeShader::getMaxGroupSize(), 1, 1);
+
+	Model3D::VertexGPUData* data = ComputeShader::readData(geometryBufferID, Model3D::VertexGPUData());
+	vertices = std::vector<Model3D::VertexGPUData>(data, data + numVertices);
+
+	glDeleteBuffers(1, &geometryBufferID);
+	glDeleteBuffers(1, &meshBufferID);
+	glDeleteBuffers(1, &outBufferID);
+}
+
+size_t GPUComputeBackend::getMaxBufferSize(size_t elementSize)
+{
+	return ComputeShader::getMaxSSBOSize(unsigned(elementSize));
+}
+
+void GPUComputeBackend::voxelize(const std::vector<PointCloud::PointModel>& points, const vec3& aabbMin, const vec3& cellSize, const uvec3& numDivs, unsigned numLabels, std::vector<uint16_t>& grid, LabelHistogram* histogram)
+{
+	ComputeShader* resetShader = ShaderList::getInstance()->getComputeShader(RendEnum::RESET_LABEL_INDEX);
+	ComputeShader* boundaryShader = ShaderList::getInstance()->getComputeShader(RendEnum::BUILD_REGULAR_GRID);
+	ComputeShader* selectLabelShader = ShaderList::getInstance()->getComputeShader(RendEnum::SELECT_LABEL_GRID);
+
+	// Input data
+	unsigned numCells	= numDivs.x * numDivs.y * numDivs.z;
+	unsigned numThreads = points.size();
+	unsigned numGroups1	= ComputeShader::getNumGroups(numThreads);
+	unsigned numGroups2 = ComputeShader::getNumGroups(numCells);
+	unsigned numGroups3 = ComputeShader::getNumGroups(numCells * numLabels);
+
+	// Input data
+	const GLuint vertexSSBO = ComputeShader::setReadBuffer(points, GL_STATIC_DRAW);
+	const GLuint gridSSBO	= ComputeShader::setReadBuffer(&grid[0], numCells, GL_DYNAMIC_DRAW);
+	const GLuint labelSSBO = ComputeShader::setWriteBuffer(unsigned(), numCells * numLabels, GL_DYNAMIC_DRAW);
+
+	// Buffers are reported until they are deleted at the end of this method
+	MemoryTracker::Allocation gpuMemory(MemoryTracker::GPU_BUFFERS, numThreads * sizeof(PointCloud::PointModel) + numCells * sizeof(uint16_t));
+	MemoryTracker::Allocation labelMemory(MemoryTracker::LABEL_HISTOGRAM, size_t(numCells) * numLabels * sizeof(unsigned));
+
+	// Dispatches are asynchronous, hence GPU time is mostly accounted by the readback zone
+	{
+		PROFILE_ZONE("accumulate");
+
+		// 1. Init to zero the label buffer
+		resetShader->bindBuffers(std::vector<GLuint>{ labelSSBO });
+		resetShader->use();
+		resetShader->setUniform("numLabels", GLuint(numCells * numLabels));
+		resetShader->execute(numGroups3, 1, 1, ComputeShader::getMaxGroupSize(), 1, 1);
+
+		boundaryShader->bindBuffers(std::vector<GLuint>{ vertexSSBO, gridSSBO, labelSSBO });
+		boundaryShader->use();
+		boundaryShader->setUniform("aabbMin", aabbMin);
+		boundaryShader->setUniform("cellSize", cellSize);
+		boundaryShader->setUniform("gridDims", numDivs);
+		boundaryShader->setUniform("numLabels", numLabels);
+		boundaryShader->setUniform("numPoints", numThreads);
+		boundaryShader->execute(numGroups1, 1, 1, ComputeShader::getMaxGroupSize(), 1, 1);
+	}
+
+	{
+		PROFILE_ZONE("vote");
+
+		selectLabelShader->bindBuffers(std::vector<GLuint>{ gridSSBO, labelSSBO });
+		selectLabelShader->use();
+		selectLabelShader->setUniform("numLabels", numLabels);
+		selectLabelShader->setUniform("numCells", numCells);
+		selectLabelShader->execute(numGroups2, 1, 1, ComputeShader::getMaxGroupSize(), 1, 1);
+	}
+
+	{
+		PROFILE_ZONE("readback");
+
+		uint16_t* gridData = ComputeShader::readData(gridSSBO, uint16_t());
+		grid.assign(gridData, gridData + numCells);
+	}
+
+	GLuint buffers[] = { vertexSSBO, gridSSBO, labelSSBO };
+	glDeleteBuffers(sizeof(buffers) / sizeof(GLuint), buffers);
+}
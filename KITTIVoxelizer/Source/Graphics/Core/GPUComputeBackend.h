@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Graphics/Core/ComputeBackend.h"
+
+/**
+*	@file GPUComputeBackend.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Executor which dispatches compute shaders. Requires an active OpenGL context.
+*/
+class GPUComputeBackend: public ComputeBackend
+{
+public:
+	/**
+	*	@brief Transforms positions and normals of vertices by a model matrix, displacing them if the material has a displacement texture.
+	*/
+	virtual void applyModelMatrix(std::vector<Model3D::VertexGPUData>& vertices, const mat4& modelMatrix, Material* material);
+
+	/**
+	*	@brief Computes the bounding box and normal of each face, as well as the index buffer of the triangle mesh.
+	*/
+	virtual void computeMeshData(const std::vector<Model3D::VertexGPUData>& vertices, std::vector<Model3D::FaceGPUData>& faces, std::vector<GLuint>& triangleMesh);
+
+	/**
+	*	@brief Computes the tangent of each vertex from the texture coordinates of its faces.
+	*/
+	virtual void computeTangents(std::vector<Model3D::VertexGPUData>& vertices, const std::vector<Model3D::FaceGPUData>& faces);
+
+	/**
+	*	@return Maximum number of elements of a given size which fit in a shader storage block.
+	*/
+	virtual size_t getMaxBufferSize(size_t elementSize);
+
+	/**
+	*	@return Type of this executor.
+	*/
+	virtual BackendTypes getType() const { return GPU_BACKEND; }
+
+	/**
+	*	@brief Accumulates label votes with atomic additions and then selects the most voted label of each voxel. Votes are always stored in
+	*	a transient GPU buffer, hence the CPU histogram is not used.
+	*/
+	virtual void voxelize(const std::vector<PointCloud::PointModel>& points, const vec3& aabbMin, const vec3& cellSize, const uvec3& numDivs, unsigned numLabels, std::vector<uint16_t>& grid, LabelHistogram* histogram = nullptr);
+};
+
@@ -33,6 +33,7 @@ struct RendEnum
 		VBO_ROTATION,
 		VBO_INDEX,
 		VBO_CLUSTER_ID,
+		VBO_PACKED_INSTANCE,
 	};
 
 	/**
@@ -43,7 +44,7 @@ struct RendEnum
 	/**
 	*	@return Number of VBO different types.
 	*/
-	const static GLsizei numVBOTypes() { return VBO_CLUSTER_ID + 1; }
+	const static GLsizei numVBOTypes() { return VBO_PACKED_INSTANCE + 1; }
 
 	/// [Shaders]
 
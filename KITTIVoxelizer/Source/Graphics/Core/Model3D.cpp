@@ -2,6 +2,7 @@
 #include "Model3D.h"
 
 #include "Graphics/Application/Renderer.h"
+#include "Graphics/Core/ComputeBackend.h"
 #include "Graphics/Core/FBOScreenshot.h"
 #include "Graphics/Core/Group3D.h"
 #include "Graphics/Core/OpenGLUtilities.h"
@@ -260,34 +261,7 @@ void Model3D::captureTexture(FBOScreenshot* fbo, const std::vector<vec4>& pixels
 
 void Model3D::computeTangents(ModelComponent* modelComp)
 {
-	ComputeShader* shader	= ShaderList::getInstance()->getComputeShader(RendEnum::COMPUTE_TANGENTS_1);
-	const int numVertices	= modelComp->_geometry.size(), numTriangles = modelComp->_topology.size();
-	int numGroups			= ComputeShader::getNumGroups(numTriangles);
-
-	GLuint geometryBufferID, meshBufferID, outBufferID;
-	geometryBufferID	= ComputeShader::setReadBuffer(modelComp->_geometry);
-	meshBufferID		= ComputeShader::setReadBuffer(modelComp->_topology);
-	outBufferID			= ComputeShader::setWriteBuffer(vec4(), numVertices);
-
-	shader->bindBuffers(std::vector<GLuint> { geometryBufferID, meshBufferID, outBufferID });
-	shader->use();
-	shader->setUniform("numTriangles", numTriangles);
-	shader->execute(numGroups, 1, 1, ComputeShader::getMaxGroupSize(), 1, 1);
-
-	shader = ShaderList::getInstance()->getComputeShader(RendEnum::COMPUTE_TANGENTS_2);
-	numGroups = ComputeShader::getNumGroups(numVertices);
-
-	shader->bindBuffers(std::vector<GLuint> { geometryBufferID, outBufferID });
-	shader->use();
-	shader->setUniform("numVertices", numVertices);
-	shader->execute(numGroups, 1, 1, ComputeShader::getMaxGroupSize(), 1, 1);
-
-	VertexGPUData* data		= ComputeShader::readData(geometryBufferID, VertexGPUData());
-	modelComp->_geometry	= std::move(std::vector<VertexGPUData>(data, data + numVertices));
-
-	glDeleteBuffers(1, &geometryBufferID);
-	glDeleteBuffers(1, &meshBufferID);
-	glDeleteBuffers(1, &outBufferID);
+	ComputeBackend::getInstance()->computeTangents(modelComp->_geometry, modelComp->_topology);
 }
 
 void Model3D::generatePointCloud()
@@ -404,6 +404,11 @@ public:
 	*/
 	ModelComponent* getModelComponent(unsigned index) { return _modelComp[index]; }
 
+	/**
+	*	@return Number of model components.
+	*/
+	unsigned getNumModelComponents() const { return unsigned(_modelComp.size()); }
+
 	/**
 	*	@return Model transformation matrix.
 	*/
@@ -0,0 +1,480 @@
+#include "stdafx.h"
+#include "PLYDecoder.h"
+
+#include <charconv>
+#include <emmintrin.h>
+#include "Utilities/Profiler.h"
+
+// Initialization of static attributes
+const size_t PLYDecoder::ASCII_BLOCK_SIZE = 1 << 26;
+const size_t PLYDecoder::ASCII_CHUNK_SIZE = 1 << 20;
+const size_t PLYDecoder::CHUNK_SIZE = 1 << 16;
+
+/// [Public methods]
+
+PLYDecoder::PLYDecoder(const std::string& filename) : _filename(filename), _format(UNKNOWN_FORMAT), _headerSize(0), _numInvalidLabels(0)
+{
+}
+
+PLYDecoder::~PLYDecoder()
+{
+}
+
+bool PLYDecoder::decodeVertices(const std::vector<std::string>& labelNames, std::vector<PointCloud::PointModel>& points, AABB& aabb, unsigned& maxLabel)
+{
+	PROFILE_ZONE("PLYDecoder::decodeVertices");
+
+	const Element* vertex = nullptr;
+	const Property* xyz[3] = { nullptr, nullptr, nullptr };
+	const Property* label = nullptr;
+	size_t bodyOffset = 0, numSkippedLines = 0;
+	bool fixedOffset = true;
+
+	_numInvalidLabels = 0;
+
+	// Elements stored before vertices are skipped, which requires them to have a fixed size in binary bodies
+	for (const Element& element : _element)
+	{
+		if (element._name == "vertex")
+		{
+			vertex = &element;
+			break;
+		}
+
+		fixedOffset &= element._stride != 0;
+		bodyOffset += element._count * element._stride;
+		numSkippedLines += element._count;
+	}
+
+	if (!vertex) return false;
+
+	xyz[0] = getProperty(*vertex, "x"); xyz[1] = getProperty(*vertex, "y"); xyz[2] = getProperty(*vertex, "z");
+	for (const std::string& labelName : labelNames)
+	{
+		if ((label = getProperty(*vertex, labelName))) break;
+	}
+
+	if (!xyz[0] || !xyz[1] || !xyz[2] || !label) return false;
+
+	for (const Property* property : { xyz[0], xyz[1], xyz[2], label })
+	{
+		if (property->_isList || property->_type == INVALID_TYPE) return false;
+	}
+
+	if (_format == BINARY_LITTLE_ENDIAN && fixedOffset)
+	{
+		return this->decodeBinary(*vertex, bodyOffset, xyz, label, points, aabb, maxLabel);
+	}
+
+	if (_format == ASCII)
+	{
+		return this->decodeASCII(*vertex, numSkippedLines, xyz, label, points, aabb, maxLabel);
+	}
+
+	return false;
+}
+
+bool PLYDecoder::readHeader()
+{
+	std::ifstream inputStream(_filename, std::ios::in | std::ios::binary);
+	std::string currentLine, keyword, format, typeName;
+	std::stringstream line;
+
+	if (inputStream.fail() || !std::getline(inputStream, currentLine) || currentLine.compare(0, 3, "ply") != 0) return false;
+
+	_element.clear();
+	_format = UNKNOWN_FORMAT;
+
+	while (std::getline(inputStream, currentLine))
+	{
+		if (!currentLine.empty() && currentLine.back() == '\r') currentLine.pop_back();
+
+		line.clear();
+		line.str(currentLine);
+		keyword.clear();
+		line >> keyword;
+
+		if (keyword == "format")
+		{
+			line >> format;
+			_format = format == "ascii" ? ASCII : (format == "binary_little_endian" ? BINARY_LITTLE_ENDIAN : (format == "binary_big_endian" ? BINARY_BIG_ENDIAN : UNKNOWN_FORMAT));
+		}
+		else if (keyword == "element")
+		{
+			Element element;
+			line >> element._name >> element._count;
+			element._stride = 0;
+
+			if (line.fail()) return false;
+
+			_element.push_back(element);
+		}
+		else if (keyword == "property")
+		{
+			if (_element.empty()) return false;
+
+			Element& element = _element.back();
+			Property property;
+			line >> typeName;
+
+			if ((property._isList = typeName == "list"))
+			{
+				std::string countType;
+				line >> countType >> typeName;
+			}
+
+			line >> property._name;
+			property._type = getType(typeName);
+			property._offset = element._stride;
+
+			if (line.fail()) return false;
+
+			element._property.push_back(property);
+
+			// Records with lists have a variable size
+			const bool fixedSize = element._property.size() == 1 || element._stride;
+			element._stride = fixedSize && !property._isList && property._type != INVALID_TYPE ? element._stride + getSize(property._type) : 0;
+		}
+		else if (keyword == "end_header")
+		{
+			_headerSize = size_t(inputStream.tellg());
+
+			return _format != UNKNOWN_FORMAT;
+		}
+	}
+
+	return false;
+}
+
+/// [Protected methods]
+
+bool PLYDecoder::decodeASCII(const Element& vertex, size_t numSkippedLines, const Property* xyz[3], const Property* label, std::vector<PointCloud::PointModel>& points, AABB& aabb, unsigned& maxLabel)
+{
+	std::ifstream inputStream(_filename, std::ios::in | std::ios::binary);
+	if (!inputStream.is_open()) return false;
+
+	// Lines are split into tokens, so list properties preceding the requested ones would shift them
+	unsigned propertyIdx[4];
+	const Property* property[4] = { xyz[0], xyz[1], xyz[2], label };
+
+	for (int idx = 0; idx < 4; ++idx)
+	{
+		propertyIdx[idx] = unsigned(property[idx] - vertex._property.data());
+
+		for (unsigned previousIdx = 0; previousIdx < propertyIdx[idx]; ++previousIdx)
+		{
+			if (vertex._property[previousIdx]._isList) return false;
+		}
+	}
+
+	inputStream.seekg(_headerSize);
+
+	std::string skippedLine;
+	for (size_t lineIdx = 0; lineIdx < numSkippedLines; ++lineIdx)
+	{
+		if (!std::getline(inputStream, skippedLine)) return false;
+	}
+
+	points.resize(vertex._count);
+	std::vector<char> block;
+	std::vector<ASCIIChunk> chunk;
+	size_t numDecoded = 0, carriedBytes = 0;
+	vec3 minPoint(INFINITY), maxPoint(-INFINITY);
+	unsigned decodedMaxLabel = 0;
+	size_t numInvalidLabels = 0;
+
+	while (numDecoded < vertex._count)
+	{
+		// Incomplete line of the previous block is moved to the beginning
+		block.resize(carriedBytes + ASCII_BLOCK_SIZE + 1);
+		inputStream.read(block.data() + carriedBytes, ASCII_BLOCK_SIZE);
+
+		const size_t numBytes = carriedBytes + size_t(inputStream.gcount());
+		const bool endOfFile = !inputStream;
+		size_t blockSize = numBytes;
+
+		if (endOfFile)
+		{
+			if (numBytes && block[numBytes - 1] != '\n') block[blockSize++] = '\n';
+		}
+		else
+		{
+			while (blockSize && block[blockSize - 1] != '\n') --blockSize;
+		}
+
+		if (!blockSize)
+		{
+			if (endOfFile) return false;
+
+			// Line longer than the block
+			carriedBytes = numBytes;
+			continue;
+		}
+
+		// Chunks end at the first newline after an even split
+		const char* blockBegin = block.data(), *blockEnd = block.data() + blockSize;
+		const size_t numChunks = std::max(blockSize / ASCII_CHUNK_SIZE, size_t(1));
+		const char* chunkBegin = blockBegin;
+
+		chunk.clear();
+
+		for (size_t chunkIdx = 1; chunkIdx <= numChunks && chunkBegin != blockEnd; ++chunkIdx)
+		{
+			const char* chunkEnd = chunkIdx == numChunks ? blockEnd : std::max(chunkBegin, blockBegin + chunkIdx * blockSize / numChunks);
+			chunkEnd = std::find(chunkEnd, blockEnd, '\n');
+			chunkEnd = chunkEnd == blockEnd ? blockEnd : chunkEnd + 1;
+
+			ASCIIChunk newChunk;
+			newChunk._begin = chunkBegin;
+			newChunk._end = chunkEnd;
+			chunk.push_back(newChunk);
+
+			chunkBegin = chunkEnd;
+		}
+
+		std::for_each(std::execution::par, chunk.begin(), chunk.end(), [&](ASCIIChunk& currentChunk)
+		{
+			currentChunk._numLines = size_t(std::count(currentChunk._begin, currentChunk._end, '\n'));
+		});
+
+		// Line offsets let every chunk write its points in place, hence no stitching is required
+		size_t offset = 0;
+
+		for (ASCIIChunk& currentChunk : chunk)
+		{
+			currentChunk._offset = offset;
+			currentChunk._numLines = std::min(currentChunk._numLines, vertex._count - numDecoded - std::min(offset, vertex._count - numDecoded));
+			offset += currentChunk._numLines;
+		}
+
+		std::for_each(std::execution::par, chunk.begin(), chunk.end(), [&](ASCIIChunk& currentChunk)
+		{
+			decodeASCIIChunk(currentChunk, propertyIdx, points.data() + numDecoded + currentChunk._offset);
+		});
+
+		for (const ASCIIChunk& currentChunk : chunk)
+		{
+			if (!currentChunk._success) return false;
+
+			minPoint = glm::min(minPoint, currentChunk._min);
+			maxPoint = glm::max(maxPoint, currentChunk._max);
+			decodedMaxLabel = std::max(decodedMaxLabel, currentChunk._maxLabel);
+			numInvalidLabels += currentChunk._numInvalidLabels;
+		}
+
+		numDecoded += offset;
+
+		if (numDecoded < vertex._count && endOfFile) return false;
+
+		carriedBytes = numBytes - blockSize;
+		std::memmove(block.data(), block.data() + blockSize, carriedBytes);
+	}
+
+	maxLabel = std::max(maxLabel, decodedMaxLabel);
+	_numInvalidLabels = numInvalidLabels;
+
+	if (!points.empty())
+	{
+		aabb.update(minPoint);
+		aabb.update(maxPoint);
+	}
+
+	return true;
+}
+
+void PLYDecoder::decodeASCIIChunk(ASCIIChunk& chunk, const unsigned propertyIdx[4], PointCloud::PointModel* points)
+{
+	const unsigned lastIdx = *std::max_element(propertyIdx, propertyIdx + 4);
+	const char* character = chunk._begin, *end = chunk._end;
+	double value[4];
+
+	chunk._min = vec3(INFINITY);
+	chunk._max = vec3(-INFINITY);
+	chunk._maxLabel = 0;
+	chunk._numInvalidLabels = 0;
+	chunk._success = true;
+
+	for (size_t lineIdx = 0; lineIdx < chunk._numLines; ++lineIdx)
+	{
+		for (unsigned tokenIdx = 0; tokenIdx <= lastIdx; ++tokenIdx)
+		{
+			while (character != end && (*character == ' ' || *character == '\t')) ++character;
+
+			const char* tokenEnd = character;
+			while (tokenEnd != end && *tokenEnd != ' ' && *tokenEnd != '\t' && *tokenEnd != '\r' && *tokenEnd != '\n') ++tokenEnd;
+
+			if (tokenEnd == character)
+			{
+				chunk._success = false;
+				return;
+			}
+
+			for (int idx = 0; idx < 4; ++idx)
+			{
+				if (propertyIdx[idx] == tokenIdx && std::from_chars(character, tokenEnd, value[idx]).ptr != tokenEnd)
+				{
+					chunk._success = false;
+					return;
+				}
+			}
+
+			character = tokenEnd;
+		}
+
+		// Remaining properties are not needed
+		character = std::find(character, end, '\n');
+		if (character != end) ++character;
+
+		PointCloud::PointModel& point = points[lineIdx];
+		point._point = vec3(value[0], value[1], value[2]);
+		point._label = getLabel(value[3], chunk._numInvalidLabels);
+
+		chunk._min = glm::min(chunk._min, point._point);
+		chunk._max = glm::max(chunk._max, point._point);
+		chunk._maxLabel = std::max(chunk._maxLabel, point._label);
+	}
+}
+
+bool PLYDecoder::decodeBinary(const Element& vertex, size_t bodyOffset, const Property* xyz[3], const Property* label, std::vector<PointCloud::PointModel>& points, AABB& aabb, unsigned& maxLabel)
+{
+	static_assert(sizeof(PointCloud::PointModel) == sizeof(vec4) && offsetof(PointCloud::PointModel, _point) == 0, "Points are written as four floats");
+
+	std::ifstream inputStream(_filename, std::ios::in | std::ios::binary);
+	if (!inputStream.is_open() || !vertex._stride) return false;
+
+	const size_t stride = vertex._stride;
+	const PropertyType coordType = xyz[0]->_type;
+	const bool packedXYZ = xyz[1]->_type == coordType && xyz[2]->_type == coordType &&
+		xyz[1]->_offset == xyz[0]->_offset + getSize(coordType) && xyz[2]->_offset == xyz[1]->_offset + getSize(coordType);
+	const bool packedFloat = packedXYZ && coordType == FLOAT32, packedDouble = packedXYZ && coordType == FLOAT64;
+
+	// Chunk buffer is padded so that 16-byte loads never exceed it
+	std::vector<char> buffer(std::min(CHUNK_SIZE, std::max(vertex._count, size_t(1))) * stride + sizeof(__m128));
+	points.resize(vertex._count);
+	__m128 minPoint = _mm_set1_ps(INFINITY), maxPoint = _mm_set1_ps(-INFINITY);
+	unsigned decodedMaxLabel = 0;
+	size_t numInvalidLabels = 0;
+
+	inputStream.seekg(_headerSize + bodyOffset);
+
+	for (size_t firstIdx = 0; firstIdx < vertex._count; firstIdx += CHUNK_SIZE)
+	{
+		const size_t numRecords = std::min(CHUNK_SIZE, vertex._count - firstIdx);
+		PointCloud::PointModel* point = points.data() + firstIdx;
+
+		inputStream.read(buffer.data(), numRecords * stride);
+		if (size_t(inputStream.gcount()) != numRecords * stride) return false;
+
+		// Positions: four floats are stored at once, the fourth one (label) is overwritten later
+		const char* record = buffer.data() + xyz[0]->_offset;
+
+		if (packedFloat)
+		{
+			for (size_t recordIdx = 0; recordIdx < numRecords; ++recordIdx, record += stride)
+			{
+				const __m128 position = _mm_loadu_ps(reinterpret_cast<const float*>(record));
+				minPoint = _mm_min_ps(minPoint, position);
+				maxPoint = _mm_max_ps(maxPoint, position);
+				_mm_storeu_ps(&point[recordIdx]._point.x, position);
+			}
+		}
+		else if (packedDouble)
+		{
+			for (size_t recordIdx = 0; recordIdx < numRecords; ++recordIdx, record += stride)
+			{
+				const __m128 xy = _mm_cvtpd_ps(_mm_loadu_pd(reinterpret_cast<const double*>(record)));
+				const __m128 z = _mm_cvtpd_ps(_mm_load_sd(reinterpret_cast<const double*>(record) + 2));
+				const __m128 position = _mm_movelh_ps(xy, z);
+				minPoint = _mm_min_ps(minPoint, position);
+				maxPoint = _mm_max_ps(maxPoint, position);
+				_mm_storeu_ps(&point[recordIdx]._point.x, position);
+			}
+		}
+		else
+		{
+			for (size_t recordIdx = 0; recordIdx < numRecords; ++recordIdx)
+			{
+				const char* base = buffer.data() + recordIdx * stride;
+				float coord[4] = { .0f, .0f, .0f, .0f };
+
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					double value;
+
+					if (xyz[axis]->_type == FLOAT64) { std::memcpy(&value, base + xyz[axis]->_offset, sizeof(double)); }
+					else if (xyz[axis]->_type == FLOAT32) { float floatValue; std::memcpy(&floatValue, base + xyz[axis]->_offset, sizeof(float)); value = floatValue; }
+					else return false;
+
+					coord[axis] = float(value);
+				}
+
+				const __m128 position = _mm_loadu_ps(coord);
+				minPoint = _mm_min_ps(minPoint, position);
+				maxPoint = _mm_max_ps(maxPoint, position);
+				_mm_storeu_ps(&point[recordIdx]._point.x, position);
+			}
+		}
+
+		// Labels
+		record = buffer.data() + label->_offset;
+
+		switch (label->_type)
+		{
+		case INT8:		decodeLabels<int8_t>(record, stride, numRecords, point, decodedMaxLabel, numInvalidLabels); break;
+		case UINT8:		decodeLabels<uint8_t>(record, stride, numRecords, point, decodedMaxLabel, numInvalidLabels); break;
+		case INT16:		decodeLabels<int16_t>(record, stride, numRecords, point, decodedMaxLabel, numInvalidLabels); break;
+		case UINT16:	decodeLabels<uint16_t>(record, stride, numRecords, point, decodedMaxLabel, numInvalidLabels); break;
+		case INT32:		decodeLabels<int32_t>(record, stride, numRecords, point, decodedMaxLabel, numInvalidLabels); break;
+		case UINT32:	decodeLabels<uint32_t>(record, stride, numRecords, point, decodedMaxLabel, numInvalidLabels); break;
+		case FLOAT32:	decodeLabels<float>(record, stride, numRecords, point, decodedMaxLabel, numInvalidLabels); break;
+		case FLOAT64:	decodeLabels<double>(record, stride, numRecords, point, decodedMaxLabel, numInvalidLabels); break;
+		default:		return false;
+		}
+	}
+
+	alignas(16) float minCoord[4], maxCoord[4];
+	_mm_store_ps(minCoord, minPoint);
+	_mm_store_ps(maxCoord, maxPoint);
+
+	maxLabel = std::max(maxLabel, decodedMaxLabel);
+	_numInvalidLabels = numInvalidLabels;
+
+	if (!points.empty())
+	{
+		aabb.update(vec3(minCoord[0], minCoord[1], minCoord[2]));
+		aabb.update(vec3(maxCoord[0], maxCoord[1], maxCoord[2]));
+	}
+
+	return true;
+}
+
+const PLYDecoder::Property* PLYDecoder::getProperty(const Element& element, const std::string& name)
+{
+	for (const Property& property : element._property)
+	{
+		if (property._name == name) return &property;
+	}
+
+	return nullptr;
+}
+
+size_t PLYDecoder::getSize(PropertyType type)
+{
+	static const size_t size[] = { 1, 1, 2, 2, 4, 4, 4, 8, 0 };
+
+	return size[type];
+}
+
+PLYDecoder::PropertyType PLYDecoder::getType(const std::string& name)
+{
+	if (name == "char" || name == "int8") return INT8;
+	if (name == "uchar" || name == "uint8") return UINT8;
+	if (name == "short" || name == "int16") return INT16;
+	if (name == "ushort" || name == "uint16") return UINT16;
+	if (name == "int" || name == "int32") return INT32;
+	if (name == "uint" || name == "uint32") return UINT32;
+	if (name == "float" || name == "float32") return FLOAT32;
+	if (name == "double" || name == "float64") return FLOAT64;
+
+	return INVALID_TYPE;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "Geometry/3D/AABB.h"
+#include "Graphics/Core/PointCloud.h"
+
+/**
+*	@file PLYDecoder.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Streaming decoder of PLY vertices. Vertices are converted chunk by chunk into the point cloud layout,
+*	so that the file content is never fully buffered in memory.
+*/
+class PLYDecoder
+{
+public:
+	enum FileFormat { ASCII, BINARY_LITTLE_ENDIAN, BINARY_BIG_ENDIAN, UNKNOWN_FORMAT };
+	enum PropertyType { INT8, UINT8, INT16, UINT16, INT32, UINT32, FLOAT32, FLOAT64, INVALID_TYPE };
+
+	struct Property
+	{
+		std::string		_name;										//!< Property identifier, e.g. x
+		PropertyType	_type;										//!< Type of scalar properties and list items
+		size_t			_offset;									//!< Offset within a binary record
+		bool			_isList;									//!< Lists have no fixed size
+	};
+
+	struct Element
+	{
+		std::string				_name;								//!< Element identifier, e.g. vertex
+		size_t					_count;								//!< Number of records
+		std::vector<Property>	_property;							//!< Properties of each record
+		size_t					_stride;							//!< Size of a binary record, zero if there are list properties
+	};
+
+protected:
+	struct ASCIIChunk
+	{
+		const char*		_begin;										//!< First character of the chunk, at the beginning of a line
+		const char*		_end;										//!< One past the last newline of the chunk
+		size_t			_offset;									//!< Index of the first line within the block
+		size_t			_numLines;									//!< Number of lines to be decoded
+		vec3			_min, _max;									//!< Bounds of decoded positions
+		unsigned		_maxLabel;									//!< Maximum decoded label
+		size_t			_numInvalidLabels;							//!< Labels out of the 16-bit range or NaN
+		bool			_success;									//!< False if any line could not be parsed
+	};
+
+protected:
+	const static size_t			ASCII_BLOCK_SIZE;					//!< Number of bytes read at once from ASCII bodies
+	const static size_t			ASCII_CHUNK_SIZE;					//!< Approximate number of bytes parsed by each task
+	const static size_t			CHUNK_SIZE;							//!< Number of vertices decoded at once
+
+protected:
+	std::vector<Element>		_element;							//!< Elements in file order
+	std::string					_filename;							//!< Path of PLY file
+	FileFormat					_format;							//!< Encoding of file body
+	size_t						_headerSize;						//!< Number of bytes until the body starts
+	size_t						_numInvalidLabels;					//!< Labels replaced by zero during the last decoding
+
+protected:
+	/**
+	*	@brief Decodes vertices from an ASCII body. Each block is split at line boundaries and its chunks are parsed in parallel.
+	*	@param numSkippedLines Lines of preceding elements.
+	*/
+	bool decodeASCII(const Element& vertex, size_t numSkippedLines, const Property* xyz[3], const Property* label, std::vector<PointCloud::PointModel>& points, AABB& aabb, unsigned& maxLabel);
+
+	/**
+	*	@brief Parses the lines of an ASCII chunk into points.
+	*	@param propertyIdx Token index of x, y, z and label.
+	*/
+	static void decodeASCIIChunk(ASCIIChunk& chunk, const unsigned propertyIdx[4], PointCloud::PointModel* points);
+
+	/**
+	*	@brief Decodes vertices from a binary little-endian body.
+	*/
+	bool decodeBinary(const Element& vertex, size_t bodyOffset, const Property* xyz[3], const Property* label, std::vector<PointCloud::PointModel>& points, AABB& aabb, unsigned& maxLabel);
+
+	/**
+	*	@brief Converts the labels of a chunk of binary records.
+	*/
+	template<typename T>
+	static void decodeLabels(const char* record, const size_t stride, const size_t numRecords, PointCloud::PointModel* points, unsigned& maxLabel, size_t& numInvalidLabels);
+
+	/**
+	*	@brief Converts a decoded value into a label. Negative, NaN and values over UINT16_MAX are invalid and replaced by zero (unlabelled).
+	*/
+	static unsigned getLabel(double value, size_t& numInvalidLabels);
+
+	/**
+	*	@return Property of element with the given name, null if it does not exist.
+	*/
+	static const Property* getProperty(const Element& element, const std::string& name);
+
+	/**
+	*	@return Size of a property type in bytes.
+	*/
+	static size_t getSize(PropertyType type);
+
+	/**
+	*	@return Property type from its PLY name (char, uchar, float32...).
+	*/
+	static PropertyType getType(const std::string& name);
+
+public:
+	/**
+	*	@brief Constructor. The file is not opened until the header is read.
+	*/
+	PLYDecoder(const std::string& filename);
+
+	/**
+	*	@brief Destructor.
+	*/
+	virtual ~PLYDecoder();
+
+	/**
+	*	@brief Decodes position and label of every vertex straight into points, whose capacity is reused. Points are undefined if the decoding fails,
+	*	whereas the rest of output arguments are only modified if it succeeds.
+	*	@param labelNames Candidate label properties, sorted by priority.
+	*	@return False if the file layout is not supported or the file is corrupted.
+	*/
+	bool decodeVertices(const std::vector<std::string>& labelNames, std::vector<PointCloud::PointModel>& points, AABB& aabb, unsigned& maxLabel);
+
+	/**
+	*	@return Encoding of file body.
+	*/
+	FileFormat getFormat() const { return _format; }
+
+	/**
+	*	@return Number of labels out of [0, UINT16_MAX] that were replaced by zero during the last decoding.
+	*/
+	size_t getNumInvalidLabels() const { return _numInvalidLabels; }
+
+	/**
+	*	@brief Reads the PLY header.
+	*	@return False if the file could not be opened or the header is malformed.
+	*/
+	bool readHeader();
+};
+
+template<typename T>
+inline void PLYDecoder::decodeLabels(const char* record, const size_t stride, const size_t numRecords, PointCloud::PointModel* points, unsigned& maxLabel, size_t& numInvalidLabels)
+{
+	T label;
+
+	for (size_t recordIdx = 0; recordIdx < numRecords; ++recordIdx, record += stride)
+	{
+		std::memcpy(&label, record, sizeof(T));
+		points[recordIdx]._label = getLabel(double(label), numInvalidLabels);
+		maxLabel = std::max(points[recordIdx]._label, maxLabel);
+	}
+}
+
+inline unsigned PLYDecoder::getLabel(double value, size_t& numInvalidLabels)
+{
+	// Comparisons are false for NaN
+	if (value >= .0 && value <= double(UINT16_MAX)) return unsigned(value);
+
+	++numInvalidLabels;
+
+	return 0;
+}
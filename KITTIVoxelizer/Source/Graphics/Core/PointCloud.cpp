@@ -2,17 +2,22 @@
 #include "PointCloud.h"
 
 #include <filesystem>
+#include "DataStructures/RegularGrid.h"
 #include "Graphics/Application/TextureList.h"
+#include "Graphics/Core/PLYDecoder.h"
+#include "Graphics/Core/PointCloudWriter.h"
 #include "Graphics/Core/ShaderList.h"
 #include "Graphics/Core/VAO.h"
+#include "Utilities/Profiler.h"
 
 // Initialization of static attributes
+const std::vector<std::string> PointCloud::LABEL_PROPERTY_NAMES = { "scalar_Classification", "semanticGroup" };
 const std::string	PointCloud::WRITE_POINT_CLOUD_FOLDER = "PointClouds/";
 
 /// Public methods
 
 PointCloud::PointCloud(const std::string& filename, const bool useBinary, const mat4& modelMatrix) :
-	Model3D(modelMatrix, 1), _filename(filename), _useBinary(useBinary), _maxLabel(0)
+	Model3D(modelMatrix, 1), _filename(filename), _useBinary(useBinary), _pointsMemory(MemoryTracker::POINTS), _maxLabel(0)
 {
 }
 
@@ -20,13 +25,37 @@ PointCloud::~PointCloud()
 {
 }
 
+PointCloud* PointCloud::downsample(const uvec3& subdivisions)
+{
+	const uvec3 numDivs = glm::max(subdivisions, uvec3(1));
+	PointCloud* pointCloud = new PointCloud(_filename, false, _modelMatrix);
+	pointCloud->_cacheSuffix = _cacheSuffix + "_" + std::to_string(numDivs.x) + "x" + std::to_string(numDivs.y) + "x" + std::to_string(numDivs.z);
+	RegularGrid::downsample(_points, _aabb, numDivs, pointCloud->_points);
+
+	for (const PointModel& point : pointCloud->_points)
+	{
+		pointCloud->_aabb.update(point._point);
+		pointCloud->_maxLabel = std::max(pointCloud->_maxLabel, point._label);
+	}
+
+	pointCloud->_pointsMemory.resize(pointCloud->_points.capacity() * sizeof(PointModel));
+	pointCloud->_loaded = true;
+
+	return pointCloud;
+}
+
 bool PointCloud::load(const mat4& modelMatrix)
 {
+	PROFILE_ZONE("PointCloud::load");
+
 	if (!_loaded)
 	{
 		bool success = false, binaryExists = false;
+		const std::string binaryFilename = _filename + BINARY_EXTENSION, plyFilename = _filename + PLY_EXTENSION;
 
-		if (_useBinary && (binaryExists = std::filesystem::exists(_filename + BINARY_EXTENSION)))
+		// Binary files older than the PLY file are outdated and therefore rewritten
+		if (_useBinary && (binaryExists = std::filesystem::exists(binaryFilename) &&
+			(!std::filesystem::exists(plyFilename) || std::filesystem::last_write_time(binaryFilename) >= std::filesystem::last_write_time(plyFilename))))
 		{
 			success = this->loadModelFromBinaryFile();
 		}
@@ -37,10 +66,11 @@ bool PointCloud::load(const mat4& modelMatrix)
 		}
 
 		std::cout << "Number of Points: " << _points.size() << std::endl;
+		_pointsMemory.resize(_points.capacity() * sizeof(PointModel));
 
 		if (success && !binaryExists)
 		{
-			this->writeToBinary(_filename + BINARY_EXTENSION);
+			this->writeToBinary(binaryFilename);
 		}
 
 		_loaded = true;
@@ -51,12 +81,19 @@ bool PointCloud::load(const mat4& modelMatrix)
 	return false;
 }
 
-bool PointCloud::writePointCloud(const std::string& filename, const bool ascii)
+void PointCloud::reset(const std::string& filename)
 {
-	std::thread writePointCloudThread(&PointCloud::threadedWritePointCloud, this, filename, ascii);
-	writePointCloudThread.detach();
+	_filename = filename;
+	_cacheSuffix.clear();
+	_aabb = AABB();
+	_points.clear();
+	_maxLabel = 0;
+	_loaded = false;
+}
 
-	return true;
+std::future<bool> PointCloud::writePointCloud(const std::string& filename, const bool ascii)
+{
+	return PointCloudWriter::getInstance()->write(_points, WRITE_POINT_CLOUD_FOLDER + filename, ascii);
 }
 
 /// [Protected methods]
@@ -175,11 +212,15 @@ void PointCloud::getPoints(std::shared_ptr<tinyply::PlyData>& plyPoints, std::ve
 
 bool PointCloud::loadModelFromBinaryFile()
 {
+	PROFILE_ZONE("PointCloud::readBinary");
+
 	return this->readBinary(_filename + BINARY_EXTENSION, _modelComp);
 }
 
 bool PointCloud::loadModelFromPLY(const mat4& modelMatrix)
 {
+	PROFILE_ZONE("PointCloud::parsePLY");
+
 	std::unique_ptr<std::istream> fileStream;
 	std::vector<uint8_t> byteBuffer;
 	std::shared_ptr<tinyply::PlyData> plyPoints, plyLabels;
@@ -188,6 +229,22 @@ bool PointCloud::loadModelFromPLY(const mat4& modelMatrix)
 	double* pointsRawDouble = nullptr;
 	uint8_t* colorsRaw;
 
+	{
+		// Binary files are streamed straight into the point layout, whereas tinyply remains as fallback for any other layout
+		PLYDecoder decoder(_filename + PLY_EXTENSION);
+		if (decoder.readHeader() && decoder.decodeVertices(LABEL_PROPERTY_NAMES, _points, _aabb, _maxLabel))
+		{
+			if (decoder.getNumInvalidLabels())
+			{
+				std::cerr << decoder.getNumInvalidLabels() << " labels out of range were set to unlabelled in " << _filename << PLY_EXTENSION << std::endl;
+			}
+
+			return true;
+		}
+
+		_points.clear();
+	}
+
 	try
 	{
 		const std::string filename = _filename + PLY_EXTENSION;
@@ -272,31 +329,6 @@ void PointCloud::setVAOData()
 	modelComp->_topologyIndicesLength[RendEnum::IBO_POINT_CLOUD] = unsigned(modelComp->_pointCloud.size());
 }
 
-void PointCloud::threadedWritePointCloud(const std::string& filename, const bool ascii)
-{
-	std::filebuf fileBuffer;					
-	fileBuffer.open(WRITE_POINT_CLOUD_FOLDER + filename, ascii ? std::ios::out : std::ios::out | std::ios::binary);
-
-	std::ostream outstream(&fileBuffer);
-	if (outstream.fail()) throw std::runtime_error("Failed to open " + filename + ".");
-
-	tinyply::PlyFile pointCloud;
-
-	std::vector<vec3> position;
-	std::vector<uint8_t> labels;
-
-	for (int pointIdx = 0; pointIdx < _points.size(); ++pointIdx)
-	{
-		position.push_back(_points[pointIdx]._point);
-		labels.push_back(_points[pointIdx]._label);
-	}
-
-	const std::string componentName = "pointCloud";
-	pointCloud.add_properties_to_element(componentName, { "x", "y", "z" }, tinyply::Type::FLOAT32, position.size(), reinterpret_cast<uint8_t*>(position.data()), tinyply::Type::INVALID, 0);
-	pointCloud.add_properties_to_element(componentName, { "class" }, tinyply::Type::UINT8, labels.size(), reinterpret_cast<uint8_t*>(labels.data()), tinyply::Type::INVALID, 0);
-	pointCloud.write(outstream, !ascii);
-}
-
 bool PointCloud::writeToBinary(const std::string& filename)
 {
 	std::ofstream fout(filename, std::ios::out | std::ios::binary);
@@ -4,6 +4,7 @@
 #include "Graphics/Application/RenderingParameters.h"
 #include "Graphics/Core/Model3D.h"
 #include "tinyply/tinyply.h"
+#include "Utilities/MemoryTracker.h"
 
 /**
 *	@file Pix4DPointCloud.h
@@ -23,16 +24,21 @@ public:
 		unsigned	_label;
 	};
 
+public:
+	const static std::vector<std::string> LABEL_PROPERTY_NAMES;				//!< Vertex properties which may hold the semantic label, sorted by priority
+
 protected:
 	const static std::string	WRITE_POINT_CLOUD_FOLDER;					//!<
 
 protected:
+	std::string					_cacheSuffix;								//!< Appended to the name of caches of derived clouds, e.g. downsampled ones
 	std::string					_filename;									//!<
 	bool						_useBinary;									//!<
 
 	// Spatial information
 	AABB						_aabb;										//!<
 	std::vector<PointModel>		_points;									//!<		
+	MemoryTracker::Allocation	_pointsMemory;								//!< Bytes of _points reported to the memory tracker, updated after loading
 
 	// Classification
 	unsigned					_maxLabel;
@@ -73,11 +79,6 @@ protected:
 	*/
 	virtual void setVAOData();
 
-	/**
-	*	@brief
-	*/
-	void threadedWritePointCloud(const std::string& filename, const bool ascii);
-
 	/**
 	*	@brief Writes the model to a binary file in order to fasten the following executions.
 	*	@return Success of writing process.
@@ -95,6 +96,14 @@ public:
 	*/
 	virtual ~PointCloud();
 
+	/**
+	*	@brief Reduces the cloud to a point per occupied voxel of a regular grid over its AABB, e.g. for previews, so that far
+	*	fewer points are uploaded to GPU. Each point is the centroid of its voxel and carries the majority label. Its caches are named
+	*	after the resolution, so that they do not collide with those of the full-resolution cloud.
+	*	@return New point cloud, already loaded, which must be released by the caller.
+	*/
+	PointCloud* downsample(const uvec3& subdivisions);
+
 	/**
 	*	@brief Loads the point cloud, either from a binary or a PLY file.
 	*	@param modelMatrix Model transformation matrix.
@@ -102,15 +111,21 @@ public:
 	*/
 	virtual bool load(const mat4& modelMatrix = mat4(1.0f));
 
+	/**
+	*	@brief Discards the loaded points so that another file can be loaded into the same buffers, whose capacity is kept.
+	*/
+	void reset(const std::string& filename);
+
 	/**
 	*	@brief Updates the current Axis-Aligned Bounding-Box.
 	*/
 	void updateBoundaries(const vec3& xyz) { _aabb.update(xyz); }
 
 	/**
-	*	@brief Writes point cloud as a PLY file.
+	*	@brief Writes point cloud as a PLY file through the shared writer service. Points are copied before returning.
+	*	@return Future which reports completion or the error raised while writing.
 	*/
-	bool writePointCloud(const std::string& filename, const bool ascii);
+	std::future<bool> writePointCloud(const std::string& filename, const bool ascii);
 
 	// Getters
 
@@ -119,6 +134,11 @@ public:
 	*/
 	AABB getAABB() { return _aabb; }
 
+	/**
+	*	@return Path of caches derived from the point cloud, e.g. its level-of-detail hierarchy, with no extension.
+	*/
+	std::string getCacheFilename() { return _filename + _cacheSuffix; }
+
 	/**
 	*	@return Path where the point cloud is saved.
 	*/
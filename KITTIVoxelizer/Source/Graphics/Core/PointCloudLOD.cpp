@@ -0,0 +1,395 @@
+#include "stdafx.h"
+#include "PointCloudLOD.h"
+
+#include <array>
+#include <filesystem>
+#include <queue>
+#include "Graphics/Core/VAO.h"
+#include "Utilities/Profiler.h"
+
+// Initialization of static attributes
+const unsigned PointCloudLOD::GRID_SIZE = 128;
+const unsigned PointCloudLOD::MAX_DEPTH = 16;
+const unsigned PointCloudLOD::MAX_LEAF_POINTS = 20000;
+const uint32_t PointCloudLOD::CACHE_SIGNATURE = 0x31444F4C;			// LOD1
+
+/// [Public methods]
+
+PointCloudLOD::PointCloudLOD() : Model3D(mat4(1.0f), 1), _pointsMemory(MemoryTracker::POINTS), _numSourcePoints(0), _numSelectedPoints(0)
+{
+}
+
+PointCloudLOD::~PointCloudLOD()
+{
+}
+
+void PointCloudLOD::build(PointCloud* pointCloud)
+{
+	PROFILE_ZONE("PointCloudLOD::build");
+
+	const std::string cacheFilename = pointCloud->getCacheFilename() + LOD_EXTENSION, plyFilename = pointCloud->getFilename() + PLY_EXTENSION;
+	std::vector<PointCloud::PointModel>* points = pointCloud->getPoints();
+
+	// Caches older than the PLY file are outdated and therefore rebuilt, as binaries of point clouds
+	const bool cacheExists = std::filesystem::exists(cacheFilename) &&
+		(!std::filesystem::exists(plyFilename) || std::filesystem::last_write_time(cacheFilename) >= std::filesystem::last_write_time(plyFilename));
+
+	if (!cacheExists || !this->readCache(cacheFilename, points->size(), pointCloud->getAABB()))
+	{
+		this->buildHierarchy(*points, pointCloud->getAABB());
+		_numSourcePoints = points->size();
+		_sourceAABB = pointCloud->getAABB();
+
+		if (!this->writeCache(cacheFilename)) std::cerr << "Level-of-detail hierarchy could not be written in " << cacheFilename << std::endl;
+	}
+
+	_pointsMemory.resize(_points.capacity() * sizeof(PointCloud::PointModel));
+	_firstVertex.clear();
+	_numVertices.clear();
+	_numSelectedPoints = 0;
+	_loaded = false;
+}
+
+bool PointCloudLOD::load(const mat4& modelMatrix)
+{
+	if (!_loaded)
+	{
+		// Buffers of a previous hierarchy are replaced
+		delete _modelComp[0]->_vao;
+		_modelComp[0]->_vao = nullptr;
+
+		this->setVAOData();
+
+		return _loaded = true;
+	}
+
+	return false;
+}
+
+void PointCloudLOD::selectNodes(Camera* camera, const mat4& modelMatrix, unsigned pointBudget, float maxScreenSpacing)
+{
+	_firstVertex.clear();
+	_numVertices.clear();
+	_numSelectedPoints = 0;
+
+	if (_node.empty() || !camera) return;
+
+	const mat4 viewProjection = camera->getViewProjMatrix() * modelMatrix;
+	const float pixelScale = camera->getProjectionMatrix()[1][1] * camera->getHeight() / 2.0f;		// Pixels covered by a unit length at unit depth
+
+	// Planes are combinations of the rows of the matrix (Gribb & Hartmann), whereas GLM stores columns. Normals point to the inside
+	vec4 row[4];
+	for (int rowIdx = 0; rowIdx < 4; ++rowIdx) row[rowIdx] = vec4(viewProjection[0][rowIdx], viewProjection[1][rowIdx], viewProjection[2][rowIdx], viewProjection[3][rowIdx]);
+
+	const vec4 plane[6] = { row[3] + row[0], row[3] - row[0], row[3] + row[1], row[3] - row[1], row[3] + row[2], row[3] - row[2] };
+
+	auto isVisible = [&](const Node& node) -> bool
+	{
+		const vec3 halfSize = vec3(node._size / 2.0f), center = node._min + halfSize;
+
+		for (const vec4& p : plane)
+		{
+			if (p.x * center.x + p.y * center.y + p.z * center.z + p.w + glm::dot(glm::abs(vec3(p)), halfSize) < .0f) return false;
+		}
+
+		return true;
+	};
+
+	// Spacing of a node in pixels, measured at the depth of its center. Nodes around the camera are refined first
+	auto getScreenSpacing = [&](const Node& node) -> float
+	{
+		const float depth = (viewProjection * vec4(node._min + node._size / 2.0f, 1.0f)).w;
+
+		return node.getSpacing() * pixelScale / std::max(depth, 1e-4f);
+	};
+
+	std::priority_queue<std::pair<float, unsigned>> queue;
+	std::vector<std::pair<GLint, GLsizei>> range;
+
+	if (isVisible(_node[0])) queue.emplace(getScreenSpacing(_node[0]), 0);
+
+	while (!queue.empty())
+	{
+		const float screenSpacing = queue.top().first;
+		const unsigned nodeIdx = queue.top().second;
+		const Node& node = _node[nodeIdx];
+		queue.pop();
+
+		// The root is always drawn, even if it exceeds the budget by itself; other nodes that do not fit are skipped, as smaller ones may still fit
+		if (nodeIdx && _numSelectedPoints + node._numPoints > pointBudget) continue;
+
+		range.emplace_back(GLint(node._firstPoint), GLsizei(node._numPoints));
+		_numSelectedPoints += node._numPoints;
+
+		if (screenSpacing <= maxScreenSpacing) continue;
+
+		for (unsigned childIdx = node._firstChild; childIdx < node._firstChild + node._numChildren; ++childIdx)
+		{
+			if (isVisible(_node[childIdx])) queue.emplace(getScreenSpacing(_node[childIdx]), childIdx);
+		}
+	}
+
+	// Siblings are contiguous in the vertex buffer, hence sorted ranges are often merged
+	std::sort(range.begin(), range.end());
+
+	for (const std::pair<GLint, GLsizei>& nodeRange : range)
+	{
+		if (!_firstVertex.empty() && _firstVertex.back() + _numVertices.back() == nodeRange.first)
+		{
+			_numVertices.back() += nodeRange.second;
+		}
+		else
+		{
+			_firstVertex.push_back(nodeRange.first);
+			_numVertices.push_back(nodeRange.second);
+		}
+	}
+}
+
+/// [Protected methods]
+
+void PointCloudLOD::buildHierarchy(const std::vector<PointCloud::PointModel>& points, const AABB& aabb)
+{
+	PROFILE_ZONE("PointCloudLOD::buildHierarchy");
+
+	_node.clear();
+	_points.clear();
+
+	if (points.empty()) return;
+
+	// The root is a cube slightly larger than the point cloud, so that points on its maximum faces are not clamped
+	const vec3 extent = aabb.max() - aabb.min();
+	_node.push_back(Node{ aabb.min(), std::max(extent.x, std::max(extent.y, extent.z)) * 1.0001f + FLT_EPSILON, 0, 0, 0, 0 });
+
+	// Points of a node are a contiguous range of this array, which is partitioned in place into sampled points followed by the points of each child
+	std::vector<unsigned> order(points.size());
+	std::iota(order.begin(), order.end(), 0);
+
+	std::vector<unsigned> nodeBegin(1, 0), levelNode(1, 0);
+	std::vector<unsigned> nodeEnd(1, unsigned(points.size()));
+
+	for (unsigned depth = 0; !levelNode.empty(); ++depth)
+	{
+		std::vector<std::array<unsigned, 8>> childSize(levelNode.size());
+
+		std::vector<unsigned> levelIdx(levelNode.size());
+		std::iota(levelIdx.begin(), levelIdx.end(), 0);
+
+		std::for_each(std::execution::par, levelIdx.begin(), levelIdx.end(), [&](unsigned idx)
+			{
+				Node& node = _node[levelNode[idx]];
+				const unsigned begin = nodeBegin[levelNode[idx]], numPoints = nodeEnd[levelNode[idx]] - begin;
+
+				childSize[idx].fill(0);
+
+				if (numPoints <= MAX_LEAF_POINTS || depth == MAX_DEPTH)
+				{
+					node._numPoints = numPoints;
+					return;
+				}
+
+				// Points are sorted by cell, and the point closest to the center of each cell is kept
+				const float invCellSize = GRID_SIZE / node._size;
+				std::vector<uint64_t> key(numPoints);
+
+				for (unsigned pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+				{
+					const uvec3 cell = glm::min(uvec3((points[order[begin + pointIdx]]._point - node._min) * invCellSize), uvec3(GRID_SIZE - 1));
+					key[pointIdx] = (uint64_t((cell.x * GRID_SIZE + cell.y) * GRID_SIZE + cell.z) << 32) | order[begin + pointIdx];
+				}
+
+				std::sort(std::execution::par_unseq, key.begin(), key.end());
+
+				std::vector<unsigned> sampled, remaining;
+				std::vector<uint8_t> octant;
+				remaining.reserve(numPoints);
+				octant.reserve(numPoints);
+
+				for (unsigned firstIdx = 0, lastIdx; firstIdx < numPoints; firstIdx = lastIdx)
+				{
+					const unsigned cellIdx = unsigned(key[firstIdx] >> 32);
+					const uvec3 cell(cellIdx / (GRID_SIZE * GRID_SIZE), (cellIdx / GRID_SIZE) % GRID_SIZE, cellIdx % GRID_SIZE);
+					const vec3 cellCenter = node._min + (vec3(cell) + .5f) / invCellSize;
+					const uint8_t cellOctant = uint8_t((cell.x >= GRID_SIZE / 2) | (cell.y >= GRID_SIZE / 2) << 1 | (cell.z >= GRID_SIZE / 2) << 2);
+
+					unsigned closestIdx = firstIdx;
+					float closestDistance = FLT_MAX;
+
+					for (lastIdx = firstIdx; lastIdx < numPoints && unsigned(key[lastIdx] >> 32) == cellIdx; ++lastIdx)
+					{
+						const float distance = glm::distance2(points[unsigned(key[lastIdx])]._point, cellCenter);
+						if (distance < closestDistance)
+						{
+							closestDistance = distance;
+							closestIdx = lastIdx;
+						}
+					}
+
+					for (unsigned pointIdx = firstIdx; pointIdx < lastIdx; ++pointIdx)
+					{
+						if (pointIdx == closestIdx)
+						{
+							sampled.push_back(unsigned(key[pointIdx]));
+						}
+						else
+						{
+							remaining.push_back(unsigned(key[pointIdx]));
+							octant.push_back(cellOctant);
+							++childSize[idx][cellOctant];
+						}
+					}
+				}
+
+				// Counting sort of the remaining points by child
+				unsigned childBegin[8];
+				childBegin[0] = begin + unsigned(sampled.size());
+				for (int child = 1; child < 8; ++child) childBegin[child] = childBegin[child - 1] + childSize[idx][child - 1];
+
+				std::copy(sampled.begin(), sampled.end(), order.begin() + begin);
+				for (size_t pointIdx = 0; pointIdx < remaining.size(); ++pointIdx) order[childBegin[octant[pointIdx]]++] = remaining[pointIdx];
+
+				node._numPoints = unsigned(sampled.size());
+			});
+
+		// Children are appended level by level, so that nodes are sorted breadth-first and siblings are contiguous
+		std::vector<unsigned> nextLevelNode;
+
+		for (size_t idx = 0; idx < levelNode.size(); ++idx)
+		{
+			const unsigned nodeIdx = levelNode[idx];
+			unsigned childBegin = nodeBegin[nodeIdx] + _node[nodeIdx]._numPoints;
+
+			_node[nodeIdx]._firstChild = unsigned(_node.size());
+
+			for (unsigned child = 0; child < 8; ++child)
+			{
+				if (!childSize[idx][child]) continue;
+
+				const float halfSize = _node[nodeIdx]._size / 2.0f;
+				const vec3 childMin = _node[nodeIdx]._min + vec3(child & 1, (child >> 1) & 1, (child >> 2) & 1) * halfSize;
+
+				nextLevelNode.push_back(unsigned(_node.size()));
+				nodeBegin.push_back(childBegin);
+				nodeEnd.push_back(childBegin + childSize[idx][child]);
+				_node.push_back(Node{ childMin, halfSize, 0, 0, 0, 0 });
+
+				childBegin += childSize[idx][child];
+				++_node[nodeIdx]._numChildren;
+			}
+		}
+
+		levelNode.swap(nextLevelNode);
+	}
+
+	// Sampled points are gathered in node order
+	for (size_t nodeIdx = 1; nodeIdx < _node.size(); ++nodeIdx) _node[nodeIdx]._firstPoint = _node[nodeIdx - 1]._firstPoint + _node[nodeIdx - 1]._numPoints;
+	_points.resize(points.size());
+
+	std::vector<unsigned> nodeIdx(_node.size());
+	std::iota(nodeIdx.begin(), nodeIdx.end(), 0);
+
+	std::for_each(std::execution::par_unseq, nodeIdx.begin(), nodeIdx.end(), [&](unsigned idx)
+		{
+			for (unsigned pointIdx = 0; pointIdx < _node[idx]._numPoints; ++pointIdx) _points[_node[idx]._firstPoint + pointIdx] = points[order[nodeBegin[idx] + pointIdx]];
+		});
+}
+
+bool PointCloudLOD::readCache(const std::string& filename, size_t numSourcePoints, const AABB& sourceAABB)
+{
+	PROFILE_ZONE("PointCloudLOD::readCache");
+
+	std::ifstream in(filename, std::ios::in | std::ios::binary);
+	if (!in.is_open()) return false;
+
+	uint32_t signature, numNodes;
+	uint64_t numPoints, numCachedSourcePoints;
+	vec3 aabbMin, aabbMax;
+
+	in.read((char*)&signature, sizeof(uint32_t));
+	in.read((char*)&numCachedSourcePoints, sizeof(uint64_t));
+	in.read((char*)&aabbMin, sizeof(vec3));
+	in.read((char*)&aabbMax, sizeof(vec3));
+	in.read((char*)&numNodes, sizeof(uint32_t));
+	in.read((char*)&numPoints, sizeof(uint64_t));
+
+	// Every node samples at least one point, hence there cannot be more nodes than points
+	if (in.fail() || signature != CACHE_SIGNATURE || numCachedSourcePoints != numSourcePoints || numPoints != numSourcePoints ||
+		aabbMin != sourceAABB.min() || aabbMax != sourceAABB.max() || numNodes > numPoints || (numNodes == 0) != (numPoints == 0))
+	{
+		return false;
+	}
+
+	std::vector<Node> node(numNodes);
+	std::vector<PointCloud::PointModel> points(numPoints);
+
+	in.read((char*)node.data(), node.size() * sizeof(Node));
+	in.read((char*)points.data(), points.size() * sizeof(PointCloud::PointModel));
+	if (in.fail()) return false;
+
+	// Point ranges must be contiguous and cover every point, whereas children must follow their parent, as written by buildHierarchy.
+	// Otherwise, selectNodes could draw out of the vertex buffer or loop forever
+	uint64_t pointEnd = 0;
+
+	for (size_t nodeIdx = 0; nodeIdx < node.size(); ++nodeIdx)
+	{
+		const Node& currentNode = node[nodeIdx];
+
+		if (currentNode._firstPoint != pointEnd || !currentNode._numPoints || uint64_t(currentNode._firstPoint) + currentNode._numPoints > numPoints ||
+			currentNode._numChildren > 8 || (currentNode._numChildren && (currentNode._firstChild <= nodeIdx || uint64_t(currentNode._firstChild) + currentNode._numChildren > numNodes)))
+		{
+			return false;
+		}
+
+		pointEnd += currentNode._numPoints;
+	}
+
+	if (pointEnd != numPoints) return false;
+
+	_node = std::move(node);
+	_points = std::move(points);
+	_numSourcePoints = numSourcePoints;
+	_sourceAABB = sourceAABB;
+
+	return true;
+}
+
+void PointCloudLOD::renderPoints(RenderingShader* shader, const RendEnum::RendShaderTypes shaderType, std::vector<mat4>& matrix, ModelComponent* modelComp, const GLuint primitive)
+{
+	VAO* vao = modelComp->_vao;
+
+	if (vao && !_firstVertex.empty() && modelComp->_enabled)
+	{
+		this->setShaderUniforms(shader, shaderType, matrix);
+
+		vao->drawObject(primitive, _firstVertex, _numVertices);
+	}
+}
+
+void PointCloudLOD::setVAOData()
+{
+	VAO* vao = new VAO(false);
+
+	vao->setVBOData(RendEnum::VBO_POSITION, _points, GL_STATIC_DRAW);
+	_modelComp[0]->_vao = vao;
+}
+
+bool PointCloudLOD::writeCache(const std::string& filename)
+{
+	std::ofstream out(filename, std::ios::out | std::ios::binary);
+	if (!out.is_open()) return false;
+
+	const uint32_t numNodes = uint32_t(_node.size());
+	const uint64_t numPoints = _points.size(), numSourcePoints = _numSourcePoints;
+	const vec3 aabbMin = _sourceAABB.min(), aabbMax = _sourceAABB.max();
+
+	out.write((char*)&CACHE_SIGNATURE, sizeof(uint32_t));
+	out.write((char*)&numSourcePoints, sizeof(uint64_t));
+	out.write((char*)&aabbMin, sizeof(vec3));
+	out.write((char*)&aabbMax, sizeof(vec3));
+	out.write((char*)&numNodes, sizeof(uint32_t));
+	out.write((char*)&numPoints, sizeof(uint64_t));
+	out.write((char*)_node.data(), _node.size() * sizeof(Node));
+	out.write((char*)_points.data(), _points.size() * sizeof(PointCloud::PointModel));
+
+	return !out.fail();
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "Geometry/3D/AABB.h"
+#include "Graphics/Core/Camera.h"
+#include "Graphics/Core/PointCloud.h"
+#include "Utilities/MemoryTracker.h"
+
+/**
+*	@file PointCloudLOD.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 19/10/2026
+*/
+
+#define LOD_EXTENSION ".lod"
+
+/**
+*	@brief Level-of-detail hierarchy of a point cloud, similar to Potree. Each node of an octree keeps a subsample of the points within
+*	its cube, at most one per cell of a GRID_SIZE^3 grid, so that the spacing between points halves at each level; remaining points
+*	are handed to the children. Points are stored by node in breadth-first order, hence a node is a contiguous range of the vertex buffer
+*	and any subset of nodes is drawn with a single call. Nodes are selected each frame by their projected spacing under a point budget.
+*/
+class PointCloudLOD: public Model3D
+{
+public:
+	const static unsigned	GRID_SIZE;								//!< Sampling cells per axis of a node
+	const static unsigned	MAX_DEPTH;								//!< Nodes at this depth keep every remaining point
+	const static unsigned	MAX_LEAF_POINTS;						//!< Nodes with fewer points than this keep all of them
+
+protected:
+	const static uint32_t	CACHE_SIGNATURE;						//!< First bytes of cached hierarchies
+
+	/**
+	*	@brief Octree node, whose points and children are contiguous ranges.
+	*/
+	struct Node
+	{
+		vec3		_min;											//!< Lowest corner of the cube
+		float		_size;											//!< Edge length of the cube
+		unsigned	_firstPoint;									//!< First point in the vertex buffer
+		unsigned	_numPoints;										//!< Points sampled by this node
+		unsigned	_firstChild;									//!< Index of the first child node
+		unsigned	_numChildren;									//!< Number of non-empty children
+
+		/**
+		*	@return Minimum distance between the points of this node.
+		*/
+		float getSpacing() const { return _size / GRID_SIZE; }
+	};
+
+protected:
+	std::vector<Node>							_node;				//!< Nodes in breadth-first order
+	std::vector<PointCloud::PointModel>			_points;			//!< Points sorted by node
+	MemoryTracker::Allocation					_pointsMemory;		//!< Bytes of _points reported to the memory tracker
+	size_t										_numSourcePoints;	//!< Size of the cloud the hierarchy was built from, to validate the cache
+	AABB										_sourceAABB;		//!< Bounds of the cloud the hierarchy was built from, to validate the cache
+
+	// Selection
+	std::vector<GLint>							_firstVertex;		//!< First point of each selected node
+	std::vector<GLsizei>						_numVertices;		//!< Points of each selected node
+	unsigned									_numSelectedPoints;	//!< Points drawn in the last frame
+
+protected:
+	/**
+	*	@brief Builds the hierarchy on CPU. Nodes of the same level are sampled in parallel.
+	*/
+	void buildHierarchy(const std::vector<PointCloud::PointModel>& points, const AABB& aabb);
+
+	/**
+	*	@brief Loads a hierarchy written by writeCache. Point and child ranges of every node are validated.
+	*	@return False if the file could not be read, is corrupted or belongs to another point cloud.
+	*/
+	bool readCache(const std::string& filename, size_t numSourcePoints, const AABB& sourceAABB);
+
+	/**
+	*	@brief Renders the selected nodes.
+	*/
+	virtual void renderPoints(RenderingShader* shader, const RendEnum::RendShaderTypes shaderType, std::vector<mat4>& matrix, ModelComponent* modelComp, const GLuint primitive);
+
+	/**
+	*	@brief Communicates the sorted points to GPU.
+	*/
+	virtual void setVAOData();
+
+	/**
+	*	@brief Writes the hierarchy so that following executions skip the building stage.
+	*	@return Success of writing process.
+	*/
+	bool writeCache(const std::string& filename);
+
+public:
+	/**
+	*	@brief Constructor of an empty hierarchy.
+	*/
+	PointCloudLOD();
+
+	/**
+	*	@brief Invalid copy constructor.
+	*/
+	PointCloudLOD(const PointCloudLOD& pointCloudLOD) = delete;
+
+	/**
+	*	@brief Destructor.
+	*/
+	virtual ~PointCloudLOD();
+
+	/**
+	*	@brief Replaces the hierarchy with that of a point cloud. The hierarchy is read from the cache next to the point cloud if it is
+	*	up to date, and built and cached otherwise. No OpenGL context is required until the hierarchy is loaded.
+	*/
+	void build(PointCloud* pointCloud);
+
+	/**
+	*	@brief Uploads the last built hierarchy to GPU.
+	*	@return True if the hierarchy was uploaded, false if it was already loaded.
+	*/
+	virtual bool load(const mat4& modelMatrix = mat4(1.0f));
+
+	/**
+	*	@brief Selects the nodes to be drawn from a camera. Nodes are refined from the root by decreasing projected spacing while it exceeds
+	*	maxScreenSpacing pixels, skipping those that do not fit in pointBudget points. The root is drawn regardless of the budget, whereas
+	*	nodes out of the frustum are skipped.
+	*/
+	void selectNodes(Camera* camera, const mat4& modelMatrix, unsigned pointBudget, float maxScreenSpacing);
+
+	/**
+	*	@return Number of nodes.
+	*/
+	unsigned getNumNodes() const { return unsigned(_node.size()); }
+
+	/**
+	*	@return Number of points of the hierarchy.
+	*/
+	unsigned getNumPoints() const { return unsigned(_points.size()); }
+
+	/**
+	*	@return Number of points selected by the last call to selectNodes.
+	*/
+	unsigned getNumSelectedPoints() const { return _numSelectedPoints; }
+
+	/**
+	*	@brief Assignment operator is not allowed.
+	*/
+	PointCloudLOD& operator=(const PointCloudLOD& pointCloudLOD) = delete;
+};
+
@@ -0,0 +1,138 @@
+#include "stdafx.h"
+#include "PointCloudWriter.h"
+
+// Initialization of static attributes
+const unsigned PointCloudWriter::NUM_BUFFERS = 4;
+const unsigned PointCloudWriter::NUM_THREADS = 2;
+
+/// [Public methods]
+
+PointCloudWriter::~PointCloudWriter()
+{
+	_freeBuffer->close();
+	_pendingBuffer->close();
+
+	for (std::thread& thread : _thread)
+		if (thread.joinable()) thread.join();
+}
+
+void PointCloudWriter::flush()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_finished.wait(lock, [this] { return _numPending == 0; });
+}
+
+void PointCloudWriter::shutdown()
+{
+	this->flush();
+
+	// Queued buffers are still popped after closing, whereas blocked writers are woken up and fail
+	_freeBuffer->close();
+	_pendingBuffer->close();
+
+	for (std::thread& thread : _thread)
+		if (thread.joinable()) thread.join();
+}
+
+std::future<bool> PointCloudWriter::write(const std::vector<PointCloud::PointModel>& points, const std::string& filename, const bool ascii)
+{
+	StagingBufferPtr buffer;
+
+	if (!_freeBuffer->pop(buffer))
+	{
+		// Service already shut down
+		std::promise<bool> promise;
+		promise.set_value(false);
+
+		return promise.get_future();
+	}
+
+	buffer->_filename = filename;
+	buffer->_ascii = ascii;
+	buffer->_promise = std::promise<bool>();
+
+	// Buffers keep their capacity, hence only the largest point cloud so far triggers an allocation
+	buffer->_position.resize(points.size());
+	buffer->_label.resize(points.size());
+
+	std::transform(std::execution::par_unseq, points.begin(), points.end(), buffer->_position.begin(), [](const PointCloud::PointModel& point) { return point._point; });
+	std::transform(std::execution::par_unseq, points.begin(), points.end(), buffer->_label.begin(), [](const PointCloud::PointModel& point) { return uint16_t(std::min(point._label, unsigned(UINT16_MAX))); });
+
+	std::future<bool> future = buffer->_promise.get_future();
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		++_numPending;
+	}
+
+	if (!_pendingBuffer->push(std::move(buffer)))
+	{
+		// Only reachable while shutting down; buffer was not moved
+		buffer->_promise.set_value(false);
+		_freeBuffer->push(std::move(buffer));
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		--_numPending;
+	}
+
+	return future;
+}
+
+/// [Protected methods]
+
+PointCloudWriter::PointCloudWriter() : _numPending(0)
+{
+	_freeBuffer.reset(new BoundedQueue<StagingBufferPtr>(NUM_BUFFERS));
+	_pendingBuffer.reset(new BoundedQueue<StagingBufferPtr>(NUM_BUFFERS));
+
+	for (unsigned bufferIdx = 0; bufferIdx < NUM_BUFFERS; ++bufferIdx)
+		_freeBuffer->push(StagingBufferPtr(new StagingBuffer()));
+
+	for (unsigned threadIdx = 0; threadIdx < NUM_THREADS; ++threadIdx)
+		_thread.push_back(std::thread(&PointCloudWriter::writePointClouds, this));
+}
+
+void PointCloudWriter::writePointClouds()
+{
+	StagingBufferPtr buffer;
+
+	while (_pendingBuffer->pop(buffer))
+	{
+		try
+		{
+			writePointCloud(*buffer);
+			buffer->_promise.set_value(true);
+		}
+		catch (...)
+		{
+			buffer->_promise.set_exception(std::current_exception());
+		}
+
+		_freeBuffer->push(std::move(buffer));
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			--_numPending;
+		}
+
+		_finished.notify_all();
+	}
+}
+
+void PointCloudWriter::writePointCloud(StagingBuffer& buffer)
+{
+	std::filebuf fileBuffer;
+	fileBuffer.open(buffer._filename, buffer._ascii ? std::ios::out : std::ios::out | std::ios::binary);
+
+	std::ostream outstream(&fileBuffer);
+	if (!fileBuffer.is_open() || outstream.fail()) throw std::runtime_error("Failed to open " + buffer._filename + ".");
+
+	tinyply::PlyFile pointCloud;
+
+	const std::string componentName = "vertex";
+	pointCloud.add_properties_to_element(componentName, { "x", "y", "z" }, tinyply::Type::FLOAT32, buffer._position.size(), reinterpret_cast<uint8_t*>(buffer._position.data()), tinyply::Type::INVALID, 0);
+	pointCloud.add_properties_to_element(componentName, { PointCloud::LABEL_PROPERTY_NAMES.front() }, tinyply::Type::UINT16, buffer._label.size(), reinterpret_cast<uint8_t*>(buffer._label.data()), tinyply::Type::INVALID, 0);
+	pointCloud.write(outstream, !buffer._ascii);
+
+	if (outstream.fail()) throw std::runtime_error("Failed to write " + buffer._filename + ".");
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "DataStructures/BoundedQueue.h"
+#include "Graphics/Core/PointCloud.h"
+#include "Utilities/Singleton.h"
+
+/**
+*	@file PointCloudWriter.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Service which writes point clouds as PLY files on a fixed pool of threads. Points are copied into reusable staging buffers,
+*	so that the source point cloud can be modified or deleted as soon as a write is submitted. Files hold a vertex element with the
+*	first label property of PointCloud, hence they are read back by PointCloud.
+*/
+class PointCloudWriter: public Singleton<PointCloudWriter>
+{
+	friend class Singleton<PointCloudWriter>;
+
+protected:
+	const static unsigned		NUM_BUFFERS;						//!< Maximum number of point clouds waiting to be written
+	const static unsigned		NUM_THREADS;						//!< Number of threads writing to disk
+
+protected:
+	struct StagingBuffer
+	{
+		std::string				_filename;							//!< Destination of the PLY file
+		bool					_ascii;								//!< Encoding of the PLY file
+		std::vector<vec3>		_position;							//!< Copy of point positions
+		std::vector<uint16_t>	_label;								//!< Copy of point labels, saturated to 16 bits
+		std::promise<bool>		_promise;							//!< Notifies completion or failure
+	};
+
+	typedef std::unique_ptr<StagingBuffer> StagingBufferPtr;
+
+protected:
+	std::unique_ptr<BoundedQueue<StagingBufferPtr>>	_freeBuffer;	//!< Buffers available for new writes
+	std::unique_ptr<BoundedQueue<StagingBufferPtr>>	_pendingBuffer;	//!< Buffers waiting to be written
+	std::vector<std::thread>						_thread;		//!< Writing threads
+
+	// Completion of pending writes
+	std::mutex										_mutex;			//!< Protects the number of pending writes
+	std::condition_variable							_finished;		//!< Wakes up threads waiting for a flush
+	unsigned										_numPending;	//!< Writes submitted but not finished yet
+
+protected:
+	/**
+	*	@brief Constructor. Staging buffers and threads are created at once.
+	*/
+	PointCloudWriter();
+
+	/**
+	*	@brief Writes the queued point clouds until the service is shut down.
+	*/
+	void writePointClouds();
+
+	/**
+	*	@brief Writes a staging buffer as a PLY file.
+	*/
+	static void writePointCloud(StagingBuffer& buffer);
+
+public:
+	/**
+	*	@brief Destructor. Threads are only joined here if shutdown() was not called.
+	*/
+	virtual ~PointCloudWriter();
+
+	/**
+	*	@brief Blocks until every submitted point cloud has been written.
+	*/
+	void flush();
+
+	/**
+	*	@brief Writes every submitted point cloud and joins the threads. Any later write fails. Meant to be called once the application
+	*	finishes, rather than relying on the destruction of static instances.
+	*/
+	void shutdown();
+
+	/**
+	*	@brief Copies the points into a staging buffer and queues them to be written. Blocks while every buffer is in use.
+	*	@return Future which is true once the file is written, or holds the exception thrown while writing. It is false at once if the
+	*	service was shut down.
+	*/
+	std::future<bool> write(const std::vector<PointCloud::PointModel>& points, const std::string& filename, const bool ascii);
+};
+
@@ -59,6 +59,33 @@ void VAO::drawObject(const GLuint openGLPrimitive, const GLuint numVertices, con
 	}
 }
 
+void VAO::drawObject(const GLuint openGLPrimitive, const std::vector<GLint>& firstVertex, const std::vector<GLsizei>& numVertices)
+{
+	glBindVertexArray(_vao);
+	{
+		glMultiDrawArrays(openGLPrimitive, firstVertex.data(), numVertices.data(), GLsizei(std::min(firstVertex.size(), numVertices.size())));
+	}
+}
+
+void VAO::drawObjectIndirect(const RendEnum::IBOTypes iboType, const GLuint openGLPrimitive, const GLuint indirectBuffer, const GLuint numCommands)
+{
+	glBindVertexArray(_vao);
+	{
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ibo[iboType]);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+		glMultiDrawElementsIndirect(openGLPrimitive, GL_UNSIGNED_INT, nullptr, numCommands, 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+}
+
+void VAO::enableVBO(const RendEnum::VBOTypes vboType, const bool enable)
+{
+	glBindVertexArray(_vao);
+
+	if (enable)	glEnableVertexAttribArray(vboType);
+	else		glDisableVertexAttribArray(vboType);
+}
+
 void VAO::setVBOData(const std::vector<Model3D::VertexGPUData>& geometryData, const GLuint changeFrequency)
 {
 	glBindVertexArray(_vao);
@@ -80,6 +80,13 @@ public:
 	template<typename T, typename Z>
 	int defineMultiInstancingVBO(const RendEnum::VBOTypes vboType, const T dataExample, const Z dataPrimitive, const GLuint openGLBasicType);
 
+	/**
+	*	@brief Defines a per-instance VBO whose values are read as integers by shaders, instead of being converted to floats.
+	*	@param openGLBasicType Integer primitive of data: GL_UNSIGNED_INT, etc.
+	*/
+	template<typename T, typename Z>
+	int defineMultiInstancingIntegerVBO(const RendEnum::VBOTypes vboType, const T dataExample, const Z dataPrimitive, const GLuint openGLBasicType);
+
 	/**
 	*	@brief Draws an object with an specific topology.
 	*	@param type IBO que debemos utilizar para dibujar el objeto.
@@ -106,6 +113,25 @@ public:
 	*/
 	void drawObject(const GLuint openGLPrimitive, const GLuint numIndices, const GLuint numObjects);
 
+	/**
+	*	@brief Draws several ranges of vertices with a single call, with no index buffer.
+	*	@param firstVertex First vertex of each range.
+	*	@param numVertices Number of vertices of each range.
+	*/
+	void drawObject(const GLuint openGLPrimitive, const std::vector<GLint>& firstVertex, const std::vector<GLsizei>& numVertices);
+
+	/**
+	*	@brief Draws several ranges of instances of an object with a single call.
+	*	@param indirectBuffer Buffer of DrawElementsIndirectCommand, one per range.
+	*	@param numCommands Number of commands to be read from indirectBuffer.
+	*/
+	void drawObjectIndirect(const RendEnum::IBOTypes iboType, const GLuint openGLPrimitive, const GLuint indirectBuffer, const GLuint numCommands);
+
+	/**
+	*	@brief Enables or disables the shader input of a VBO. Disabled inputs are not read while drawing, so that their VBO may be left empty.
+	*/
+	void enableVBO(const RendEnum::VBOTypes vboType, const bool enable);
+
 	/**
 	*	@brief Sets data in the VBO.
 	*	@param vboType VBO to be modified.
@@ -122,6 +148,14 @@ public:
 	template<typename T>
 	void setVBOData(const RendEnum::VBOTypes vboType, T* geometryData, const GLuint size, const GLuint changeFrequency = GL_STATIC_DRAW);
 
+	/**
+	*	@brief Overwrites a range of a VBO whose storage was already allocated by setVBOData.
+	*	@param firstElement Index of the first element to be replaced.
+	*	@param numElements Number of elements read from geometryData.
+	*/
+	template<typename T>
+	void setVBOSubData(const RendEnum::VBOTypes vboType, const T* geometryData, const GLuint firstElement, const GLuint numElements);
+
 	/**
 	*	@brief Sets the VertexGPUData in VBO.
 	*/
@@ -163,6 +197,24 @@ inline int VAO::defineMultiInstancingVBO(const RendEnum::VBOTypes vboType, const
 	return vboType;
 }
 
+template<typename T, typename Z>
+inline int VAO::defineMultiInstancingIntegerVBO(const RendEnum::VBOTypes vboType, const T dataExample, const Z dataPrimitive, const GLuint openGLBasicType)
+{
+	glBindVertexArray(_vao);
+
+	// VBOs
+	glGenBuffers(1, &_vbo[vboType]);
+	glBindBuffer(GL_ARRAY_BUFFER, _vbo[vboType]);
+
+	// Offset
+	glEnableVertexAttribArray(vboType);
+	glVertexAttribIPointer(vboType, sizeof(dataExample) / sizeof(dataPrimitive), openGLBasicType, sizeof(dataExample), (GLubyte*)nullptr);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glVertexAttribDivisor(vboType, 1);
+
+	return vboType;
+}
+
 template<typename T>
 void VAO::setVBOData(const RendEnum::VBOTypes vboType, const std::vector<T>& geometryData, const GLuint changeFrequency)
 {
@@ -198,3 +250,10 @@ void VAO::setVBOData(const RendEnum::VBOTypes vboType, T* geometryData, const GL
 		glBufferData(GL_ARRAY_BUFFER, size * sizeof(T), geometryData, changeFrequency);
 	}
 }
+
+template<typename T>
+void VAO::setVBOSubData(const RendEnum::VBOTypes vboType, const T* geometryData, const GLuint firstElement, const GLuint numElements)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, _vbo[vboType]);
+	glBufferSubData(GL_ARRAY_BUFFER, GLintptr(firstElement) * sizeof(T), GLsizeiptr(numElements) * sizeof(T), geometryData);
+}
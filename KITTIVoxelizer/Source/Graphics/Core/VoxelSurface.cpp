@@ -0,0 +1,291 @@
+#include "stdafx.h"
+#include "VoxelSurface.h"
+
+#include <iomanip>
+#include "Graphics/Core/VAO.h"
+#include "tinyply/tinyply.h"
+#include "Utilities/Profiler.h"
+
+// Initialization of static attributes
+const unsigned VoxelSurface::SLAB_SIZE = 8;
+
+/// [Public methods]
+
+VoxelSurface::VoxelSurface() : Model3D(mat4(1.0f), 1), _numQuads(0)
+{
+}
+
+VoxelSurface::~VoxelSurface()
+{
+}
+
+bool VoxelSurface::exportOBJ(const std::string& filename) const
+{
+	PROFILE_ZONE("VoxelSurface::exportOBJ");
+
+	std::ofstream out(filename, std::ios::out);
+	if (!out.is_open()) return false;
+
+	const std::vector<VertexGPUData>& geometry = _modelComp[0]->_geometry;
+
+	out << std::setprecision(9);
+	out << "# Voxel surface: " << geometry.size() << " vertices, " << _numQuads << " rectangles" << "\n";
+
+	for (const VertexGPUData& vertex : geometry) out << "v " << vertex._position.x << " " << vertex._position.y << " " << vertex._position.z << "\n";
+
+	// Rectangles are axis-aligned, hence normals are shared: +X, -X, +Y, -Y, +Z, -Z
+	for (unsigned axis = 0; axis < 3; ++axis)
+	{
+		vec3 normal(.0f);
+		normal[axis] = 1.0f;
+
+		out << "vn " << normal.x << " " << normal.y << " " << normal.z << "\n";
+		out << "vn " << -normal.x << " " << -normal.y << " " << -normal.z << "\n";
+	}
+
+	std::vector<unsigned> quadIdx(_numQuads);
+	std::iota(quadIdx.begin(), quadIdx.end(), 0);
+	std::stable_sort(quadIdx.begin(), quadIdx.end(), [&](unsigned a, unsigned b) { return _label[a * 4] < _label[b * 4]; });
+
+	float currentLabel = -1.0f;
+
+	for (const unsigned quad : quadIdx)
+	{
+		if (_label[quad * 4] != currentLabel)
+		{
+			currentLabel = _label[quad * 4];
+			out << "g label_" << unsigned(currentLabel) << "\n";
+		}
+
+		const vec3& normal = geometry[quad * 4]._normal;
+		const unsigned axis = normal.x != .0f ? 0 : (normal.y != .0f ? 1 : 2), normalIdx = axis * 2 + (normal[axis] < .0f) + 1;
+		const size_t vertexIdx = size_t(quad) * 4 + 1;						// OBJ indices start at one
+
+		out << "f";
+		for (unsigned corner = 0; corner < 4; ++corner) out << " " << vertexIdx + corner << "//" << normalIdx;
+		out << "\n";
+	}
+
+	return !out.fail();
+}
+
+bool VoxelSurface::exportPLY(const std::string& filename, const bool ascii) const
+{
+	PROFILE_ZONE("VoxelSurface::exportPLY");
+
+	const std::vector<VertexGPUData>& geometry = _modelComp[0]->_geometry;
+	std::vector<vec3> position(geometry.size()), normal(geometry.size());
+	std::vector<uvec3> triangle(size_t(_numQuads) * 2);
+	std::vector<uint16_t> label(size_t(_numQuads) * 2);
+
+	for (size_t vertexIdx = 0; vertexIdx < geometry.size(); ++vertexIdx)
+	{
+		position[vertexIdx] = geometry[vertexIdx]._position;
+		normal[vertexIdx] = geometry[vertexIdx]._normal;
+	}
+
+	for (size_t quad = 0; quad < _numQuads; ++quad)
+	{
+		const unsigned firstVertex = unsigned(quad * 4);
+
+		triangle[quad * 2] = uvec3(firstVertex, firstVertex + 1, firstVertex + 2);
+		triangle[quad * 2 + 1] = uvec3(firstVertex, firstVertex + 2, firstVertex + 3);
+		label[quad * 2] = label[quad * 2 + 1] = uint16_t(_label[firstVertex]);
+	}
+
+	std::filebuf fileBuffer;
+	fileBuffer.open(filename, ascii ? std::ios::out : std::ios::out | std::ios::binary);
+
+	std::ostream outstream(&fileBuffer);
+	if (!fileBuffer.is_open() || outstream.fail()) return false;
+
+	tinyply::PlyFile surface;
+	surface.add_properties_to_element("vertex", { "x", "y", "z" }, tinyply::Type::FLOAT32, position.size(), reinterpret_cast<uint8_t*>(position.data()), tinyply::Type::INVALID, 0);
+	surface.add_properties_to_element("vertex", { "nx", "ny", "nz" }, tinyply::Type::FLOAT32, normal.size(), reinterpret_cast<uint8_t*>(normal.data()), tinyply::Type::INVALID, 0);
+	surface.add_properties_to_element("face", { "vertex_indices" }, tinyply::Type::UINT32, triangle.size(), reinterpret_cast<uint8_t*>(triangle.data()), tinyply::Type::UINT8, 3);
+	surface.add_properties_to_element("face", { "class" }, tinyply::Type::UINT16, label.size(), reinterpret_cast<uint8_t*>(label.data()), tinyply::Type::INVALID, 0);
+	surface.write(outstream, !ascii);
+
+	return !outstream.fail();
+}
+
+void VoxelSurface::extract(RegularGrid* grid)
+{
+	PROFILE_ZONE("VoxelSurface::extract");
+
+	struct Slab
+	{
+		unsigned	_axis, _firstSlice, _lastSlice;
+	};
+
+	const uvec3 numDivs = grid->getNumSubdivisions();
+	const AABB aabb = grid->getAABB();
+	const vec3 cellSize = (aabb.max() - aabb.min()) / vec3(numDivs);
+	const uint16_t* voxels = grid->data();
+
+	// Each axis has a slice more than voxels, as the plane behind the last voxel is also meshed
+	std::vector<Slab> slabs;
+
+	for (unsigned axis = 0; axis < 3; ++axis)
+	{
+		for (unsigned firstSlice = 0; firstSlice <= numDivs[axis]; firstSlice += SLAB_SIZE)
+			slabs.push_back(Slab{ axis, firstSlice, std::min(firstSlice + SLAB_SIZE, numDivs[axis] + 1) });
+	}
+
+	std::vector<std::vector<Quad>> slabQuads(slabs.size());
+	std::vector<size_t> slabIdx(slabs.size());
+	std::iota(slabIdx.begin(), slabIdx.end(), 0);
+
+	{
+		PROFILE_ZONE("mesh");
+
+		std::for_each(std::execution::par, slabIdx.begin(), slabIdx.end(), [&](const size_t idx)
+		{
+			meshSlab(voxels, numDivs, slabs[idx]._axis, slabs[idx]._firstSlice, slabs[idx]._lastSlice, slabQuads[idx]);
+		});
+	}
+
+	// Rectangles are gathered in slab order, so that the mesh does not depend on scheduling
+	std::vector<size_t> firstQuad(slabs.size() + 1, 0);
+	for (size_t idx = 0; idx < slabs.size(); ++idx) firstQuad[idx + 1] = firstQuad[idx] + slabQuads[idx].size();
+
+	ModelComponent* modelComp = _modelComp[0];
+	_numQuads = unsigned(firstQuad.back());
+	_label.resize(size_t(_numQuads) * 4);
+
+	modelComp->_geometry.resize(size_t(_numQuads) * 4);
+	modelComp->_triangleMesh.resize(size_t(_numQuads) * 8);
+	modelComp->_pointCloud.clear();
+	modelComp->_wireframe.clear();
+
+	{
+		PROFILE_ZONE("triangulate");
+
+		std::for_each(std::execution::par, slabIdx.begin(), slabIdx.end(), [&](const size_t idx)
+		{
+			for (size_t quadIdx = 0; quadIdx < slabQuads[idx].size(); ++quadIdx)
+			{
+				const Quad& quad = slabQuads[idx][quadIdx];
+				const size_t firstVertex = (firstQuad[idx] + quadIdx) * 4;
+				const unsigned u = (quad._axis + 1) % 3, v = (quad._axis + 2) % 3;
+
+				vec3 normal(.0f), tangent(.0f), du(.0f), dv(.0f);
+				normal[quad._axis] = quad._positive ? 1.0f : -1.0f;
+				tangent[u] = 1.0f;
+				du[u] = float(quad._size.x);
+				dv[v] = float(quad._size.y);
+
+				// u x v is the positive normal axis, hence corners are counter-clockwise when seen from the positive side, and reversed otherwise
+				const vec3 origin = vec3(quad._origin), corner[4] = { origin, origin + du, origin + du + dv, origin + dv };
+
+				for (unsigned cornerIdx = 0; cornerIdx < 4; ++cornerIdx)
+				{
+					VertexGPUData& vertex = modelComp->_geometry[firstVertex + cornerIdx];
+					vertex = VertexGPUData{};
+					vertex._position = aabb.min() + corner[quad._positive ? cornerIdx : (4 - cornerIdx) % 4] * cellSize;
+					vertex._normal = normal;
+					vertex._tangent = tangent;
+
+					_label[firstVertex + cornerIdx] = quad._label;
+				}
+
+				GLuint* triangles = &modelComp->_triangleMesh[firstVertex * 2];
+				const GLuint firstIndex = GLuint(firstVertex);
+
+				triangles[0] = firstIndex; triangles[1] = firstIndex + 1; triangles[2] = firstIndex + 2; triangles[3] = RESTART_PRIMITIVE_INDEX;
+				triangles[4] = firstIndex; triangles[5] = firstIndex + 2; triangles[6] = firstIndex + 3; triangles[7] = RESTART_PRIMITIVE_INDEX;
+			}
+		});
+	}
+
+	_loaded = false;
+}
+
+bool VoxelSurface::load(const mat4& modelMatrix)
+{
+	if (!_loaded)
+	{
+		// Buffers of a previously extracted surface are replaced
+		delete _modelComp[0]->_vao;
+		_modelComp[0]->_vao = nullptr;
+
+		this->setVAOData();
+		_modelComp[0]->setClusterIdx(_label);
+
+		return _loaded = true;
+	}
+
+	return false;
+}
+
+/// [Protected methods]
+
+void VoxelSurface::meshSlab(const uint16_t* grid, const uvec3& numDivs, unsigned axis, unsigned firstSlice, unsigned lastSlice, std::vector<Quad>& quads)
+{
+	const unsigned u = (axis + 1) % 3, v = (axis + 2) % 3, width = numDivs[u], height = numDivs[v];
+	const size_t stride[3] = { size_t(numDivs.y) * numDivs.z, numDivs.z, 1 };
+
+	// Faces of the voxels behind a slice point towards the positive side, whereas those of the voxels in front of it point to the negative side
+	std::vector<uint16_t> mask[2] = { std::vector<uint16_t>(size_t(width) * height), std::vector<uint16_t>(size_t(width) * height) };
+
+	for (unsigned slice = firstSlice; slice < lastSlice; ++slice)
+	{
+		for (unsigned j = 0; j < height; ++j)
+		{
+			for (unsigned i = 0; i < width; ++i)
+			{
+				const size_t index = i * stride[u] + j * stride[v];
+				const uint16_t behind = slice > 0 ? grid[index + (slice - 1) * stride[axis]] : VOXEL_EMPTY;
+				const uint16_t front = slice < numDivs[axis] ? grid[index + slice * stride[axis]] : VOXEL_EMPTY;
+				const bool boundary = behind != front;
+
+				mask[1][size_t(j) * width + i] = boundary ? behind : VOXEL_EMPTY;
+				mask[0][size_t(j) * width + i] = boundary ? front : VOXEL_EMPTY;
+			}
+		}
+
+		for (unsigned positive = 0; positive < 2; ++positive)
+		{
+			uint16_t* faces = mask[positive].data();
+
+			for (unsigned j = 0; j < height; ++j)
+			{
+				for (unsigned i = 0; i < width; )
+				{
+					const uint16_t label = faces[size_t(j) * width + i];
+
+					if (label == VOXEL_EMPTY)
+					{
+						++i;
+						continue;
+					}
+
+					// The rectangle grows along u first, and then along v while whole rows share the label
+					unsigned quadWidth = 1, quadHeight = 1;
+					while (i + quadWidth < width && faces[size_t(j) * width + i + quadWidth] == label) ++quadWidth;
+
+					for (; j + quadHeight < height; ++quadHeight)
+					{
+						const uint16_t* row = faces + size_t(j + quadHeight) * width + i;
+						if (std::any_of(row, row + quadWidth, [label](uint16_t face) { return face != label; })) break;
+					}
+
+					for (unsigned y = 0; y < quadHeight; ++y) std::fill_n(faces + size_t(j + y) * width + i, quadWidth, uint16_t(VOXEL_EMPTY));
+
+					Quad quad;
+					quad._origin[axis] = slice;
+					quad._origin[u] = i;
+					quad._origin[v] = j;
+					quad._size = uvec2(quadWidth, quadHeight);
+					quad._label = label;
+					quad._axis = uint8_t(axis);
+					quad._positive = uint8_t(positive);
+
+					quads.push_back(quad);
+					i += quadWidth;
+				}
+			}
+		}
+	}
+}
+
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "DataStructures/RegularGrid.h"
+#include "Graphics/Core/Model3D.h"
+
+/**
+*	@file VoxelSurface.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Boundary of the occupied voxels of a regular grid as an indexed triangle mesh. Only faces between an occupied voxel and an empty one,
+*	or a voxel with a different label, are kept, and coplanar faces sharing a label are greedily merged into rectangles. Hence, interior faces
+*	are never drawn, unlike rendering a cube per voxel. Labels are uploaded as cluster indices, so that the cluster shader colours the surface.
+*/
+class VoxelSurface: public Model3D
+{
+public:
+	const static unsigned	SLAB_SIZE;								//!< Slices of an axis meshed by each CPU task
+
+protected:
+	/**
+	*	@brief Rectangle of merged faces in grid coordinates.
+	*/
+	struct Quad
+	{
+		uvec3		_origin;										//!< Corner with the lowest coordinates
+		uvec2		_size;											//!< Extent along the two axes which are not the normal axis
+		uint16_t	_label;											//!< Label of the voxels behind the rectangle
+		uint8_t		_axis;											//!< Axis of the normal
+		uint8_t		_positive;										//!< The normal points towards the positive direction of its axis
+	};
+
+protected:
+	std::vector<float>		_label;									//!< Label of each vertex, uploaded as cluster index
+	unsigned				_numQuads;								//!< Merged rectangles, composed of four vertices and two triangles
+
+protected:
+	/**
+	*	@brief Greedily merges the faces of slices [firstSlice, lastSlice) perpendicular to an axis, where slice s is the plane between voxels s - 1 and s.
+	*/
+	static void meshSlab(const uint16_t* grid, const uvec3& numDivs, unsigned axis, unsigned firstSlice, unsigned lastSlice, std::vector<Quad>& quads);
+
+public:
+	/**
+	*	@brief Constructor of an empty surface.
+	*/
+	VoxelSurface();
+
+	/**
+	*	@brief Invalid copy constructor.
+	*/
+	VoxelSurface(const VoxelSurface& surface) = delete;
+
+	/**
+	*	@brief Destructor.
+	*/
+	virtual ~VoxelSurface();
+
+	/**
+	*	@brief Writes the surface as a Wavefront OBJ file, where rectangles are grouped by label.
+	*	@return Success of writing process.
+	*/
+	bool exportOBJ(const std::string& filename) const;
+
+	/**
+	*	@brief Writes the surface as a PLY file with vertex normals and a label per triangle.
+	*	@return Success of writing process.
+	*/
+	bool exportPLY(const std::string& filename, const bool ascii = false) const;
+
+	/**
+	*	@brief Replaces the surface with the boundary of the occupied voxels of a grid. Slabs are meshed in parallel on CPU,
+	*	hence no OpenGL context is required until the surface is loaded.
+	*/
+	void extract(RegularGrid* grid);
+
+	/**
+	*	@brief Uploads the last extracted surface to GPU.
+	*	@return True if the surface was uploaded, false if it was already loaded.
+	*/
+	virtual bool load(const mat4& modelMatrix = mat4(1.0f));
+
+	/**
+	*	@return Number of triangles.
+	*/
+	unsigned getNumTriangles() const { return _numQuads * 2; }
+
+	/**
+	*	@brief Assignment operator is not allowed.
+	*/
+	VoxelSurface& operator=(const VoxelSurface& surface) = delete;
+};
+
@@ -5,13 +5,14 @@
 #include "Interface/Fonts/font_awesome.hpp"
 #include "Interface/Fonts/lato.hpp"
 #include "Interface/Fonts/IconsFontAwesome5.h"
+#include "Utilities/MemoryTracker.h"
 #include "imfiledialog/ImGuiFileDialog.h"
 
 /// [Protected methods]
 
 GUI::GUI() :
 	_showRenderingSettings(false), _showSceneSettings(false), _showScreenshotSettings(false), _showAboutUs(false), _showControls(false), 
-	_showVoxelizationSettings(false), _showDirectoryDialog(false)
+	_showVoxelizationSettings(false), _showDirectoryDialog(false), _showPerformanceMonitor(false), _computeStatistics(false)
 {
 	_renderer			= Renderer::getInstance();	
 	_renderingParams	= Renderer::getInstance()->getRenderingParameters();
@@ -29,6 +30,10 @@ void GUI::createMenu()
 	if (_showAboutUs)				showAboutUsWindow();
 	if (_showControls)				showControls();
 	if (_showDirectoryDialog)		showOpenDirectoryDialog();
+	if (_showPerformanceMonitor)	showPerformanceMonitor();
+
+	// Passes are only measured while they are displayed
+	PerformanceMonitor::getInstance()->setEnabled(_showPerformanceMonitor);
 
 	if (ImGui::BeginMainMenuBar())
 	{
@@ -38,6 +43,7 @@ void GUI::createMenu()
 			ImGui::MenuItem(ICON_FA_IMAGE "Screenshot", NULL, &_showScreenshotSettings);
 			ImGui::MenuItem(ICON_FA_TREE "Scene", NULL, &_showSceneSettings);
 			ImGui::MenuItem(ICON_FA_CUBE "Voxelizer", NULL, &_showVoxelizationSettings);
+			ImGui::MenuItem(ICON_FA_CLOCK "Performance", NULL, &_showPerformanceMonitor);
 			ImGui::EndMenu();
 		}
 
@@ -57,6 +63,11 @@ void GUI::createMenu()
 	}
 }
 
+float GUI::getHistoryValue(void* history, int idx)
+{
+	return (*static_cast<const RingBuffer<float>*>(history))[idx];
+}
+
 void GUI::leaveSpace(const unsigned numSlots)
 {
 	for (int i = 0; i < numSlots; ++i)
@@ -65,6 +76,15 @@ void GUI::leaveSpace(const unsigned numSlots)
 	}
 }
 
+void GUI::plotHistory(const char* label, const RingBuffer<float>& history)
+{
+	char overlay[64];
+	snprintf(overlay, sizeof(overlay), "%.2f ms (mean %.2f ms)", history.back(), history.mean());
+
+	// Values are read in place, so nothing is copied per frame
+	ImGui::PlotHistogram(label, &GUI::getHistoryValue, const_cast<RingBuffer<float>*>(&history), int(history.size()), 0, overlay, .0f, FLT_MAX, ImVec2(0, 50));
+}
+
 void GUI::renderHelpMarker(const char* message)
 {
 	ImGui::TextDisabled(ICON_FA_QUESTION);
@@ -125,14 +145,49 @@ void GUI::showOpenDirectoryDialog()
 		if (ImGuiFileDialog::Instance()->IsOk())
 		{
 			std::string filePathName = ImGuiFileDialog::Instance()->GetFilePathName();
-			_scene->loadPointClouds(filePathName.substr(0, filePathName.find_last_of(".")), _renderingParams->_gridResolution);
+			const std::string directory = filePathName.substr(0, filePathName.find_last_of("."));
+
+			if (_computeStatistics)	_scene->computeStatistics(directory, _renderingParams->_gridResolution);
+			else					_scene->loadPointClouds(directory, _renderingParams->_gridResolution, _renderingParams->_downsamplePointCloud ? _renderingParams->_downsampleResolution : ivec3(0));
 		}
 
 		ImGuiFileDialog::Instance()->Close();
 		_showDirectoryDialog = false;
+		_computeStatistics = false;
 	}
 }
 
+void GUI::showPerformanceMonitor()
+{
+	if (ImGui::Begin("Performance", &_showPerformanceMonitor))
+	{
+		const PerformanceMonitor* performanceMonitor = PerformanceMonitor::getInstance();
+		const MemoryTracker* memoryTracker = MemoryTracker::getInstance();
+
+		this->leaveSpace(1); ImGui::Text("Frame (CPU) and scene passes (GPU)"); ImGui::Separator(); this->leaveSpace(1);
+		this->plotHistory("Frame (CPU)", performanceMonitor->getFrameTime());
+
+		for (unsigned pass = 0; pass < PerformanceMonitor::NUM_FRAME_PASSES; ++pass)
+			this->plotHistory(PerformanceMonitor::getPassName(PerformanceMonitor::FramePass(pass)), performanceMonitor->getPassTime(PerformanceMonitor::FramePass(pass)));
+
+		this->leaveSpace(3); ImGui::Text("Last voxelizations"); ImGui::Separator(); this->leaveSpace(1);
+
+		for (unsigned stage = 0; stage < PerformanceMonitor::NUM_LOAD_STAGES; ++stage)
+			this->plotHistory(PerformanceMonitor::getStageName(PerformanceMonitor::LoadStage(stage)), performanceMonitor->getStageTime(PerformanceMonitor::LoadStage(stage)));
+
+		this->leaveSpace(3); ImGui::Text("Buffers"); ImGui::Separator(); this->leaveSpace(1);
+		ImGui::Text("Voxel instances: %u", _scene->getNumVoxelInstances());
+		ImGui::Text("Visible voxel chunks: %u / %u", _scene->getNumVisibleVoxelChunks(), _scene->getNumVoxelChunks());
+		ImGui::Text("Voxel surface triangles: %u", _scene->getNumVoxelSurfaceTriangles());
+		ImGui::Text("LOD points: %u / %u", _scene->getNumSelectedLODPoints(), _scene->getNumLODPoints());
+
+		for (unsigned tag = 0; tag < MemoryTracker::NUM_TAGS; ++tag)
+			ImGui::Text("%s: %.1f MB (peak %.1f MB)", MemoryTracker::getTagName(MemoryTracker::Tag(tag)), memoryTracker->getCurrent(MemoryTracker::Tag(tag)) / 1048576.0, memoryTracker->getPeak(MemoryTracker::Tag(tag)) / 1048576.0);
+	}
+
+	ImGui::End();
+}
+
 void GUI::showRenderingSettings()
 {
 	if (ImGui::Begin("Rendering Settings", &_showRenderingSettings))
@@ -165,6 +220,8 @@ void GUI::showRenderingSettings()
 					ImGui::NewLine();
 					ImGui::SameLine(30, 0);
 					ImGui::Checkbox("Voxelized", &_renderingParams->_renderVoxelizedMesh);
+					ImGui::SameLine(0, 20); ImGui::Checkbox("Greedy surface", &_renderingParams->_renderVoxelSurface);
+					ImGui::SameLine(0, 20); ImGui::Checkbox("Frustum culling", &_renderingParams->_cullVoxelChunks);
 
 					ImGui::NewLine();
 					ImGui::SameLine(30, 0);
@@ -210,6 +267,10 @@ void GUI::showRenderingSettings()
 
 				ImGui::SliderFloat("Point Size", &_renderingParams->_scenePointSize, 0.1f, 50.0f);
 				ImGui::ColorEdit3("Point Cloud Color", &_renderingParams->_scenePointCloudColor[0]);
+				ImGui::SliderInt("Point Budget", &_renderingParams->_pointBudget, 100000, 50000000);
+				ImGui::SliderFloat("Max. Point Spacing (px)", &_renderingParams->_maxPointSpacing, 0.5f, 10.0f);
+				ImGui::Checkbox("Downsample on Load", &_renderingParams->_downsamplePointCloud);
+				ImGui::SliderInt3("Downsampling Grid", &_renderingParams->_downsampleResolution[0], 1, 2048);
 
 				ImGui::EndTabItem();
 			}
@@ -322,13 +383,34 @@ void GUI::showVoxelizationSettings()
 			_showDirectoryDialog = true;
 		}
 
+		ImGui::SameLine(0, 20);
+		if (ImGui::Button("Compute Statistics"))
+		{
+			_showDirectoryDialog = _computeStatistics = true;
+		}
+
 		this->leaveSpace(3); ImGui::Text("Control"); ImGui::Separator(); this->leaveSpace(1);
 		ImGui::SliderInt3("Grid Subdivisions", &_renderingParams->_gridResolution[0], 1, 500); ImGui::SameLine(0, 20);
 		if (ImGui::Button("Rebuild Grid"))
 		{
 			_scene->rebuildGrid();
 		}
+		ImGui::SameLine(0, 20);
+		if (ImGui::Button("Homogenize Labels"))
+		{
+			_scene->homogenizeGrid();
+		}
 		ImGui::Checkbox("Fill Shape", &_renderingParams->_fillGrid);
+
+		// Footprint of the requested resolution for a scan such as the last one, so that it can be lowered before voxelizing
+		PointCloud* pointCloud = _scene->getPointCloud();
+		const MemoryTracker::Footprint footprint = RegularGrid::estimateFootprint(uvec3(_renderingParams->_gridResolution), pointCloud ? pointCloud->getNumberOfPoints() : 0, pointCloud ? pointCloud->getMaxLabel() + 1 : 1);
+		const MemoryTracker* memoryTracker = MemoryTracker::getInstance();
+
+		this->leaveSpace(3); ImGui::Text("Memory"); ImGui::Separator(); this->leaveSpace(1);
+		ImGui::Text("Projected per scan: %.1f MB", footprint.getTotal() / 1048576.0);
+		ImGui::Text("Tracked: %.1f MB (peak %.1f MB)", memoryTracker->getCurrentTotal() / 1048576.0, memoryTracker->getPeakTotal() / 1048576.0);
+		ImGui::Text("Peak resident set: %.1f MB", MemoryTracker::getPeakResidentSize() / 1048576.0);
 	}
 
 	ImGui::End();
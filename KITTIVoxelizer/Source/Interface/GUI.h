@@ -6,6 +6,7 @@
 
 #include "Geometry/Animation/CatmullRom.h"
 #include "Graphics/Application/CADScene.h"
+#include "Graphics/Application/PerformanceMonitor.h"
 #include "Graphics/Application/Renderer.h"
 #include "Graphics/Application/RenderingParameters.h"
 #include "imgizmo/ImGuizmo.h"
@@ -33,9 +34,11 @@ protected:
 	CADScene*						_scene;
 
 	// GUI state
+	bool							_computeStatistics;					//!< The selected directory is summarized instead of voxelized
 	bool							_showAboutUs;						//!< About us window
 	bool							_showControls;						//!< Shows application controls
 	bool							_showDirectoryDialog;				//!< Opens a file dialog to select a directory
+	bool							_showPerformanceMonitor;			//!< Displays timings of scene passes and the last voxelization
 	bool							_showRenderingSettings;				//!< Displays a window which allows the user to modify the rendering parameters
 	bool							_showSceneSettings;					//!< Displays a window with all the model components and their variables
 	bool							_showScreenshotSettings;			//!< Shows a window which allows to take an screenshot at any size
@@ -52,11 +55,21 @@ protected:
 	*/
 	void createMenu();
 
+	/**
+	*	@return Value of a ring buffer, from the oldest one. Signature of ImGui plot getters.
+	*/
+	static float getHistoryValue(void* history, int idx);
+
 	/**
 	*	@brief Calls ImGui::Spacing() for n times in a clean way.
 	*/
 	static void leaveSpace(const unsigned numSlots);
 
+	/**
+	*	@brief Plots a history of milliseconds as a histogram, with its latest and mean values as overlay.
+	*/
+	static void plotHistory(const char* label, const RingBuffer<float>& history);
+
 	/**
 	*	@brief  
 	*/
@@ -87,6 +100,11 @@ protected:
 	*/
 	void showOpenDirectoryDialog();
 
+	/**
+	*	@brief Shows a window with rolling timings of scene passes and voxelization stages, instance count and buffer memory.
+	*/
+	void showPerformanceMonitor();
+
 	/**
 	*	@brief Shows a window with general rendering configuration.
 	*/
@@ -2,6 +2,7 @@
 #include "InputManager.h"
 
 #include "Geometry/General/BasicOperations.h"
+#include "Graphics/Application/PerformanceMonitor.h"
 #include "Graphics/Application/SSAOScene.h"
 #include "Graphics/Application/Renderer.h"
 #include "Graphics/Core/Camera.h"
@@ -289,8 +290,10 @@ void InputManager::resizeEvent(GLFWwindow* window, int width, int height)
 
 void InputManager::windowRefresh(GLFWwindow* window)
 {
+	PerformanceMonitor::getInstance()->beginFrame();
 	Renderer::getInstance()->render();
 	GUI::getInstance()->render();
+	PerformanceMonitor::getInstance()->endFrame();
 
 	glfwSwapBuffers(window);
 }
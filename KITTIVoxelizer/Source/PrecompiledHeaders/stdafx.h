@@ -1,5 +1,14 @@
 #define _USE_MATH_DEFINES
 
+// [Platform]
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX									// Otherwise, windows.h defines min and max as macros
+#endif
+#include <windows.h>
+#endif
+
 // [Libraries]
 
 #include "GL/glew.h"								// Don't swap order between GL and GLFW includes!
@@ -17,17 +26,21 @@
 // [Standard libraries: basic]
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <chrono>
 #include <climits>
+#include <condition_variable>
 #include <cstdint>
 #include <exception>
 #include <execution>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <random>
 #include <sstream>
@@ -38,6 +51,7 @@
 
 // [Standard libraries: data structures]
 
+#include <deque>
 #include <map>
 #include <set>
 #include <unordered_map>
@@ -21,10 +21,10 @@ namespace ChronoUtilities
 		SECONDS = 1000000000, MILLISECONDS = 1000000, MICROSECONDS = 1000, NANOSECONDS = 1
 	};
 
-	//!< Private members
+	//!< Private members. Each thread has its own clock; nested measurements should rather use Profiler zones
 	namespace
 	{
-		std::chrono::high_resolution_clock::time_point _initTime;
+		thread_local std::chrono::high_resolution_clock::time_point _initTime;
 	}
 
 	/**
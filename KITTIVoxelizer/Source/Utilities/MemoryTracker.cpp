@@ -0,0 +1,149 @@
+#include "stdafx.h"
+#include "MemoryTracker.h"
+
+#include <iomanip>
+
+#ifdef _WIN32
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+// Initialization of static attributes
+const char* MemoryTracker::TAG_NAME[NUM_TAGS] = { "Voxel grid", "Points", "GPU buffers", "Label histograms", "Octree nodes", "BVH nodes", "Instance buffers" };
+
+/// [Public methods]
+
+MemoryTracker::Allocation::Allocation(Tag tag, size_t size) : _tag(tag), _size(size)
+{
+	if (_size) MemoryTracker::getInstance()->allocate(_tag, _size);
+}
+
+MemoryTracker::Allocation::Allocation(const Allocation& allocation) : _tag(allocation._tag), _size(allocation._size)
+{
+	if (_size) MemoryTracker::getInstance()->allocate(_tag, _size);
+}
+
+MemoryTracker::Allocation::~Allocation()
+{
+	if (_size) MemoryTracker::getInstance()->release(_tag, _size);
+}
+
+MemoryTracker::Allocation& MemoryTracker::Allocation::operator=(const Allocation& allocation)
+{
+	if (this != &allocation)
+	{
+		this->resize(0);
+		_tag = allocation._tag;
+		this->resize(allocation._size);
+	}
+
+	return *this;
+}
+
+void MemoryTracker::Allocation::resize(size_t size)
+{
+	if (size > _size)		MemoryTracker::getInstance()->allocate(_tag, size - _size);
+	else if (size < _size)	MemoryTracker::getInstance()->release(_tag, _size - size);
+
+	_size = size;
+}
+
+void MemoryTracker::allocate(Tag tag, size_t size)
+{
+	updatePeak(_peak[tag], _current[tag].fetch_add(size, std::memory_order_relaxed) + size);
+	updatePeak(_peakTotal, _currentTotal.fetch_add(size, std::memory_order_relaxed) + size);
+}
+
+MemoryTracker* MemoryTracker::getInstance()
+{
+	// Initialization of local statics is thread-safe; the instance is leaked so that it is still valid while static objects are destroyed
+	static MemoryTracker* instance = new MemoryTracker();
+
+	return instance;
+}
+
+size_t MemoryTracker::getPeakResidentSize()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return counters.PeakWorkingSetSize;
+
+	return 0;
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) return size_t(usage.ru_maxrss) * 1024;			// Kilobytes in Linux
+
+	return 0;
+#endif
+}
+
+size_t MemoryTracker::getResidentSize()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return counters.WorkingSetSize;
+
+	return 0;
+#else
+	size_t numPages = 0, numResidentPages = 0;
+	std::ifstream statm("/proc/self/statm");
+
+	if (statm >> numPages >> numResidentPages) return numResidentPages * size_t(sysconf(_SC_PAGESIZE));
+
+	return 0;
+#endif
+}
+
+void MemoryTracker::release(Tag tag, size_t size)
+{
+	_current[tag].fetch_sub(size, std::memory_order_relaxed);
+	_currentTotal.fetch_sub(size, std::memory_order_relaxed);
+}
+
+void MemoryTracker::resetPeaks()
+{
+	for (unsigned tag = 0; tag < NUM_TAGS; ++tag) _peak[tag] = _current[tag].load();
+	_peakTotal = _currentTotal.load();
+}
+
+void MemoryTracker::writeReport(std::ostream& out) const
+{
+	out << std::left << std::setw(24) << "Tag" << std::right << std::setw(16) << "Current (MB)" << std::setw(16) << "Peak (MB)" << std::endl << std::fixed << std::setprecision(2);
+
+	for (unsigned tag = 0; tag < NUM_TAGS; ++tag)
+		out << std::left << std::setw(24) << TAG_NAME[tag] << std::right << std::setw(16) << this->getCurrent(Tag(tag)) / 1048576.0 << std::setw(16) << this->getPeak(Tag(tag)) / 1048576.0 << std::endl;
+
+	out << std::left << std::setw(24) << "Total" << std::right << std::setw(16) << this->getCurrentTotal() / 1048576.0 << std::setw(16) << this->getPeakTotal() / 1048576.0 << std::endl;
+	out << std::left << std::setw(24) << "Resident set" << std::right << std::setw(16) << getResidentSize() / 1048576.0 << std::setw(16) << getPeakResidentSize() / 1048576.0 << std::endl;
+	out << std::defaultfloat;
+}
+
+void MemoryTracker::writeReport(const Footprint& footprint, std::ostream& out)
+{
+	out << std::fixed << std::setprecision(2);
+
+	for (unsigned tag = 0; tag < NUM_TAGS; ++tag)
+		if (footprint._bytes[tag]) out << std::left << std::setw(24) << TAG_NAME[tag] << std::right << std::setw(16) << footprint._bytes[tag] / 1048576.0 << " MB" << std::endl;
+
+	out << std::left << std::setw(24) << "Total" << std::right << std::setw(16) << footprint.getTotal() / 1048576.0 << " MB" << std::endl;
+	out << std::defaultfloat;
+}
+
+/// [Protected methods]
+
+MemoryTracker::MemoryTracker() : _current{}, _currentTotal(0), _peak{}, _peakTotal(0)
+{
+}
+
+MemoryTracker::~MemoryTracker()
+{
+}
+
+void MemoryTracker::updatePeak(std::atomic<size_t>& peak, size_t value)
+{
+	size_t currentPeak = peak.load(std::memory_order_relaxed);
+
+	while (currentPeak < value && !peak.compare_exchange_weak(currentPeak, value, std::memory_order_relaxed));
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "stdafx.h"
+
+/**
+*	@file MemoryTracker.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+/**
+*	@brief Accounting of the buffers which scale with the grid resolution and the size of scans. Each subsystem reports its bytes
+*	under a tag, so that current and peak usage can be broken down, and the footprint of a resolution can be compared against
+*	a budget before anything is allocated. Counters are atomic, hence allocations can be reported from any thread. Unlike other
+*	singletons, the instance is never destroyed, as allocations held by static objects are released after main returns.
+*/
+class MemoryTracker
+{
+public:
+	enum Tag { VOXEL_GRID, POINTS, GPU_BUFFERS, LABEL_HISTOGRAM, OCTREE, BVH, INSTANCE_BUFFER, NUM_TAGS };
+
+	/**
+	*	@brief Bytes held by a container, reported under a tag while the object is alive. Copies report their own bytes.
+	*/
+	class Allocation
+	{
+	protected:
+		Tag			_tag;											//!< Subsystem the bytes are accounted to
+		size_t		_size;											//!< Reported bytes
+
+	public:
+		/**
+		*	@brief Constructor.
+		*/
+		Allocation(Tag tag, size_t size = 0);
+
+		/**
+		*	@brief Copy constructor.
+		*/
+		Allocation(const Allocation& allocation);
+
+		/**
+		*	@brief Destructor. Releases the reported bytes.
+		*/
+		~Allocation();
+
+		/**
+		*	@brief Assignment operator.
+		*/
+		Allocation& operator=(const Allocation& allocation);
+
+		/**
+		*	@brief Reports a new size, e.g. after the container is resized.
+		*/
+		void resize(size_t size);
+
+		/**
+		*	@return Reported bytes.
+		*/
+		size_t size() const { return _size; }
+	};
+
+	struct Footprint
+	{
+		size_t		_bytes[NUM_TAGS];								//!< Bytes per tag
+
+		/**
+		*	@brief Default constructor.
+		*/
+		Footprint() : _bytes{} {}
+
+		/**
+		*	@return Bytes of every tag.
+		*/
+		size_t getTotal() const { return std::accumulate(_bytes, _bytes + NUM_TAGS, size_t(0)); }
+	};
+
+protected:
+	const static char*			TAG_NAME[NUM_TAGS];					//!< Names shown in reports
+
+protected:
+	std::atomic<size_t>			_current[NUM_TAGS];					//!< Bytes currently reported per tag
+	std::atomic<size_t>			_currentTotal;						//!< Bytes currently reported by every tag
+	std::atomic<size_t>			_peak[NUM_TAGS];					//!< Maximum current bytes per tag
+	std::atomic<size_t>			_peakTotal;							//!< Maximum current bytes of every tag at once
+
+protected:
+	/**
+	*	@brief Constructor.
+	*/
+	MemoryTracker();
+
+	/**
+	*	@brief Destructor. Never called, as the instance outlives every static object.
+	*/
+	virtual ~MemoryTracker();
+
+	/**
+	*	@brief Raises peak to value if it is lower.
+	*/
+	static void updatePeak(std::atomic<size_t>& peak, size_t value);
+
+public:
+	/**
+	*	@brief Invalid copy constructor.
+	*/
+	MemoryTracker(const MemoryTracker&) = delete;
+
+	/**
+	*	@return Single instance, created on the first call from any thread.
+	*/
+	static MemoryTracker* getInstance();
+
+	/**
+	*	@brief Invalid assignment operator.
+	*/
+	MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+	/**
+	*	@brief Reports bytes allocated by a subsystem.
+	*/
+	void allocate(Tag tag, size_t size);
+
+	/**
+	*	@return Bytes currently reported under a tag.
+	*/
+	size_t getCurrent(Tag tag) const { return _current[tag].load(std::memory_order_relaxed); }
+
+	/**
+	*	@return Bytes currently reported by every tag.
+	*/
+	size_t getCurrentTotal() const { return _currentTotal.load(std::memory_order_relaxed); }
+
+	/**
+	*	@return Maximum bytes reported under a tag since the last reset.
+	*/
+	size_t getPeak(Tag tag) const { return _peak[tag].load(std::memory_order_relaxed); }
+
+	/**
+	*	@return Maximum bytes reported at once since the last reset.
+	*/
+	size_t getPeakTotal() const { return _peakTotal.load(std::memory_order_relaxed); }
+
+	/**
+	*	@return Peak resident set size of the process in bytes, zero if it cannot be queried.
+	*/
+	static size_t getPeakResidentSize();
+
+	/**
+	*	@return Current resident set size of the process in bytes, zero if it cannot be queried.
+	*/
+	static size_t getResidentSize();
+
+	/**
+	*	@return Name of a tag.
+	*/
+	static const char* getTagName(Tag tag) { return TAG_NAME[tag]; }
+
+	/**
+	*	@brief Reports bytes released by a subsystem.
+	*/
+	void release(Tag tag, size_t size);
+
+	/**
+	*	@brief Lowers peaks to the current usage, e.g. before a new batch.
+	*/
+	void resetPeaks();
+
+	/**
+	*	@brief Writes current and peak bytes of each tag, together with the resident set size of the process.
+	*/
+	void writeReport(std::ostream& out) const;
+
+	/**
+	*	@brief Writes the bytes of each tag in a footprint.
+	*/
+	static void writeReport(const Footprint& footprint, std::ostream& out);
+};
+
@@ -0,0 +1,160 @@
+#include "stdafx.h"
+#include "Profiler.h"
+
+#include <iomanip>
+
+// Initialization of static attributes
+std::atomic<bool> Profiler::_enabled(false);
+thread_local Profiler::ThreadBuffer* Profiler::_currentThreadBuffer = nullptr;
+
+/// [Public methods]
+
+Profiler::ScopedZone::ScopedZone(const char* name) : _eventIdx(SIZE_MAX)
+{
+	if (!Profiler::isEnabled()) return;
+
+	Profiler* profiler = Profiler::getInstance();
+	ThreadBuffer* buffer = profiler->getThreadBuffer();
+
+	_eventIdx = buffer->_event.size();
+	buffer->_event.push_back(Event{ name, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - profiler->_epoch).count(), -1, buffer->_openZone });
+	buffer->_openZone = _eventIdx;
+}
+
+Profiler::ScopedZone::~ScopedZone()
+{
+	if (_eventIdx == SIZE_MAX || !_currentThreadBuffer || _eventIdx >= _currentThreadBuffer->_event.size()) return;
+
+	Event& event = _currentThreadBuffer->_event[_eventIdx];
+	event._duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Profiler::getInstance()->_epoch).count() - event._start;
+	_currentThreadBuffer->_openZone = event._parent;
+}
+
+Profiler::~Profiler()
+{
+}
+
+void Profiler::clear()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	for (std::unique_ptr<ThreadBuffer>& buffer : _threadBuffer)
+	{
+		buffer->_event.clear();
+		buffer->_openZone = SIZE_MAX;
+	}
+}
+
+std::map<std::string, Profiler::ZoneStatistics> Profiler::getStatistics()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	std::map<std::string, ZoneStatistics> statistics;
+
+	for (const std::unique_ptr<ThreadBuffer>& buffer : _threadBuffer)
+	{
+		std::vector<long long> childTime(buffer->_event.size(), 0);
+
+		// Nested zones are closed later, hence they are traversed in reverse order to accumulate them into their parents
+		for (size_t eventIdx = buffer->_event.size(); eventIdx-- > 0; )
+		{
+			const Event& event = buffer->_event[eventIdx];
+			if (event._duration < 0) continue;
+
+			if (event._parent != SIZE_MAX) childTime[event._parent] += event._duration;
+
+			const double duration = event._duration / 1e6;
+			ZoneStatistics& zone = statistics.emplace(getPath(*buffer, eventIdx), ZoneStatistics{ 0, .0, DBL_MAX, .0, .0 }).first->second;
+
+			++zone._count;
+			zone._total += duration;
+			zone._min = std::min(zone._min, duration);
+			zone._max = std::max(zone._max, duration);
+			zone._self += (event._duration - childTime[eventIdx]) / 1e6;
+		}
+	}
+
+	return statistics;
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+	_enabled.store(enabled);
+}
+
+bool Profiler::writeChromeTrace(const std::string& filename)
+{
+	std::ofstream out(filename, std::ios::out | std::ios::trunc);
+	if (!out.is_open()) return false;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	bool firstEvent = true;
+
+	out << std::fixed << std::setprecision(3);
+	out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+	for (const std::unique_ptr<ThreadBuffer>& buffer : _threadBuffer)
+	{
+		out << (firstEvent ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": " << buffer->_threadID << ", \"args\": {\"name\": \"Thread " << buffer->_threadID << "\"}}";
+		firstEvent = false;
+
+		// Timestamps and durations are given in microseconds
+		for (const Event& event : buffer->_event)
+		{
+			if (event._duration < 0) continue;
+
+			out << ",\n{\"name\": \"" << event._name << "\", \"cat\": \"KITTIVoxelizer\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << buffer->_threadID
+				<< ", \"ts\": " << event._start / 1e3 << ", \"dur\": " << event._duration / 1e3 << "}";
+		}
+	}
+
+	out << "\n]}\n";
+	out.close();
+
+	return !out.fail();
+}
+
+void Profiler::writeStatistics(std::ostream& out)
+{
+	const std::map<std::string, ZoneStatistics> statistics = this->getStatistics();
+
+	out << std::left << std::setw(48) << "Zone" << std::right << std::setw(10) << "Count" << std::setw(14) << "Total (ms)" << std::setw(14) << "Self (ms)"
+		<< std::setw(12) << "Mean (ms)" << std::setw(12) << "Min (ms)" << std::setw(12) << "Max (ms)" << std::endl;
+
+	for (const auto& zone : statistics)
+	{
+		out << std::left << std::setw(48) << zone.first << std::right << std::fixed << std::setprecision(3) << std::setw(10) << zone.second._count
+			<< std::setw(14) << zone.second._total << std::setw(14) << zone.second._self << std::setw(12) << zone.second._total / zone.second._count
+			<< std::setw(12) << zone.second._min << std::setw(12) << zone.second._max << std::endl;
+	}
+
+	out << std::defaultfloat;
+}
+
+/// [Protected methods]
+
+Profiler::Profiler() : _epoch(std::chrono::steady_clock::now())
+{
+}
+
+std::string Profiler::getPath(const ThreadBuffer& buffer, size_t eventIdx)
+{
+	std::string path = buffer._event[eventIdx]._name;
+
+	while ((eventIdx = buffer._event[eventIdx]._parent) != SIZE_MAX)
+		path = std::string(buffer._event[eventIdx]._name) + "/" + path;
+
+	return path;
+}
+
+Profiler::ThreadBuffer* Profiler::getThreadBuffer()
+{
+	if (!_currentThreadBuffer)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_threadBuffer.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer{ {}, SIZE_MAX, unsigned(_threadBuffer.size()) }));
+		_currentThreadBuffer = _threadBuffer.back().get();
+	}
+
+	return _currentThreadBuffer;
+}
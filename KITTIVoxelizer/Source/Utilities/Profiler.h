@@ -0,0 +1,131 @@
+#pragma once
+
+#include "Utilities/Singleton.h"
+
+/**
+*	@file Profiler.h
+*	@authors Alfonso Lpez Ruiz (alr00048@red.ujaen.es)
+*	@date 18/10/2026
+*/
+
+#define PROFILER_CONCATENATE_(a, b) a##b
+#define PROFILER_CONCATENATE(a, b) PROFILER_CONCATENATE_(a, b)
+
+//!< Measures the enclosing scope as a named zone. The name must outlive the profiler, e.g. a string literal
+#define PROFILE_ZONE(name) Profiler::ScopedZone PROFILER_CONCATENATE(_profilerZone, __LINE__)(name)
+
+/**
+*	@brief Thread-aware hierarchical profiler. Each thread records its zones into its own buffer, so that nested and concurrent
+*	zones never overwrite each other and no lock is taken while measuring. Zones are aggregated per path (e.g. load/parse) and
+*	can be exported as Chrome trace_event JSON. Nothing is recorded while the profiler is disabled.
+*/
+class Profiler: public Singleton<Profiler>
+{
+	friend class Singleton<Profiler>;
+
+public:
+	struct ZoneStatistics
+	{
+		size_t		_count;											//!< Number of measured zones
+		double		_total, _min, _max;								//!< Milliseconds
+		double		_self;											//!< Milliseconds not spent in nested zones
+	};
+
+	/**
+	*	@brief Measures the lifetime of the object as a zone of the calling thread.
+	*/
+	class ScopedZone
+	{
+	protected:
+		size_t		_eventIdx;										//!< Location of the zone in the thread buffer, SIZE_MAX if nothing is recorded
+
+	public:
+		/**
+		*	@brief Opens a zone if the profiler is enabled.
+		*/
+		ScopedZone(const char* name);
+
+		/**
+		*	@brief Closes the zone.
+		*/
+		~ScopedZone();
+	};
+
+protected:
+	struct Event
+	{
+		const char*	_name;											//!< Zone name
+		long long	_start;											//!< Nanoseconds since the profiler epoch
+		long long	_duration;										//!< Nanoseconds, negative while the zone is open
+		size_t		_parent;										//!< Enclosing zone of the same thread, SIZE_MAX for top-level zones
+	};
+
+	struct ThreadBuffer
+	{
+		std::vector<Event>	_event;									//!< Zones in opening order
+		size_t				_openZone;								//!< Innermost open zone, SIZE_MAX if there is none
+		unsigned			_threadID;								//!< Sequential identifier shown in traces
+	};
+
+protected:
+	static std::atomic<bool>					_enabled;			//!< Checked before anything is recorded
+	static thread_local ThreadBuffer*			_currentThreadBuffer;	//!< Buffer of the calling thread, owned by the profiler
+
+	std::chrono::steady_clock::time_point		_epoch;				//!< Origin of timestamps
+	std::mutex									_mutex;				//!< Protects the list of thread buffers
+	std::vector<std::unique_ptr<ThreadBuffer>>	_threadBuffer;		//!< One buffer per thread which recorded any zone
+
+protected:
+	/**
+	*	@brief Constructor.
+	*/
+	Profiler();
+
+	/**
+	*	@return Path of an event, from the top-level zone to the event itself.
+	*/
+	static std::string getPath(const ThreadBuffer& buffer, size_t eventIdx);
+
+	/**
+	*	@return Buffer of the calling thread, created at its first zone.
+	*/
+	ThreadBuffer* getThreadBuffer();
+
+public:
+	/**
+	*	@brief Destructor.
+	*/
+	virtual ~Profiler();
+
+	/**
+	*	@brief Discards every recorded zone. Must not be called while any thread is measuring.
+	*/
+	void clear();
+
+	/**
+	*	@return Statistics of closed zones, indexed by path. Must not be called while any thread is measuring.
+	*/
+	std::map<std::string, ZoneStatistics> getStatistics();
+
+	/**
+	*	@return True if zones are being recorded.
+	*/
+	static bool isEnabled() { return _enabled.load(std::memory_order_relaxed); }
+
+	/**
+	*	@brief Starts or stops recording zones. The instance must be created (e.g. by calling this method) before any thread opens a zone.
+	*/
+	void setEnabled(bool enabled);
+
+	/**
+	*	@brief Writes closed zones as complete events of Chrome trace_event format, which is read by chrome://tracing or Perfetto.
+	*	@return Success of writing process.
+	*/
+	bool writeChromeTrace(const std::string& filename);
+
+	/**
+	*	@brief Writes statistics of every zone path as a table.
+	*/
+	void writeStatistics(std::ostream& out);
+};
+
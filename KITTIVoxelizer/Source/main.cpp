@@ -1,5 +1,16 @@
 #include "stdafx.h"
+#include "Benchmark/BenchmarkSuite.h"
+#include "Benchmark/ThroughputBenchmark.h"
+#include "DataStructures/BrickedGrid.h"
+#include "Geometry/Animation/CatmullRom.h"
+#include "Graphics/Application/LiDARSimulator.h"
+#include "Graphics/Application/VoxelEvaluator.h"
+#include "Graphics/Core/ComputeBackend.h"
+#include "Graphics/Core/PointCloudWriter.h"
+#include "Graphics/Core/VoxelSurface.h"
 #include "Interface/Window.h"
+#include "Utilities/MemoryTracker.h"
+#include "Utilities/Profiler.h"
 #include <windows.h>						// DWORD is undefined otherwise
 
 // Laptop support. Use NVIDIA graphic card instead of Intel
@@ -22,13 +33,182 @@ int main(int argc, char *argv[])
 	const std::string title = "LiDAR Simulator";
 	const uint16_t width = 1050, height = 650;
 	const auto window = Window::getInstance();
+
+	// Headless modes: --benchmark [output.json], --throughput [output.json], --simulate model waypoints.txt outputFolder [numScans],
+	// --surface grid.{vxz|vxb} output.{ply|obj}, which exports the greedy-meshed boundary of a compressed or bricked grid with no window, or
+	// --evaluate predFolder gtFolder numClasses report.csv, which compares the 256x256x32 .label grids of both folders as in SemanticKITTI.
+	// Appending --cpu runs scene loading and voxelization on CPU threads instead of compute shaders; then, --benchmark and --throughput do not load
+	// the window, hence they run on machines with no GPU. --surface and --evaluate never load it. Any mode, or the interactive application, may be
+	// profiled by appending --trace trace.json
+	std::string traceFilename;
+	if (argc > 2 && std::string(argv[argc - 2]) == "--trace")
+	{
+		traceFilename = argv[argc - 1];
+		argc -= 2;
+		Profiler::getInstance()->setEnabled(true);
+	}
+
+	const bool useCPU = argc > 1 && std::string(argv[argc - 1]) == "--cpu";
+	if (useCPU) --argc;
+
+	ComputeBackend::selectBackend(useCPU ? ComputeBackend::CPU_BACKEND : ComputeBackend::GPU_BACKEND);
+	std::cout << "__ Compute backend: " << ComputeBackend::getBackendName(ComputeBackend::getSelectedBackend()) << " __" << std::endl;
+
+	const std::string mode = argc > 1 ? argv[1] : "";
+	const std::string benchmarkFilename = argc > 2 ? argv[2] : (mode == "--throughput" ? "throughput.json" : "benchmark.json");
+	const bool needsContext = mode != "--surface" && mode != "--evaluate" && (!useCPU || (mode != "--benchmark" && mode != "--throughput"));			// Materials and rendering still need OpenGL
+	int result = 0;
 	
 	{
-		if (const bool success = window->load(title, width, height))
+		if (const bool success = !needsContext || window->load(title, width, height))
 		{
-			window->startRenderingCycle();
+			if (mode == "--benchmark")
+			{
+				BenchmarkSuite::Settings settings;
+				settings._useGPU = needsContext;
+
+				BenchmarkSuite benchmarkSuite(settings);
+
+				try
+				{
+					// Throws if CPU and GPU backends disagree
+					benchmarkSuite.run();
+
+					if (!benchmarkSuite.writeJSON(benchmarkFilename)) std::cout << "__ Failed to write " << benchmarkFilename << " __" << std::endl;
+				}
+				catch (const std::exception& exception)
+				{
+					std::cout << "__ Benchmark failed: " << exception.what() << " __" << std::endl;
+					result = 1;
+				}
+			}
+			else if (mode == "--throughput")
+			{
+				ThroughputBenchmark throughputBenchmark;
+
+				try
+				{
+					// Throws if the synthetic sequence cannot be written or a run fails
+					throughputBenchmark.run();
+
+					if (!throughputBenchmark.writeJSON(benchmarkFilename)) std::cout << "__ Failed to write " << benchmarkFilename << " __" << std::endl;
+				}
+				catch (const std::exception& exception)
+				{
+					std::cout << "__ Throughput benchmark failed: " << exception.what() << " __" << std::endl;
+					result = 1;
+				}
+			}
+			else if (mode == "--simulate" && argc > 4)
+			{
+				std::vector<vec4> waypoints;
+
+				if (LiDARSimulator::readWaypoints(argv[3], waypoints))
+				{
+					// Waypoints are evenly spread in time
+					std::vector<float> timeKey(waypoints.size());
+					for (size_t waypointIdx = 0; waypointIdx < waypoints.size(); ++waypointIdx) timeKey[waypointIdx] = float(waypointIdx) / (waypoints.size() - 1);
+
+					CatmullRom trajectory(waypoints);
+					trajectory.setTimeKey(timeKey);
+
+					CADModel model(argv[2], "", true);
+					model.load();
+
+					LiDARSimulator simulator;
+					simulator.addModel(&model, std::string(argv[2]) + CLASS_FILE_SUFFIX);
 
-			std::cout << "__ Finishing LiDAR Simulator __" << std::endl;
+					result = simulator.simulate(&trajectory, argc > 5 ? unsigned(std::stoul(argv[5])) : 100, argv[4]) ? 0 : 1;
+				}
+				else
+				{
+					std::cout << "__ Failed to read trajectory " << argv[3] << " __" << std::endl;
+					result = 1;
+				}
+			}
+			else if (mode == "--surface" && argc > 3)
+			{
+				const std::string inputFilename = argv[2], outputFilename = argv[3];
+				const size_t extensionLength = std::strlen(BRICKED_GRID_EXTENSION);
+				std::unique_ptr<RegularGrid> grid;
+
+				if (inputFilename.size() >= extensionLength && inputFilename.compare(inputFilename.size() - extensionLength, extensionLength, BRICKED_GRID_EXTENSION) == 0)
+				{
+					BrickedGrid brickedGrid(inputFilename);
+					if (brickedGrid.open()) grid.reset(brickedGrid.readGrid());
+				}
+				else
+				{
+					grid = std::make_unique<RegularGrid>(uvec3(1));
+					if (!grid->importCompressed(inputFilename)) grid.reset();
+				}
+
+				if (grid)
+				{
+					VoxelSurface surface;
+					surface.extract(grid.get());
+
+					const bool isOBJ = outputFilename.size() >= 4 && outputFilename.compare(outputFilename.size() - 4, 4, ".obj") == 0;
+					if (!(isOBJ ? surface.exportOBJ(outputFilename) : surface.exportPLY(outputFilename)))
+					{
+						std::cout << "__ Failed to write " << outputFilename << " __" << std::endl;
+						result = 1;
+					}
+					else std::cout << "__ " << surface.getNumTriangles() << " triangles written to " << outputFilename << " __" << std::endl;
+				}
+				else
+				{
+					std::cout << "__ Failed to read grid " << argv[2] << " __" << std::endl;
+					result = 1;
+				}
+			}
+			else if (mode == "--evaluate" && argc > 5)
+			{
+				const unsigned numClasses = unsigned(std::strtoul(argv[4], nullptr, 10));
+				const std::vector<VoxelEvaluator::ScanPair> scanPair = VoxelEvaluator::getScanPairs(argv[2], argv[3]);
+
+				if (numClasses < 2 || numClasses > 255)
+				{
+					std::cout << "__ Number of classes must be within [2, 255], empty class included __" << std::endl;
+					result = 1;
+				}
+				else if (scanPair.empty())
+				{
+					std::cout << "__ No ground-truth grids found in " << argv[3] << " __" << std::endl;
+					result = 1;
+				}
+				else
+				{
+					VoxelEvaluator evaluator(uvec3(256, 256, 32), numClasses);
+					std::vector<VoxelEvaluator::Metrics> scanMetrics;
+					const VoxelEvaluator::Metrics metrics = evaluator.evaluate(scanPair, scanMetrics);
+					const size_t numInvalid = size_t(std::count_if(scanMetrics.begin(), scanMetrics.end(), [](const VoxelEvaluator::Metrics& scan) { return !scan._valid; }));
+
+					std::cout << "__ Completion IoU: " << metrics._completionIoU << ", mIoU: " << metrics._mIoU << " (" << scanPair.size() - numInvalid << " scans) __" << std::endl;
+					if (numInvalid) std::cout << "__ " << numInvalid << " scans could not be read __" << std::endl;
+
+					if (!evaluator.writeReport(argv[5], scanPair, scanMetrics, metrics))
+					{
+						std::cout << "__ Failed to write " << argv[5] << " __" << std::endl;
+						result = 1;
+					}
+					else if (!metrics._valid) result = 1;
+				}
+			}
+			else if (mode == "--simulate" || mode == "--surface" || mode == "--evaluate")
+			{
+				// Too few arguments; headless modes never fall back to the interactive application, whose window may not be loaded
+				const std::string usage = mode == "--simulate" ? "model waypoints.txt outputFolder [numScans]" : (mode == "--surface" ? "grid.{vxz|vxb} output.{ply|obj}" : "predFolder gtFolder numClasses report.csv");
+
+				std::cout << "__ Usage: " << argv[0] << " " << mode << " " << usage << " __" << std::endl;
+				result = 1;
+			}
+			else
+			{
+				window->startRenderingCycle();
+
+				std::cout << "__ Finishing LiDAR Simulator __" << std::endl;
+			}
 		}
 		else
 		{
@@ -36,7 +216,21 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	system("pause");
+	// Pending point clouds are written before reporting, instead of on the destruction of static instances
+	PointCloudWriter::getInstance()->shutdown();
+
+	// Memory held by each subsystem once headless modes finish, and peaks along the whole run
+	if (!mode.empty()) MemoryTracker::getInstance()->writeReport(std::cout);
+
+	if (!traceFilename.empty())
+	{
+		Profiler::getInstance()->setEnabled(false);
+		Profiler::getInstance()->writeStatistics(std::cout);
+
+		if (!Profiler::getInstance()->writeChromeTrace(traceFilename)) std::cout << "__ Failed to write " << traceFilename << " __" << std::endl;
+	}
+
+	if (mode.empty()) system("pause");
 
-	return 0;
+	return result;
 }